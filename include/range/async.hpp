@@ -0,0 +1,579 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define asynchronous ranges, which are traversed with C++20 coroutines, and
+algorithms that consume them on an executor.
+
+This requires compiler support for C++20 coroutines.
+If it is not available, this header defines nothing.
+
+An executor is a copyable object with a member function
+<c>execute (function)</c>, which arranges for the nullary function to be called
+on some thread, and may return before it is called.
+The function is copyable.
+Executors are copied into coroutines, so they should be lightweight handles,
+for example to a thread pool.
+*/
+
+#ifndef RANGE_ASYNC_HPP_INCLUDED
+#define RANGE_ASYNC_HPP_INCLUDED
+
+#include "detail/coroutine.hpp"
+
+#if RANGE_HAS_COROUTINES
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+#include "utility/returns.hpp"
+
+#include "core.hpp"
+#include "buffer.hpp"
+
+namespace range {
+
+template <class Value> class task;
+
+namespace async_detail {
+
+    class task_promise_base {
+        std::coroutine_handle<> continuation_;
+        std::exception_ptr exception_;
+
+        template <class Value> friend class range::task;
+
+        /// At the end, resume the coroutine that is awaiting the task.
+        struct final_awaiter {
+            bool await_ready() const noexcept { return false; }
+
+            template <class Promise> std::coroutine_handle<> await_suspend (
+                std::coroutine_handle <Promise> handle) const noexcept
+            {
+                std::coroutine_handle<> continuation =
+                    handle.promise().continuation_;
+                if (continuation)
+                    return continuation;
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+    protected:
+        void rethrow_if_exception() {
+            if (exception_)
+                std::rethrow_exception (exception_);
+        }
+
+    public:
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception()
+        { exception_ = std::current_exception(); }
+
+        static void * operator new (std::size_t size)
+        { return coroutine_detail::frame_allocator::allocate (size); }
+
+        static void operator delete (void * frame, std::size_t size) noexcept
+        { coroutine_detail::frame_allocator::deallocate (frame, size); }
+    };
+
+    template <class Value> class task_promise : public task_promise_base {
+        boost::optional <Value> value_;
+
+    public:
+        task <Value> get_return_object();
+
+        template <class Result> void return_value (Result && result)
+        { value_ = Value (std::forward <Result> (result)); }
+
+        Value result() {
+            rethrow_if_exception();
+            return std::move (*value_);
+        }
+    };
+
+    template <> class task_promise <void> : public task_promise_base {
+    public:
+        task <void> get_return_object();
+
+        void return_void() const noexcept {}
+
+        void result() { rethrow_if_exception(); }
+    };
+
+} // namespace async_detail
+
+/** \brief
+Coroutine that computes a value asynchronously.
+
+The coroutine does not start until the task is awaited with \c co_await, or
+passed to sync_wait().
+When it finishes, the awaiting coroutine is resumed on the same thread.
+
+\tparam Value The type of the result, or \c void.
+*/
+template <class Value> class task {
+public:
+    typedef async_detail::task_promise <Value> promise_type;
+    typedef std::coroutine_handle <promise_type> handle_type;
+
+private:
+    handle_type handle_;
+
+    friend class async_detail::task_promise <Value>;
+
+    explicit task (handle_type handle) : handle_ (handle) {}
+
+public:
+    task (task const &) = delete;
+    task (task && other) noexcept
+    : handle_ (std::exchange (other.handle_, nullptr)) {}
+
+    task & operator = (task const &) = delete;
+    task & operator = (task && other) noexcept {
+        std::swap (handle_, other.handle_);
+        return *this;
+    }
+
+    ~task() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    /* Awaitable interface. */
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend (
+        std::coroutine_handle<> continuation) noexcept
+    {
+        handle_.promise().continuation_ = continuation;
+        return handle_;
+    }
+
+    Value await_resume() { return handle_.promise().result(); }
+};
+
+namespace async_detail {
+
+    template <class Value>
+        inline task <Value> task_promise <Value>::get_return_object()
+    {
+        return task <Value> (
+            std::coroutine_handle <task_promise>::from_promise (*this));
+    }
+
+    inline task <void> task_promise <void>::get_return_object() {
+        return task <void> (
+            std::coroutine_handle <task_promise>::from_promise (*this));
+    }
+
+    /// Awaiter that resumes the coroutine through an executor.
+    template <class Executor> struct schedule_awaiter {
+        Executor executor;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend (std::coroutine_handle<> handle)
+        { executor.execute ([handle] { handle.resume(); }); }
+
+        void await_resume() const noexcept {}
+    };
+
+    /// Flag that one thread sets and another waits for.
+    class latch {
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool set_;
+
+    public:
+        latch() : set_ (false) {}
+
+        void set() {
+            // Notify while holding the lock, since the waiting thread destructs
+            // the latch as soon as it can see set_.
+            std::lock_guard <std::mutex> lock (mutex_);
+            set_ = true;
+            condition_.notify_one();
+        }
+
+        void wait() {
+            std::unique_lock <std::mutex> lock (mutex_);
+            condition_.wait (lock, [this] { return set_; });
+        }
+    };
+
+    /**
+    Coroutine that sync_wait() starts.
+    It awaits a task and sets a latch when it is done.
+    */
+    class sync_waiter {
+    public:
+        struct promise_type {
+            latch * latch_;
+            std::exception_ptr exception_;
+
+            struct final_awaiter {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend (std::coroutine_handle <promise_type>
+                    handle) const noexcept
+                { handle.promise().latch_->set(); }
+                void await_resume() const noexcept {}
+            };
+
+            sync_waiter get_return_object() {
+                return sync_waiter (std::coroutine_handle <promise_type>
+                    ::from_promise (*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            final_awaiter final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+
+            void unhandled_exception()
+            { exception_ = std::current_exception(); }
+        };
+
+    private:
+        std::coroutine_handle <promise_type> handle_;
+
+        explicit sync_waiter (std::coroutine_handle <promise_type> handle)
+        : handle_ (handle) {}
+
+    public:
+        sync_waiter (sync_waiter && other) noexcept
+        : handle_ (std::exchange (other.handle_, nullptr)) {}
+
+        ~sync_waiter() {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        /// Run the coroutine and block until it has finished.
+        void run() {
+            latch done;
+            handle_.promise().latch_ = &done;
+            handle_.resume();
+            done.wait();
+            if (handle_.promise().exception_)
+                std::rethrow_exception (handle_.promise().exception_);
+        }
+    };
+
+    template <class Value> inline sync_waiter
+        wait_for (task <Value> & awaited, boost::optional <Value> & result)
+    { result = co_await awaited; }
+
+    inline sync_waiter wait_for (task <void> & awaited)
+    { co_await awaited; }
+
+} // namespace async_detail
+
+/** \brief
+Return an awaitable that resumes the awaiting coroutine through an executor.
+
+\code
+co_await schedule (executor);
+// Now running on a thread of the executor.
+\endcode
+*/
+template <class Executor>
+    inline async_detail::schedule_awaiter <Executor>
+    schedule (Executor const & executor)
+{ return async_detail::schedule_awaiter <Executor> {executor}; }
+
+/** \brief
+Run a task, and block the current thread until it has finished.
+
+\return The result of the task.
+    If the task throws an exception, it is rethrown.
+*/
+template <class Value> inline Value sync_wait (task <Value> awaited) {
+    boost::optional <Value> result;
+    async_detail::wait_for (awaited, result).run();
+    return std::move (*result);
+}
+
+/// \cond DONT_DOCUMENT
+inline void sync_wait (task <void> awaited)
+{ async_detail::wait_for (awaited).run(); }
+/// \endcond
+
+/* Asynchronous ranges. */
+
+namespace callable {
+
+    struct async_chop {
+        template <class Range>
+            auto operator() (Range & range) const
+        RETURNS (implement_async_chop (
+            typename tag_of <Range>::type(), range));
+    };
+
+} // namespace callable
+
+/** \brief
+Return an awaitable that removes the next element from an asynchronous range.
+
+The result of <c>co_await async_chop (range)</c> is a boost::optional with
+the element, or an empty boost::optional if the range was empty.
+Checking for emptiness and retrieving the element are combined, since both may
+need to wait for the producer.
+
+An asynchronous range is a type with a tag that implements
+<c>implement_async_chop (tag, range)</c>, to be found by argument-dependent
+lookup.
+The range is passed as an lvalue reference and must be changed in place.
+\ref async_buffer is an example.
+*/
+static auto const async_chop = callable::async_chop();
+
+template <class Element, class Executor> class async_buffer;
+
+namespace async_operation {
+
+    struct async_buffer_tag {};
+
+    /**
+    Awaitable that implements async_chop for async_buffer.
+    */
+    template <class Element, class Executor> class buffer_chop_awaiter {
+        async_buffer <Element, Executor> & range_;
+        std::exception_ptr exception_;
+        /// Set by whichever of await_suspend and the executor finishes first.
+        std::atomic <bool> finished_;
+
+    public:
+        explicit buffer_chop_awaiter (async_buffer <Element, Executor> & range)
+        : range_ (range), finished_ (false) {}
+
+        // Do not suspend if an element is in memory.
+        bool await_ready() const noexcept
+        { return range_.position_ != range_.producer_->end(); }
+
+        /*
+        Ask the producer for the next chunk on the executor.
+        If the executor calls the function before execute() returns, the
+        coroutine is not suspended, so that the stack does not grow with each
+        chunk.
+        Otherwise, the function resumes the coroutine.
+        */
+        bool await_suspend (std::coroutine_handle<> handle) {
+            range_.executor_.execute ([this, handle] {
+                try {
+                    range_.next_chunk();
+                } catch (...) {
+                    exception_ = std::current_exception();
+                }
+                if (finished_.exchange (true))
+                    handle.resume();
+            });
+            return !finished_.exchange (true);
+        }
+
+        boost::optional <Element> await_resume() {
+            if (exception_)
+                std::rethrow_exception (exception_);
+            if (range_.position_ == range_.producer_->end())
+                return boost::none;
+            return *range_.position_ ++;
+        }
+    };
+
+    template <class Element, class Executor>
+        inline buffer_chop_awaiter <Element, Executor>
+        implement_async_chop (async_buffer_tag const &,
+            async_buffer <Element, Executor> & range)
+    { return buffer_chop_awaiter <Element, Executor> (range); }
+
+} // namespace async_operation
+
+template <class Element, class Executor>
+    struct tag_of_qualified <async_buffer <Element, Executor>>
+{ typedef async_operation::async_buffer_tag type; };
+
+/** \brief
+Asynchronous range that reads elements from an element_producer.
+
+Elements in the current chunk are returned without suspending.
+When the chunk is exhausted, the next chunk is requested from the producer on
+the executor, which may block, for example to read from a file.
+The awaiting coroutine is then resumed on the executor.
+
+Copies of an async_buffer share the producer, like copies of a \ref buffer.
+It is not thread-safe: different copies must not be used at the same time.
+*/
+template <class Element, class Executor> class async_buffer {
+public:
+    typedef typename element_producer <Element>::pointer producer_ptr;
+
+private:
+    producer_ptr producer_;
+    Element const * position_;
+    Executor executor_;
+
+    friend class async_operation::buffer_chop_awaiter <Element, Executor>;
+
+    /// Move to the next chunk, if there is one.
+    void next_chunk() {
+        producer_ptr next = producer_->next();
+        if (next) {
+            producer_ = std::move (next);
+            position_ = producer_->first();
+        }
+    }
+
+public:
+    /// Start at the first element of \a producer.
+    async_buffer (producer_ptr producer, Executor const & executor)
+    : producer_ (std::move (producer)), position_ (producer_->first()),
+        executor_ (executor) {}
+
+    /// Start at the first element of \a buffer.
+    async_buffer (buffer <Element> const & buffer, Executor const & executor)
+    : producer_ (buffer.producer()), position_ (buffer.position()),
+        executor_ (executor) {}
+};
+
+/** \brief
+Make an asynchronous range from a \ref buffer.
+
+\param source The buffer.
+    The range starts at its first element.
+\param executor The executor that requests new chunks from the producer.
+*/
+template <class Element, class Executor>
+    inline async_buffer <Element, Executor>
+    make_async_buffer (buffer <Element> const & source,
+        Executor const & executor)
+{ return async_buffer <Element, Executor> (source, executor); }
+
+/**
+Make an asynchronous range from a pointer to an element_producer.
+\a Element cannot be deduced and must be given explicitly.
+*/
+template <class Element, class Executor>
+    inline async_buffer <Element, Executor>
+    make_async_buffer (
+        typename element_producer <Element>::pointer const & source,
+        Executor const & executor)
+{ return async_buffer <Element, Executor> (source, executor); }
+
+/* Algorithms. */
+
+namespace async_detail {
+
+    template <class Range, class Function, class Executor>
+        inline task <void> for_each (
+            Range range, Function function, Executor executor)
+    {
+        co_await range::schedule (executor);
+        while (auto element = co_await range::async_chop (range))
+            function (std::move (*element));
+    }
+
+    template <class State, class Range, class Function, class Executor>
+        inline task <State> fold (
+            State state, Range range, Function function, Executor executor)
+    {
+        co_await range::schedule (executor);
+        while (auto element = co_await range::async_chop (range))
+            state = function (std::move (state), std::move (*element));
+        co_return std::move (state);
+    }
+
+} // namespace async_detail
+
+namespace callable {
+
+    struct async_for_each {
+        template <class Range, class Function, class Executor>
+            auto operator() (Range && range, Function && function,
+                Executor const & executor) const
+        RETURNS (async_detail::for_each (
+            typename std::decay <Range>::type (std::forward <Range> (range)),
+            typename std::decay <Function>::type (
+                std::forward <Function> (function)),
+            executor));
+    };
+
+    struct async_fold {
+        template <class State, class Range, class Function, class Executor>
+            auto operator() (State && state, Range && range,
+                Function && function, Executor const & executor) const
+        RETURNS (async_detail::fold (
+            typename std::decay <State>::type (std::forward <State> (state)),
+            typename std::decay <Range>::type (std::forward <Range> (range)),
+            typename std::decay <Function>::type (
+                std::forward <Function> (function)),
+            executor));
+    };
+
+} // namespace callable
+
+/** \brief
+Return a task that calls a function with each element of an asynchronous
+range.
+
+The task starts by moving to the executor.
+It then awaits each element with async_chop().
+While the range waits for its producer, no thread is blocked, so that many
+ranges can be consumed concurrently by an executor with few threads.
+
+\code
+auto lines = make_async_buffer (read_file ("log.txt"), pool);
+sync_wait (async_for_each (lines, [] (char c) { ... }, pool));
+\endcode
+
+The range, the function and the executor are copied into the task.
+
+\param range The asynchronous range.
+\param function The function to call with each element.
+\param executor The executor to run the task on.
+*/
+static auto const async_for_each = callable::async_for_each();
+
+/** \brief
+Return a task that folds an asynchronous range into a state.
+
+Like fold(), the function is called with the current state and the next
+element, and returns the next state.
+The state type is the decayed type of \a state; the function's result must be
+convertible to it.
+The task runs on \a executor, like the task from async_for_each().
+
+\param state The initial state.
+\param range The asynchronous range.
+\param function The function to call with the state and each element.
+\param executor The executor to run the task on.
+*/
+static auto const async_fold = callable::async_fold();
+
+} // namespace range
+
+#endif // RANGE_HAS_COROUTINES
+
+#endif // RANGE_ASYNC_HPP_INCLUDED
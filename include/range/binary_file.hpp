@@ -0,0 +1,293 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define facilities to write records of a fixed size to binary files, and read
+them back as ranges.
+*/
+
+#ifndef RANGE_BINARY_FILE_HPP_INCLUDED
+#define RANGE_BINARY_FILE_HPP_INCLUDED
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/info.hpp>
+
+#include "utility/returns.hpp"
+
+#include "core.hpp"
+#include "buffer.hpp"
+#include "file_buffer.hpp"
+
+namespace range {
+
+/** \brief
+Exception that indicates an error while writing to a file.
+*/
+struct file_write_error
+: virtual std::ios_base::failure, virtual boost::exception
+{
+    file_write_error()
+    : std::ios_base::failure ("Error writing to file") {}
+};
+
+namespace binary_file_detail {
+
+    inline std::shared_ptr <FILE> open (
+        std::string const & file_name, char const * mode)
+    {
+        FILE * handle = std::fopen (file_name.c_str(), mode);
+        if (!handle)
+            throw file_open_error() <<
+                boost::errinfo_errno (errno) <<
+                boost::errinfo_file_name (file_name);
+        return std::shared_ptr <FILE> (handle, std::fclose);
+    }
+
+    template <class Record> struct check_record {
+        static_assert (std::is_trivially_copyable <Record>::value,
+            "Records in binary files must be trivially copyable.");
+    };
+
+} // namespace binary_file_detail
+
+/** \brief
+Write records of a fixed size to a binary file.
+
+The bytes of each record are written as they are in memory, so the file can
+only be read back on the same platform, by a program that uses the same
+definition of Record.
+Writing is buffered; flush() makes sure that the records are in the file.
+
+\tparam Record The type of the records.
+    It must be trivially copyable.
+*/
+template <class Record> class binary_writer
+: binary_file_detail::check_record <Record>
+{
+    std::shared_ptr <FILE> file_;
+
+public:
+    /**
+    Create the file with name \a file_name, or overwrite it.
+    \throw file_open_error Iff the file cannot be opened.
+    */
+    explicit binary_writer (std::string const & file_name)
+    : file_ (binary_file_detail::open (file_name, "wb")) {}
+
+    /**
+    Write to a file that is already open, at its current position.
+    */
+    explicit binary_writer (std::shared_ptr <FILE> file)
+    : file_ (std::move (file)) {}
+
+    /**
+    Write \a number records starting at \a records.
+    \throw file_write_error Iff an error occurs.
+    */
+    void write_n (Record const * records, std::size_t number) {
+        if (std::fwrite (records, sizeof (Record), number, file_.get())
+                != number)
+            throw file_write_error() << boost::errinfo_errno (errno);
+    }
+
+    /// Write one record.
+    void write (Record const & record) { write_n (&record, 1); }
+
+    /**
+    Write all elements of \a records, which must be convertible to Record.
+    */
+    template <class Range> void write_range (Range && records) {
+        auto remaining = range::view (std::forward <Range> (records), front);
+        while (!range::empty (remaining, front))
+            write (range::chop_in_place (remaining, front));
+    }
+
+    /**
+    Write buffered data to the file.
+    \throw file_write_error Iff an error occurs.
+    */
+    void flush() {
+        if (std::fflush (file_.get()) != 0)
+            throw file_write_error() << boost::errinfo_errno (errno);
+    }
+
+    std::shared_ptr <FILE> const & file() const { return file_; }
+};
+
+template <class Record> class binary_file_element_producer;
+
+/** \brief
+Read the records in a binary file, as written by \ref binary_writer, and
+expose them as a \ref buffer.
+
+\throw file_open_error Iff the file cannot be opened.
+*/
+template <class Record> inline
+    buffer <Record> read_binary_file (std::string const & file_name)
+{
+    typedef typename buffer <Record>::producer_ptr producer_ptr;
+    return buffer <Record> (producer_ptr::template construct <
+        binary_file_element_producer <Record>> (
+            binary_file_detail::open (file_name, "rb")));
+}
+
+/** \brief
+Read records from a file that is already open, from its current position to
+its end, and expose them as a \ref buffer.
+*/
+template <class Record> inline
+    buffer <Record> read_binary_file (std::shared_ptr <FILE> file)
+{
+    typedef typename buffer <Record>::producer_ptr producer_ptr;
+    return buffer <Record> (producer_ptr::template construct <
+        binary_file_element_producer <Record>> (std::move (file)));
+}
+
+/**
+Element producer that reads records of a fixed size from a file.
+A file whose size is not a multiple of the size of a record causes a
+\ref file_read_error.
+*/
+template <class Record> class binary_file_element_producer
+: public internal_element_producer <Record, 0>,
+    binary_file_detail::check_record <Record>
+{
+    typedef internal_element_producer <Record, 0> base_type;
+    typedef typename base_type::pointer pointer;
+
+    // Only the last producer needs and has access to the file.
+    std::shared_ptr <FILE> file_;
+
+protected:
+    virtual pointer get_next() {
+        return pointer::template construct <binary_file_element_producer> (
+            std::move (file_));
+    }
+
+    void fill() {
+        std::size_t const capacity = this->memory_end() - this->memory();
+        char * memory = reinterpret_cast <char *> (this->memory());
+        std::size_t bytes = std::fread (
+            memory, 1, capacity * sizeof (Record), file_.get());
+        if (std::ferror (file_.get()))
+            throw file_read_error() << boost::errinfo_errno (errno);
+        if (bytes % sizeof (Record) != 0)
+            throw file_read_error();
+        this->end_ = this->memory() + bytes / sizeof (Record);
+    }
+
+public:
+    explicit binary_file_element_producer (std::shared_ptr <FILE> file)
+    : file_ (std::move (file))
+    { fill(); }
+};
+
+template <class Record, class Underlying> class binary_record_range;
+
+namespace binary_file_operation {
+
+    struct binary_record_range_tag {};
+
+    template <class Record, class Underlying>
+    inline auto implement_chop (binary_record_range_tag const & tag,
+        binary_record_range <Record, Underlying> && range,
+        direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
+} // namespace binary_file_operation
+
+template <class Record, class Underlying>
+    struct tag_of_qualified <binary_record_range <Record, Underlying>>
+{ typedef binary_file_operation::binary_record_range_tag type; };
+
+/**
+Range that decodes records from a range of bytes.
+It can only be traversed from the front with chop_in_place().
+*/
+template <class Record, class Underlying> class binary_record_range
+: binary_file_detail::check_record <Record>
+{
+    Underlying underlying_;
+
+public:
+    explicit binary_record_range (Underlying underlying)
+    : underlying_ (std::move (underlying)) {}
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const
+    { return range::empty (underlying_, front); }
+
+    Record chop_in_place (direction::front) {
+        Record record;
+        char * bytes = reinterpret_cast <char *> (&record);
+        for (std::size_t i = 0; i != sizeof (Record); ++ i) {
+            // The range of bytes ends in the middle of a record.
+            if (range::empty (underlying_, front))
+                throw file_read_error();
+            bytes [i] = range::chop_in_place (underlying_, front);
+        }
+        return record;
+    }
+};
+
+namespace callable {
+
+    template <class Record> struct decode_binary {
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && bytes) const
+        RETURNS (binary_record_range <Record, typename std::decay <
+                decltype (range::view (std::forward <Range> (bytes), front))
+            >::type> (range::view (std::forward <Range> (bytes), front)));
+    };
+
+} // namespace callable
+
+/** \brief
+Decode records of a fixed size from a range of bytes.
+
+This allows records to be read from a compressed file, for example:
+\code
+auto records = decode_binary <record> (read_gzip_file ("records.gz"));
+\endcode
+The bytes are expected to be as written by \ref binary_writer.
+If the range of bytes ends in the middle of a record, then chop_in_place()
+throws \ref file_read_error.
+For uncompressed files, read_binary_file() is faster.
+
+\tparam Record The type of the records.
+    It must be trivially copyable.
+\param bytes The range of bytes, which is traversed from the front.
+\return A range that can be traversed from the front with chop_in_place().
+*/
+template <class Record, class Range> inline
+    auto decode_binary (Range && bytes)
+RETURNS (callable::decode_binary <Record>() (std::forward <Range> (bytes)));
+
+} // namespace range
+
+#endif // RANGE_BINARY_FILE_HPP_INCLUDED
@@ -28,6 +28,7 @@ limitations under the License.
 #include "utility/is_trivially_destructible.hpp"
 
 #include "core.hpp"
+#include "function_range.hpp"
 
 namespace range {
 
@@ -80,6 +81,9 @@ namespace buffer_detail {
     template <class Range, class Element, std::size_t NumberOrZero>
         class range_element_producer;
 
+    template <class Function, class Element, std::size_t NumberOrZero>
+        class block_element_producer;
+
 } // namespace buffer_detail
 
 /** \brief
@@ -119,6 +123,15 @@ public:
     explicit buffer (producer_ptr producer)
     : producer_ (std::move (producer)), first_ (producer_->first()) {}
 
+    /// \return The producer that holds the first element.
+    producer_ptr const & producer() const { return producer_; }
+
+    /**
+    \return A pointer to the first element, inside the chunk of producer().
+    If this equals <c>producer()->end()</c>, then the buffer is empty.
+    */
+    Element const * position() const { return first_; }
+
 private:
     /// Construct a buffer with \a producer, starting not necessarily at its
     /// first element.
@@ -231,6 +244,30 @@ buffer <Element> make_buffer (Range && range)
 }
 /// \endcond
 
+/** \brief
+Make a \ref buffer object from a range created by make_block_function_range().
+
+The function writes its elements directly into the chunks of the buffer, one
+call per chunk.
+This is more efficient than generating the elements into a separate block and
+copying them.
+
+\tparam Element (optional) The element type of the range.
+    To give \a Number, \a Element must also be given.
+\tparam Number (optional)
+    The number of elements kept in one chunk.
+    If not given, a reasonable value is picked automatically.
+*/
+template <class Element, std::size_t Number = 0, class Function>
+buffer <Element> make_buffer (
+    block_function_range <Element, Function> && range)
+{
+    typedef typename buffer <Element>::producer_ptr producer_ptr;
+    return buffer <Element> (producer_ptr::template construct <
+        buffer_detail::block_element_producer <Function, Element, Number>> (
+            std::move (range)));
+}
+
 template <class Element> class element_producer
 : public utility::shared
 {
@@ -409,6 +446,56 @@ public:
     { fill(); }
 };
 
+/**
+Element producer that has the function of a block_function_range write each
+chunk directly.
+*/
+template <class Function, class Element, std::size_t NumberOrZero>
+class block_element_producer
+: public internal_element_producer <Element, NumberOrZero>
+{
+    typedef internal_element_producer <Element, NumberOrZero> base_type;
+    typedef typename base_type::pointer pointer;
+
+    // Only the last producer needs and has access to the range.
+    block_function_range <Element, Function> range_;
+
+protected:
+    virtual pointer get_next() {
+        return pointer::template construct <block_element_producer> (
+            std::move (range_));
+    }
+
+    void fill() {
+        std::size_t const size =
+            compute_element_num <Element, NumberOrZero>::value;
+        Element * const begin = this->memory();
+        Element * const end = begin + size;
+
+        // The function assigns to elements, so they must be constructed
+        // first.
+        // If an exception is thrown, the destructor destructs all of them.
+        for (Element * current = begin; current != end; ++ current) {
+            new (current) Element;
+            this->end_ = current + 1;
+        }
+
+        Element * const filled = begin + range_.read (begin, size);
+        for (Element * current = filled; current != end; ++ current)
+            current->~Element();
+        this->end_ = filled;
+    }
+
+public:
+    block_element_producer (block_function_range <Element, Function> && range)
+    : internal_element_producer <Element, NumberOrZero>(),
+        range_ (std::move (range))
+    {
+        this->end_ = this->memory();
+        fill();
+    }
+};
+
 } // namespace buffer_detail
 
 } // namespace range
@@ -0,0 +1,370 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define a bounded lock-free channel that passes elements between threads, and
+a range that reads from it.
+*/
+
+#ifndef RANGE_CHANNEL_HPP_INCLUDED
+#define RANGE_CHANNEL_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+
+namespace range {
+
+namespace channel_detail {
+
+    /// The size of a cache line that is assumed, to avoid false sharing.
+    static constexpr std::size_t cache_line_size = 64;
+
+    /// \return The smallest power of two that is at least \a number.
+    inline std::size_t round_up_to_power_of_two (std::size_t number) {
+        std::size_t result = 1;
+        while (result < number)
+            result *= 2;
+        return result;
+    }
+
+    /**
+    Wait a little while, for a condition that another thread will make true.
+    Spin first, and then yield to other threads.
+    */
+    class backoff {
+        unsigned count_;
+
+    public:
+        backoff() : count_ (0) {}
+
+        void operator() () {
+            if (count_ < 64) {
+                ++ count_;
+                // Spin.
+                std::atomic_signal_fence (std::memory_order_seq_cst);
+            } else
+                std::this_thread::yield();
+        }
+    };
+
+} // namespace channel_detail
+
+template <class Element> class channel_range;
+
+/** \brief
+Bounded multi-producer, multi-consumer queue that does not use locks.
+
+This is the bounded queue by Dmitry Vyukov.
+Each cell in a ring buffer has a sequence number, which indicates whether it
+is ready to be written to or read from in the current round.
+Producers and consumers claim cells by incrementing a position with a
+compare-and-swap, and then write or read the cell without contention.
+The two positions are kept in separate cache lines, so that producers and
+consumers do not slow each other down.
+
+Batches of elements can be pushed and popped with one compare-and-swap, which
+is much faster when many elements pass through the channel.
+
+After all elements have been pushed, close() must be called, so that the
+consumers know that no more elements will arrive.
+
+The consumer side is normally used through reader(), which returns a range.
+Element must be default-constructible and move-assignable, since batches of
+elements are moved into arrays.
+Moving elements must not throw: cells are claimed before elements are moved
+into or out of them, and a cell whose move throws is never released, so that
+all producers and consumers then wait forever.
+This is not checked with std::is_nothrow_move_constructible, since types like
+\ref tuple do not declare their moves \c noexcept even when they cannot throw.
+*/
+template <class Element> class channel {
+    struct cell {
+        std::atomic <std::size_t> sequence;
+        typename std::aligned_storage <sizeof (Element), alignof (Element)
+            >::type storage;
+
+        Element * element()
+        { return reinterpret_cast <Element *> (&storage); }
+    };
+
+    typedef char padding [channel_detail::cache_line_size];
+
+    padding padding_0_;
+    std::unique_ptr <cell []> const cells_;
+    std::size_t const mask_;
+    padding padding_1_;
+    std::atomic <std::size_t> push_position_;
+    padding padding_2_;
+    std::atomic <std::size_t> pop_position_;
+    padding padding_3_;
+    std::atomic <bool> closed_;
+
+    /**
+    Claim up to \a maximum cells at \a position.
+    A cell at position p is ready if its sequence number is p + offset.
+    \return The position of the first cell claimed, and the number of cells.
+    */
+    std::pair <std::size_t, std::size_t> claim (
+        std::atomic <std::size_t> & position, std::size_t offset,
+        std::size_t maximum)
+    {
+        std::size_t current = position.load (std::memory_order_relaxed);
+        while (true) {
+            std::size_t number = 0;
+            bool behind = false;
+            for (; number != maximum; ++ number) {
+                std::size_t sequence = cells_ [(current + number) & mask_]
+                    .sequence.load (std::memory_order_acquire);
+                std::size_t expected = current + number + offset;
+                if (sequence != expected) {
+                    // Another thread has claimed and finished the cell.
+                    behind = std::ptrdiff_t (sequence - expected) > 0;
+                    break;
+                }
+            }
+            if (number != 0) {
+                if (position.compare_exchange_weak (current, current + number,
+                        std::memory_order_relaxed))
+                    return std::make_pair (current, number);
+                // "current" has been updated: try again.
+            } else if (behind)
+                current = position.load (std::memory_order_relaxed);
+            else
+                // The channel is full (for pushing) or empty (for popping).
+                return std::make_pair (current, std::size_t (0));
+        }
+    }
+
+public:
+    /**
+    Construct an empty channel.
+    \param capacity The minimum number of elements that can be in the channel.
+        It is rounded up to a power of two.
+    */
+    explicit channel (std::size_t capacity)
+    : cells_ (new cell [channel_detail::round_up_to_power_of_two (capacity)]),
+        mask_ (channel_detail::round_up_to_power_of_two (capacity) - 1),
+        push_position_ (0), pop_position_ (0), closed_ (false)
+    {
+        for (std::size_t i = 0; i != mask_ + 1; ++ i)
+            cells_ [i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    channel (channel const &) = delete;
+    channel & operator = (channel const &) = delete;
+
+    /// Destruct the elements that are still in the channel.
+    ~channel() {
+        std::size_t const end = push_position_.load();
+        for (std::size_t position = pop_position_.load(); position != end;
+                ++ position)
+            cells_ [position & mask_].element()->~Element();
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    /**
+    Push elements, as many as there is space for, moving them from
+    \a elements.
+    \return The number of elements pushed, from the start of \a elements.
+    */
+    std::size_t try_push_n (Element * elements, std::size_t number) {
+        rime::assert_ (!closed_.load (std::memory_order_relaxed));
+        auto claimed = claim (push_position_, 0, number);
+        for (std::size_t i = 0; i != claimed.second; ++ i) {
+            cell & current = cells_ [(claimed.first + i) & mask_];
+            new (current.element()) Element (std::move (elements [i]));
+            current.sequence.store (claimed.first + i + 1,
+                std::memory_order_release);
+        }
+        return claimed.second;
+    }
+
+    /**
+    Pop elements, as many as are available, up to \a maximum, into
+    \a elements, which must point to constructed elements.
+    \return The number of elements popped.
+    */
+    std::size_t try_pop_n (Element * elements, std::size_t maximum) {
+        auto claimed = claim (pop_position_, 1, maximum);
+        for (std::size_t i = 0; i != claimed.second; ++ i) {
+            cell & current = cells_ [(claimed.first + i) & mask_];
+            elements [i] = std::move (*current.element());
+            current.element()->~Element();
+            current.sequence.store (claimed.first + i + mask_ + 1,
+                std::memory_order_release);
+        }
+        return claimed.second;
+    }
+
+    /// Push an element if there is space. \return Whether it was pushed.
+    bool try_push (Element element)
+    { return try_push_n (&element, 1) == 1; }
+
+    /// Pop an element if one is available. \return Whether it was popped.
+    bool try_pop (Element & element)
+    { return try_pop_n (&element, 1) == 1; }
+
+    /// Push elements, waiting for space if necessary.
+    void push_n (Element * elements, std::size_t number) {
+        channel_detail::backoff wait;
+        while (number != 0) {
+            std::size_t pushed = try_push_n (elements, number);
+            if (pushed == 0)
+                wait();
+            elements += pushed;
+            number -= pushed;
+        }
+    }
+
+    /// Push an element, waiting for space if necessary.
+    void push (Element element) { push_n (&element, 1); }
+
+    /**
+    Pop elements, up to \a maximum, waiting until at least one is available or
+    the channel is closed and empty.
+    \return The number of elements popped, which is 0 only at the end.
+    */
+    std::size_t pop_n (Element * elements, std::size_t maximum) {
+        channel_detail::backoff wait;
+        while (true) {
+            std::size_t popped = try_pop_n (elements, maximum);
+            if (popped != 0)
+                return popped;
+            if (closed_.load (std::memory_order_acquire))
+                // All elements pushed before close() are now visible.
+                return try_pop_n (elements, maximum);
+            wait();
+        }
+    }
+
+    /**
+    Push all elements of \a source, traversing it from the front with
+    chop_in_place(), in batches of up to \a batch_size elements.
+    \a source can be any range whose elements are convertible to Element.
+    */
+    template <class Source>
+        void push_range (Source && source, std::size_t batch_size = 64)
+    {
+        auto remaining = range::view (std::forward <Source> (source), front);
+        std::unique_ptr <Element []> batch (new Element [batch_size]);
+        while (!range::empty (remaining, front)) {
+            std::size_t number = 0;
+            for (; number != batch_size && !range::empty (remaining, front);
+                    ++ number)
+                batch [number] = range::chop_in_place (remaining, front);
+            push_n (batch.get(), number);
+        }
+    }
+
+    /**
+    Indicate that no more elements will be pushed.
+    With multiple producers, call this after all of them have finished.
+    */
+    void close() { closed_.store (true, std::memory_order_release); }
+
+    bool closed() const { return closed_.load (std::memory_order_acquire); }
+
+    /**
+    Return a range that pops elements from this channel.
+    Each consumer thread should use its own range.
+    \param batch_size The maximum number of elements that the range pops at
+        once.
+    */
+    channel_range <Element> reader (std::size_t batch_size = 64)
+    { return channel_range <Element> (*this, batch_size); }
+};
+
+namespace channel_operation {
+
+    struct channel_range_tag {};
+
+    template <class Element>
+    inline auto implement_chop (channel_range_tag const & tag,
+        channel_range <Element> && range, direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
+} // namespace channel_operation
+
+template <class Element> struct tag_of_qualified <channel_range <Element>>
+{ typedef channel_operation::channel_range_tag type; };
+
+/** \brief
+Range that pops elements from a \ref channel.
+
+Elements are popped in batches, and kept in the range until they are
+requested.
+empty() waits until an element is available, or the channel is closed and
+empty.
+This range refers to the channel, which must remain alive while it is used.
+It is noncopyable, but movable.
+*/
+template <class Element> class channel_range {
+    channel <Element> * channel_;
+    std::size_t batch_size_;
+    std::unique_ptr <Element []> batch_;
+    // The batch is filled by empty(), which must be const.
+    mutable std::size_t first_;
+    mutable std::size_t end_;
+
+    void load() const {
+        if (first_ == end_) {
+            first_ = 0;
+            end_ = channel_->pop_n (batch_.get(), batch_size_);
+        }
+    }
+
+public:
+    channel_range (channel <Element> & channel, std::size_t batch_size)
+    : channel_ (&channel), batch_size_ (batch_size),
+        batch_ (new Element [batch_size]), first_ (0), end_ (0)
+    { rime::assert_ (batch_size != 0); }
+
+    channel_range (channel_range const &) = delete;
+    channel_range (channel_range &&) = default;
+
+    channel_range & operator = (channel_range const &) = delete;
+    channel_range & operator = (channel_range &&) = default;
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const {
+        load();
+        return first_ == end_;
+    }
+
+    Element chop_in_place (direction::front) {
+        load();
+        rime::assert_ (first_ != end_);
+        return std::move (batch_ [first_ ++]);
+    }
+};
+
+} // namespace range
+
+#endif // RANGE_CHANNEL_HPP_INCLUDED
@@ -0,0 +1,411 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define adaptors that split a range into consecutive blocks of elements.
+*/
+
+#ifndef RANGE_CHUNK_HPP_INCLUDED
+#define RANGE_CHUNK_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "meta/vector.hpp"
+#include "meta/count.hpp"
+
+#include "rime/core.hpp"
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "take.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+template <class Underlying, class Limit, class Direction> class chunk_view;
+template <class Underlying, std::size_t Size, class Direction>
+    class chunk_exact_view;
+
+namespace chunk_operation {
+    struct chunk_view_tag {};
+    struct chunk_exact_view_tag {};
+} // namespace chunk_operation
+
+template <class Underlying, class Limit, class Direction>
+    struct tag_of_qualified <chunk_view <Underlying, Limit, Direction>>
+{ typedef chunk_operation::chunk_view_tag type; };
+
+template <class Underlying, std::size_t Size, class Direction>
+    struct tag_of_qualified <chunk_exact_view <Underlying, Size, Direction>>
+{ typedef chunk_operation::chunk_exact_view_tag type; };
+
+namespace chunk_detail {
+
+    /**
+    Return \a view with at most \a limit elements removed from \a direction.
+    If the view has fewer elements, return an empty view.
+    The result has the same type as \a view.
+    */
+    struct advance {
+        // If the size is known, drop the elements in one go.
+        template <class View, class Limit, class Direction,
+            class Size = decltype (range::size (
+                std::declval <View const &>(), std::declval <Direction>()))>
+        View operator() (View const & view, Limit const & limit,
+            Direction const & direction, overload_order <1> *) const
+        {
+            std::size_t size = range::size (view, direction);
+            std::size_t increment = limit;
+            return range::drop (view,
+                increment < size ? increment : size, direction);
+        }
+
+        // Otherwise, drop one element at a time.
+        template <class View, class Limit, class Direction>
+        View operator() (View view, Limit const & limit,
+            Direction const & direction, overload_order <2> *) const
+        {
+            for (std::size_t remaining = limit;
+                remaining != 0 && !range::empty (view, direction); -- remaining)
+            {
+                view = range::drop (view, direction);
+            }
+            return view;
+        }
+    };
+
+    /**
+    Return \c true iff \a view has at least \a number elements.
+    */
+    struct has_at_least {
+        template <class View, class Direction,
+            class Size = decltype (range::size (
+                std::declval <View const &>(), std::declval <Direction>()))>
+        bool operator() (View const & view, std::size_t number,
+            Direction const & direction, overload_order <1> *) const
+        { return number <= std::size_t (range::size (view, direction)); }
+
+        template <class View, class Direction>
+        bool operator() (View view, std::size_t number,
+            Direction const & direction, overload_order <2> *) const
+        {
+            for (; number != 0; -- number) {
+                if (range::empty (view, direction))
+                    return false;
+                view = range::drop (view, direction);
+            }
+            return true;
+        }
+    };
+
+} // namespace chunk_detail
+
+/**
+View of a range as a sequence of consecutive chunks of elements.
+Each chunk is a view of the underlying range, produced by \ref take.
+The last chunk can be shorter than the limit.
+*/
+template <class Underlying, class Limit, class Direction> class chunk_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+public:
+    typedef Underlying underlying_type;
+    typedef Limit limit_type;
+
+    chunk_view (Underlying const & underlying, Limit const & limit,
+        Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (underlying), limit_ (limit)
+    { rime::assert_ (limit_ != rime::make_zero (limit_)); }
+
+    chunk_view (Underlying && underlying, Limit const & limit,
+        Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (std::move (underlying)), limit_ (limit)
+    { rime::assert_ (limit_ != rime::make_zero (limit_)); }
+
+    /// \return The maximum number of elements in each chunk.
+    Limit limit() const { return limit_; }
+
+    /// \return The part of the underlying range that has not been visited.
+    Underlying const & underlying() const { return underlying_; }
+
+private:
+    Underlying underlying_;
+    Limit limit_;
+
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (underlying_,
+        this->direction_must_be_equal (direction)));
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    std::size_t size (Direction const & direction) const {
+        std::size_t underlying_size = range::size (underlying_, direction);
+        std::size_t limit = limit_;
+        return (underlying_size + limit - 1) / limit;
+    }
+
+    auto first (Direction const & direction) const
+    RETURNS (range::take (underlying_, limit_,
+        this->direction_must_be_equal (direction)));
+
+    chunk_view drop_one (Direction const & direction) const {
+        rime::assert_ (!range::empty (underlying_, direction));
+        return chunk_view (chunk_detail::advance() (
+                underlying_, limit_, direction, pick_overload()),
+            limit_, direction);
+    }
+
+    template <class Increment> chunk_view drop (Increment const & increment,
+        Direction const & direction) const
+    {
+        std::size_t limit = limit_;
+        std::size_t chunk_number = increment;
+        return chunk_view (chunk_detail::advance() (
+                underlying_, chunk_number * limit, direction, pick_overload()),
+            limit_, direction);
+    }
+};
+
+/**
+View of a range as a sequence of consecutive chunks of exactly \a Size
+elements.
+Each chunk is returned as a std::array, which is filled with an expansion
+rather than a loop, so that code working on it can be unrolled.
+Elements at the end that do not make up a full chunk are not visited.
+*/
+template <class Underlying, std::size_t Size, class Direction>
+    class chunk_exact_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+    static_assert (Size != 0, "The chunk size must be positive.");
+public:
+    typedef Underlying underlying_type;
+
+    typedef typename std::decay <decltype (range::first (
+        std::declval <Underlying const &>(), std::declval <Direction>()))
+        >::type element_type;
+
+    typedef std::array <element_type, Size> value_type;
+
+    chunk_exact_view (Underlying const & underlying,
+        Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (underlying) {}
+
+    chunk_exact_view (Underlying && underlying, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (std::move (underlying)) {}
+
+    /// \return The part of the underlying range that has not been visited.
+    Underlying const & underlying() const { return underlying_; }
+
+private:
+    Underlying underlying_;
+
+    typedef typename meta::count <Size>::type indices;
+
+    friend class helper::member_access;
+
+    /**
+    Take \a Size elements from \a source and return them as an array.
+    The elements of a braced initialiser list are evaluated in order.
+    */
+    template <class ... Indices> static value_type fill (Underlying & source,
+        Direction const & direction, meta::vector <Indices ...>)
+    {
+        return value_type {{ (static_cast <void> (Indices::value),
+            element_type (range::chop_in_place (source, direction))) ... }};
+    }
+
+    bool empty (Direction const & direction) const {
+        return !chunk_detail::has_at_least() (underlying_, Size,
+            this->direction_must_be_equal (direction), pick_overload());
+    }
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    std::size_t size (Direction const & direction) const
+    { return std::size_t (range::size (underlying_, direction)) / Size; }
+
+    value_type first (Direction const & direction) const {
+        rime::assert_ (!empty (direction));
+        Underlying source = underlying_;
+        return fill (source, direction, indices());
+    }
+
+    chunk_exact_view drop_one (Direction const & direction) const {
+        rime::assert_ (!empty (direction));
+        return chunk_exact_view (chunk_detail::advance() (
+            underlying_, Size, direction, pick_overload()), direction);
+    }
+
+    template <class Increment> chunk_exact_view drop (
+        Increment const & increment, Direction const & direction) const
+    {
+        std::size_t chunk_number = increment;
+        return chunk_exact_view (chunk_detail::advance() (underlying_,
+            chunk_number * Size, direction, pick_overload()), direction);
+    }
+
+    value_type chop_in_place (Direction const & direction) {
+        rime::assert_ (!empty (direction));
+        return fill (underlying_, direction, indices());
+    }
+};
+
+namespace callable {
+
+    struct chunk {
+    private:
+        struct dispatch {
+            template <class View, class Limit, class Direction>
+                auto operator() (View && view, Limit const & limit,
+                    Direction const & direction) const
+            RETURNS (chunk_view <typename std::decay <View>::type,
+                typename std::decay <Limit>::type, Direction> (
+                    std::forward <View> (view), limit, direction));
+        };
+
+    public:
+        template <class Range, class Limit, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, Limit const & limit,
+            Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            limit, direction));
+
+        template <class Range, class Limit, class Enable =
+            typename std::enable_if <
+                is_range <Range>::value && !is_direction <Limit>::value
+            >::type>
+        auto operator() (Range && range, Limit const & limit) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            limit, range::default_direction (range)));
+    };
+
+    struct chunk_exact {
+    private:
+        template <std::size_t Size> struct dispatch {
+            template <class View, class Direction>
+                auto operator() (View && view, Direction const & direction)
+                const
+            RETURNS (chunk_exact_view <typename std::decay <View>::type,
+                Size, Direction> (std::forward <View> (view), direction));
+        };
+
+    public:
+        template <class Range, class Size, class Direction,
+            class Enable = typename std::enable_if <
+                rime::is_constant <Size>::value
+                && is_direction <Direction>::value>::type>
+        auto operator() (Range && range, Size const &,
+            Direction const & direction) const
+        RETURNS (dispatch <Size::value>() (
+            range::view (std::forward <Range> (range), direction),
+            direction));
+
+        template <class Range, class Size, class Enable =
+            typename std::enable_if <
+                is_range <Range>::value && rime::is_constant <Size>::value
+            >::type>
+        auto operator() (Range && range, Size const &) const
+        RETURNS (dispatch <Size::value>() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            range::default_direction (range)));
+    };
+
+} // namespace callable
+
+/**
+Split a range into consecutive chunks of \a limit elements.
+
+Each element of the result is a view of \a limit elements of the underlying
+range, as returned by \ref take.
+The last chunk contains the remaining elements, and can therefore be shorter.
+This is useful for processing elements in blocks, for example to dispatch
+blocks to different threads, or to use fast paths for contiguous ranges.
+If the underlying range is contiguous (e.g. a std::vector), each chunk is, too.
+
+\code
+std::vector <int> v = {1, 2, 3, 4, 5};
+auto c = chunk (v, 2);
+// first (c) contains 1, 2; second (c) contains 3, 4; third (c) contains 5.
+\endcode
+
+The underlying view must be copyable, and dropping elements from it must
+return the same type.
+If the underlying view has a size, then so does the result.
+
+\param range The range to split.
+\param limit The number of elements in each chunk.
+    This must be positive.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const chunk = callable::chunk();
+
+/**
+Split a range into consecutive chunks of a number of elements that is known at
+compile time.
+
+Each element of the result is a std::array with \a size elements.
+Because the size is known, code that processes the array can be unrolled by
+the compiler.
+Elements at the end that do not make up a full chunk are not visited.
+
+\code
+std::vector <float> v = ...;
+RANGE_FOR_EACH (block, chunk_exact (v, rime::size_t <4>())) {
+    // block is a std::array <float, 4>.
+}
+\endcode
+
+The underlying view must be copyable, and dropping elements from it must
+return the same type.
+If the underlying view has a size, then so does the result.
+
+\param range The range to split.
+\param size The number of elements in each chunk, as a compile-time constant,
+    e.g. rime::size_t <4>().
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+    The elements in each array are in the order of traversal.
+*/
+static auto const chunk_exact = callable::chunk_exact();
+
+} // namespace range
+
+#endif // RANGE_CHUNK_HPP_INCLUDED
@@ -0,0 +1,452 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define an adaptor that presents a number of ranges one after the other.
+*/
+
+#ifndef RANGE_CONCATENATE_HPP_INCLUDED
+#define RANGE_CONCATENATE_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "meta/all_of_c.hpp"
+#include "meta/vector.hpp"
+
+#include "utility/returns.hpp"
+
+#include "rime/core.hpp"
+#include "rime/call_if.hpp"
+
+#include "core.hpp"
+#include "fold.hpp"
+#include "for_each.hpp"
+#include "find.hpp"
+#include "equal.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+template <class Direction, class Leading, class Trailing>
+    class concatenate_view;
+
+namespace concatenate_operation {
+    template <class Direction> struct concatenate_view_tag {};
+} // namespace concatenate_operation
+
+template <class Direction, class Leading, class Trailing>
+    struct tag_of_qualified <concatenate_view <Direction, Leading, Trailing>>
+{
+    typedef concatenate_operation::concatenate_view_tag <Direction> type;
+};
+
+/**
+View of two ranges, one after the other.
+Concatenations of more ranges are built by nesting: the trailing range is then
+itself a concatenate_view.
+
+\tparam Direction The direction in which the ranges are traversed.
+\tparam Leading The range that is traversed first.
+\tparam Trailing The range that is traversed after Leading is exhausted.
+*/
+template <class Direction, class Leading, class Trailing>
+    class concatenate_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (is_view <Leading, Direction>::value
+        && is_view <Trailing, Direction>::value,
+        "The ranges must be views in Direction.");
+public:
+    typedef Leading leading_type;
+    typedef Trailing trailing_type;
+
+    template <class Leading_, class Trailing_>
+        concatenate_view (Direction const & direction,
+            Leading_ && leading, Trailing_ && trailing)
+    : helper::with_default_direction <Direction> (direction),
+        leading_ (std::forward <Leading_> (leading)),
+        trailing_ (std::forward <Trailing_> (trailing)) {}
+
+    /// \return The range that is traversed first.
+    Leading const & leading() const { return leading_; }
+
+    /// \return The range that is traversed after the leading range.
+    Trailing const & trailing() const { return trailing_; }
+
+private:
+    Leading leading_;
+    Trailing trailing_;
+};
+
+namespace concatenate_detail {
+
+    template <class Direction, class Leading, class Trailing> inline
+        concatenate_view <Direction, typename std::decay <Leading>::type,
+            typename std::decay <Trailing>::type>
+        make_view (Direction const & direction,
+            Leading && leading, Trailing && trailing)
+    {
+        return concatenate_view <Direction,
+            typename std::decay <Leading>::type,
+            typename std::decay <Trailing>::type> (direction,
+                std::forward <Leading> (leading),
+                std::forward <Trailing> (trailing));
+    }
+
+    /**
+    Build the nested concatenate_view for a number of views.
+    A single view is returned as it is.
+    */
+    template <class Direction, class ... Views> struct make_nested;
+
+    template <class Direction, class View>
+        struct make_nested <Direction, View>
+    {
+        typedef View type;
+
+        template <class View_> static type make (
+            Direction const &, View_ && view)
+        { return std::forward <View_> (view); }
+    };
+
+    template <class Direction, class Leading, class ... Rest>
+        struct make_nested <Direction, Leading, Rest ...>
+    {
+        typedef make_nested <Direction, Rest ...> rest_type;
+        typedef concatenate_view <Direction, Leading,
+            typename rest_type::type> type;
+
+        template <class Leading_, class ... Rest_> static type make (
+            Direction const & direction, Leading_ && leading,
+            Rest_ && ... rest)
+        {
+            return type (direction, std::forward <Leading_> (leading),
+                rest_type::make (direction, std::forward <Rest_> (rest) ...));
+        }
+    };
+
+    /* first and drop. */
+
+    struct first_leading {
+        template <class View, class Direction>
+            auto operator() (View const & view, Direction const & direction)
+            const
+        RETURNS (range::first (view.leading(), direction));
+    };
+
+    struct first_trailing {
+        template <class View, class Direction>
+            auto operator() (View const & view, Direction const & direction)
+            const
+        RETURNS (range::first (view.trailing(), direction));
+    };
+
+    struct drop_leading {
+        template <class View, class Direction>
+            auto operator() (View const & view, Direction const & direction)
+            const
+        RETURNS (make_view (direction,
+            range::drop (view.leading(), direction), view.trailing()));
+    };
+
+    struct drop_trailing {
+        template <class View, class Direction>
+            auto operator() (View const & view, Direction const & direction)
+            const
+        RETURNS (make_view (direction,
+            view.leading(), range::drop (view.trailing(), direction)));
+    };
+
+    /* equal. */
+
+    /**
+    Compare the elements of \a segment with the first elements of \a other,
+    and drop them from \a other.
+    \return \c true iff \a other has at least as many elements as \a segment
+    and the elements are equal according to \a predicate.
+    */
+    template <class Segment, class Other, class Direction, class Predicate>
+        inline bool equal_prefix (Segment segment, Other & other,
+            Direction const & direction, Predicate && predicate)
+    {
+        while (!range::empty (segment, direction)) {
+            if (range::empty (other, direction)
+                    || !predicate (range::first (segment, direction),
+                        range::first (other, direction)))
+                return false;
+            segment = range::drop (std::move (segment), direction);
+            other = range::drop (std::move (other), direction);
+        }
+        return true;
+    }
+
+    template <class Predicate> struct flip {
+        Predicate && predicate;
+
+        template <class Left, class Right>
+            auto operator() (Left && left, Right && right) const
+        RETURNS (std::forward <Predicate> (predicate) (
+            std::forward <Right> (right), std::forward <Left> (left)));
+    };
+
+    template <class View, class Other, class Direction, class Predicate>
+        inline bool equal_segments (View const & view, Other other,
+            Direction const & direction, Predicate && predicate)
+    {
+        if (!equal_prefix (view.leading(), other, direction, predicate))
+            return false;
+        // If the trailing range is a concatenate_view, this recurses.
+        return range::equal (view.trailing(), std::move (other), direction,
+            predicate);
+    }
+
+    template <class Tag> struct is_concatenate_tag : std::false_type {};
+
+    template <class Direction>
+        struct is_concatenate_tag <
+            concatenate_operation::concatenate_view_tag <Direction>>
+    : std::true_type {};
+
+} // namespace concatenate_detail
+
+namespace concatenate_operation {
+
+    template <class Direction, class View> inline
+        auto implement_empty (concatenate_view_tag <Direction> const &,
+            View const & view, Direction const & direction)
+    RETURNS (rime::and_ (range::empty (view.leading(), direction),
+        range::empty (view.trailing(), direction)));
+
+    template <class Direction, class View> inline
+        auto implement_size (concatenate_view_tag <Direction> const &,
+            View const & view, Direction const & direction)
+    RETURNS (rime::plus (range::size (view.leading(), direction),
+        range::size (view.trailing(), direction)));
+
+    // If the leading range is empty, use the trailing range.
+    // If this is known only at run time, both must return the same type.
+    template <class Direction, class View> inline
+        auto implement_first (concatenate_view_tag <Direction> const &,
+            View const & view, Direction const & direction)
+    RETURNS (rime::call_if (range::empty (view.leading(), direction),
+        concatenate_detail::first_trailing(),
+        concatenate_detail::first_leading(), view, direction));
+
+    template <class Direction, class View> inline
+        auto implement_drop_one (concatenate_view_tag <Direction> const &,
+            View const & view, Direction const & direction)
+    RETURNS (rime::call_if (range::empty (view.leading(), direction),
+        concatenate_detail::drop_trailing(),
+        concatenate_detail::drop_leading(), view, direction));
+
+    /*
+    Drop a run-time number of elements, if the leading range has a size and
+    dropping from either range does not change its type.
+    */
+    template <class Direction, class View, class Increment,
+        class Enable1 = typename std::enable_if <
+            !rime::is_constant <Increment>::value>::type,
+        class Leading = typename std::decay <View>::type::leading_type,
+        class Trailing = typename std::decay <View>::type::trailing_type,
+        class Enable2 = decltype (range::size (
+            std::declval <Leading const &>(), std::declval <Direction>())),
+        class Enable3 = typename std::enable_if <
+            std::is_same <typename std::decay <decltype (range::drop (
+                std::declval <Leading const &>(), std::size_t(),
+                std::declval <Direction>()))>::type, Leading>::value
+            && std::is_same <typename std::decay <decltype (range::drop (
+                std::declval <Trailing const &>(), std::size_t(),
+                std::declval <Direction>()))>::type, Trailing>::value
+            >::type>
+    inline typename std::decay <View>::type implement_drop (
+        concatenate_view_tag <Direction> const &, View const & view,
+        Increment const & increment, Direction const & direction)
+    {
+        std::size_t remaining = increment;
+        std::size_t leading_size = range::size (view.leading(), direction);
+        if (remaining <= leading_size)
+            return concatenate_detail::make_view (direction,
+                range::drop (view.leading(), remaining, direction),
+                view.trailing());
+        else
+            return concatenate_detail::make_view (direction,
+                range::drop (view.leading(), leading_size, direction),
+                range::drop (view.trailing(), remaining - leading_size,
+                    direction));
+    }
+
+    /*
+    Algorithms that work segment by segment.
+    The algorithms are called on the leading and trailing ranges separately,
+    so that they run a tight loop over each, without checking which of the
+    ranges an element is in.
+    */
+
+    template <class Direction, class State, class View, class Function>
+        inline auto implement_fold (concatenate_view_tag <Direction> const &,
+            State && state, View && view, Direction const & direction,
+            Function && function)
+    RETURNS (range::fold (
+        range::fold (std::forward <State> (state), view.leading(), direction,
+            function),
+        view.trailing(), direction, function));
+
+    template <class Direction, class View, class Function>
+        inline void implement_for_each (concatenate_view_tag <Direction> const &,
+            View && view, Direction const & direction, Function && function)
+    {
+        range::for_each (view.leading(), direction, function);
+        range::for_each (view.trailing(), direction, function);
+    }
+
+    /*
+    find on homogeneous concatenations: find in the leading range first, and
+    then in the trailing range.
+    */
+    template <class Direction, class View,
+        class Predicate, class NonEmptyActor, class EmptyActor,
+        class Enable = typename std::enable_if <
+            is_homogeneous <View, Direction>::value>::type,
+        class Result = typename rime::make_variant_over <meta::vector <
+            typename result_of <NonEmptyActor (
+                typename std::decay <View>::type)>::type,
+            typename result_of <EmptyActor (
+                typename std::decay <View>::type)>::type>>::type>
+    inline Result implement_find (concatenate_view_tag <Direction> const &,
+        View && view, Direction const & direction, Predicate && predicate,
+        NonEmptyActor && non_empty_actor, EmptyActor && empty_actor)
+    {
+        auto leading = range::find (view.leading(), direction, predicate);
+        if (!range::empty (leading, direction))
+            return non_empty_actor (concatenate_detail::make_view (
+                direction, std::move (leading), view.trailing()));
+        // If the trailing range is a concatenate_view, this recurses.
+        auto trailing = range::find (view.trailing(), direction, predicate);
+        if (!range::empty (trailing, direction))
+            return non_empty_actor (concatenate_detail::make_view (
+                direction, std::move (leading), std::move (trailing)));
+        return empty_actor (concatenate_detail::make_view (
+            direction, std::move (leading), std::move (trailing)));
+    }
+
+    /*
+    equal on homogeneous ranges: compare the leading range with the start of
+    the other range, and then the trailing range with the rest.
+    */
+    template <class Direction, class Tag2, class View1, class Range2,
+        class Predicate, class Enable = typename std::enable_if <
+            is_homogeneous <View1, Direction>::value
+            && is_homogeneous <Range2, Direction>::value>::type>
+    inline bool implement_equal (concatenate_view_tag <Direction> const &,
+        Tag2 const &, View1 && view1, Range2 && range2,
+        Direction const & direction, Predicate && predicate)
+    {
+        return concatenate_detail::equal_segments (view1,
+            std::forward <Range2> (range2), direction, predicate);
+    }
+
+    template <class Tag1, class Direction, class Range1, class View2,
+        class Predicate, class Enable1 = typename std::enable_if <
+            !concatenate_detail::is_concatenate_tag <Tag1>::value>::type,
+        class Enable2 = typename std::enable_if <
+            is_homogeneous <Range1, Direction>::value
+            && is_homogeneous <View2, Direction>::value>::type>
+    inline bool implement_equal (Tag1 const &,
+        concatenate_view_tag <Direction> const &,
+        Range1 && range1, View2 && view2,
+        Direction const & direction, Predicate && predicate)
+    {
+        return concatenate_detail::equal_segments (view2,
+            std::forward <Range1> (range1), direction,
+            concatenate_detail::flip <Predicate &> {predicate});
+    }
+
+} // namespace concatenate_operation
+
+namespace callable {
+
+    class concatenate {
+    public:
+        template <class FirstRange, class ... RestRanges,
+            class Enable = typename std::enable_if <meta::all_of_c <
+                is_range <FirstRange>::value,
+                is_range <RestRanges>::value ...>::value>::type,
+            class DefaultDirection = typename decayed_result_of <
+                default_direction (FirstRange)>::type,
+            class Make = concatenate_detail::make_nested <DefaultDirection,
+                typename decayed_result_of <
+                    view (FirstRange, DefaultDirection)>::type,
+                typename decayed_result_of <
+                    view (RestRanges, DefaultDirection)>::type ...>,
+            class Result = typename Make::type>
+        Result operator() (
+            FirstRange && first_range, RestRanges && ... rest_ranges) const
+        {
+            auto direction = range::default_direction (first_range);
+            return Make::make (direction,
+                range::view (std::forward <FirstRange> (first_range),
+                    direction),
+                range::view (std::forward <RestRanges> (rest_ranges),
+                    direction) ...);
+        }
+    };
+
+} // namespace callable
+
+/** \brief
+View a number of ranges one after the other.
+
+The first elements of the result are the elements of the first range; then
+follow the elements of the second range; et cetera.
+The ranges are traversed in the default direction of the first range, and the
+result can only be traversed in that direction.
+
+\code
+std::vector <int> v1 {1, 2};
+std::vector <int> v2 {3};
+auto c = concatenate (v1, v2);
+// c contains 1, 2, 3.
+\endcode
+
+The ranges can be homogeneous or heterogeneous.
+If it is known at compile time whether a range is empty (for example, for a
+std::tuple), then the element types and range types can change as the
+result is traversed.
+If this is known only at run time, then the elements of the ranges must have
+the same type, and dropping elements from a range must not change its type.
+Then the result is also homogeneous.
+
+The result has a size if all ranges do.
+Dropping a run-time number of elements at once is possible if the ranges are
+homogeneous and all but the last have a size.
+
+fold(), for_each(), find() and equal() run over one range at a time, so
+that they use a tight loop for each range instead of checking which range an
+element is in on every element.
+This includes algorithms that are implemented with these, like hash_range.
+
+\param ranges
+    (variadic)
+    The ranges to concatenate.
+    At least one range must be given.
+*/
+static const auto concatenate = callable::concatenate();
+
+} // namespace range
+
+#endif // RANGE_CONCATENATE_HPP_INCLUDED
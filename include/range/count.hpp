@@ -17,10 +17,19 @@ limitations under the License.
 #ifndef RANGE_COUNT_HPP_INCLUDED
 #define RANGE_COUNT_HPP_INCLUDED
 
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "meta/vector.hpp"
+
+#include "utility/assignable.hpp"
+
 #include "rime/core.hpp"
 #include "rime/assert.hpp"
 #include "rime/cast.hpp"
 #include "rime/always.hpp"
+#include "rime/variant.hpp"
 
 #include "core.hpp"
 
@@ -28,6 +37,7 @@ namespace range {
 
 template <class Begin, class End> class count_range;
 template <class Begin> class infinite_count_range;
+template <class Value, class Step> class stepped_count_range;
 
 /* Functions. */
 // These are used mutually recursively by the classes so they must be defined
@@ -57,6 +67,14 @@ It starts with \a begin, and finishes one before \a end.
 If they are run-time values, like \c int, then the resulting range is
 homogeneous.
 If not, then the range is heterogeneous.
+
+If \a begin and \a end have the same run-time type, then fold(), for_each()
+and find() run a plain loop over the integers instead of calling drop() for
+each element.
+This is also the case through \ref transform, so that
+<c>for_each (transform (count (n), f), g)</c> is as fast as a \c for loop.
+fold() with <c>std::plus <Integer></c> and equal() between two such ranges take
+constant time.
 \param begin First value in the range.
 \param end One-past-last value in the range.
 \pre <c>begin \<= end</c>.
@@ -91,6 +109,32 @@ template <class End> inline
 }
 /// \endcond
 
+/** \brief
+Return a range that contains an arithmetic progression with a step.
+
+It starts with \a begin, the next element is <c>begin + step</c>, etc., and
+it contains all such values that are less than \a end.
+For example, <c>count (1, 10, 3)</c> contains 1, 4, 7.
+
+\a begin and \a end must be run-time values of the same type, and the range is
+homogeneous.
+\a step can be a run-time value of that type, or a compile-time constant, which
+allows the compiler to optimise the multiplications.
+size(), drop() with any increment, and first() and drop() from the back take
+constant time, so the range can be reversed cheaply.
+
+\param begin First value in the range.
+\param end Value that all values in the range are less than.
+\param step Difference between consecutive values.
+\pre <c>begin \<= end</c>.
+\pre <c>step > 0</c>.
+*/
+template <class Value, class Step, class Enable = typename
+    std::enable_if <!rime::is_constant <Value>::value>::type>
+inline stepped_count_range <Value, Step>
+    count (Value const & begin, Value const & end, Step const & step)
+{ return stepped_count_range <Value, Step> (begin, end, step); }
+
 /* Implementation of ranges. */
 
 template <class Begin, class End> class count_range {
@@ -162,6 +206,74 @@ private:
         rime::cast_value <Begin> (rime::plus (begin_, increment))));
 };
 
+template <class Value, class Step> class stepped_count_range {
+    Value begin_;
+    Value size_;
+    Step step_;
+
+    struct from_size {};
+
+    stepped_count_range (from_size, Value const & begin, Value const & size,
+        Step const & step)
+    : begin_ (begin), size_ (size), step_ (step) {}
+
+    // If Step is a constant, this is a compile-time constant too.
+    Value step_value() const { return Value (step_); }
+
+public:
+    stepped_count_range (Value const & begin, Value const & end,
+        Step const & step)
+    : begin_ (begin), size_ (), step_ (step)
+    {
+        rime::assert_ (!(end < begin));
+        rime::assert_ (Value() < step_value());
+        Value distance = Value (end - begin);
+        size_ = Value (distance / step_value()
+            + (distance % step_value() == Value() ? 0 : 1));
+    }
+
+    Value begin() const { return begin_; }
+    Step step() const { return step_; }
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const { return size_ == Value(); }
+    bool empty (direction::back) const { return size_ == Value(); }
+
+    Value size (direction::front) const { return size_; }
+    Value size (direction::back) const { return size_; }
+
+    Value first (direction::front) const {
+        rime::assert_ (!empty (front));
+        return begin_;
+    }
+
+    Value first (direction::back) const {
+        rime::assert_ (!empty (back));
+        return Value (begin_ + Value (size_ - 1) * step_value());
+    }
+
+    template <class Increment> stepped_count_range drop (
+        Increment const & increment, direction::front) const
+    {
+        Value increment_value = Value (increment);
+        rime::assert_ (!(size_ < increment_value));
+        return stepped_count_range (from_size(),
+            Value (begin_ + increment_value * step_value()),
+            Value (size_ - increment_value), step_);
+    }
+
+    template <class Increment> stepped_count_range drop (
+        Increment const & increment, direction::back) const
+    {
+        Value increment_value = Value (increment);
+        rime::assert_ (!(size_ < increment_value));
+        return stepped_count_range (from_size(),
+            begin_, Value (size_ - increment_value), step_);
+    }
+};
+
 namespace count_operation {
     struct count_range_tag {};
 } // namespace count_operation
@@ -173,6 +285,229 @@ template <class Begin, class End>
 template <class Begin> struct tag_of_qualified <infinite_count_range <Begin>>
 { typedef count_operation::count_range_tag type; };
 
+template <class Value, class Step>
+    struct tag_of_qualified <stepped_count_range <Value, Step>>
+{ typedef count_operation::count_range_tag type; };
+
+namespace equal_detail {
+    // Defined in equal.hpp.
+    struct element_equal;
+} // namespace equal_detail
+
+namespace count_detail {
+
+    /**
+    Evaluate to \c true iff \a Value is a run-time value.
+    Count ranges whose begin and end are both of type \a Value are then
+    homogeneous, and algorithms can run a plain loop over them.
+    */
+    template <class Value> struct is_run_time
+    : std::integral_constant <bool, !rime::is_constant <Value>::value> {};
+
+    /**
+    Evaluate to \c true iff a fold over a range of \a Value with \a Function
+    computes the sum, with integer arithmetic, so that it can be computed in
+    closed form.
+    */
+    template <class State, class Value, class Function,
+        class Decayed = typename std::decay <Function>::type>
+    struct is_integer_sum : std::false_type {};
+
+    template <class State, class Value, class Function, class Type>
+        struct is_integer_sum <State, Value, Function, std::plus <Type>>
+    : std::integral_constant <bool,
+        std::is_same <State, Type>::value
+        && std::is_integral <Type>::value && std::is_integral <Value>::value
+        && !std::is_same <Type, bool>::value
+        && !std::is_same <Value, bool>::value> {};
+
+    /**
+    Evaluate to \c true iff a fold with \a Function over a range of \a Value
+    keeps the state type \a State, so that it can run a plain loop.
+    */
+    template <class State, class Value, class Function, class Enable = void>
+        struct is_stable_fold
+    : std::false_type {};
+
+    template <class State, class Value, class Function>
+        struct is_stable_fold <State, Value, Function, typename
+            std::enable_if <std::is_same <State, typename result_of <
+                Function (State, Value)>::type>::value>::type>
+    : std::integral_constant <bool, !std::is_reference <State>::value
+        && !is_integer_sum <State, Value, Function>::value> {};
+
+    /**
+    \return The sum of \a state and the integers in [begin, end), computed in
+    the unsigned type corresponding to \a Type, so that overflow wraps around
+    as it would if the elements were added one by one.
+    The type is at least unsigned int, since smaller unsigned types would be
+    promoted to int, and then the products could overflow.
+    */
+    template <class Type, class Value>
+        inline Type integer_sum (Type state, Value begin, Value end)
+    {
+        typedef typename std::make_unsigned <typename std::common_type <
+            Type, Value, unsigned>::type>::type unsigned_type;
+        unsigned_type number = unsigned_type (end) - unsigned_type (begin);
+        // number * (number - 1) / 2, without overflowing before dividing.
+        unsigned_type triangle = (number % 2 == 0)
+            ? (number / 2) * (number - 1)
+            : number * ((number - 1) / 2);
+        return Type (unsigned_type (state)
+            + number * unsigned_type (Type (begin)) + triangle);
+    }
+
+} // namespace count_detail
+
+/*
+Algorithms on homogeneous count ranges.
+The generic implementations call drop() for each element; these run a plain
+loop over the integers, which the compiler can unroll and vectorise.
+Some are computed in constant time.
+*/
+namespace count_operation {
+
+    /* fold. */
+
+    template <class State, class Value, class Function, class Enable =
+        typename std::enable_if <count_detail::is_run_time <Value>::value
+            && count_detail::is_stable_fold <State, Value, Function>::value
+        >::type>
+    inline State implement_fold (count_range_tag const &, State && state_,
+        count_range <Value, Value> const & range, direction::front const &,
+        Function && function)
+    {
+        utility::assignable <State> state (std::forward <State> (state_));
+        Value const end = range.end();
+        for (Value current = range.begin(); current != end; ++ current)
+            state = function (state.move_content(), Value (current));
+        return state.move_content();
+    }
+
+    template <class State, class Value, class Function, class Enable =
+        typename std::enable_if <count_detail::is_run_time <Value>::value
+            && count_detail::is_stable_fold <State, Value, Function>::value
+        >::type>
+    inline State implement_fold (count_range_tag const &, State && state_,
+        count_range <Value, Value> const & range, direction::back const &,
+        Function && function)
+    {
+        utility::assignable <State> state (std::forward <State> (state_));
+        Value const begin = range.begin();
+        for (Value current = range.end(); current != begin;) {
+            -- current;
+            state = function (state.move_content(), Value (current));
+        }
+        return state.move_content();
+    }
+
+    // The sum of integers is computed in closed form, in either direction.
+    template <class State, class Value, class Function, class Direction,
+        class Enable = typename std::enable_if <
+            count_detail::is_run_time <Value>::value
+            && count_detail::is_integer_sum <State, Value, Function>::value
+        >::type>
+    inline State implement_fold (count_range_tag const &, State && state,
+        count_range <Value, Value> const & range, Direction const &,
+        Function &&)
+    { return count_detail::integer_sum (state, range.begin(), range.end()); }
+
+    /* for_each. */
+
+    template <class Value, class Function, class Enable = typename
+        std::enable_if <count_detail::is_run_time <Value>::value>::type>
+    inline void implement_for_each (count_range_tag const &,
+        count_range <Value, Value> const & range, direction::front const &,
+        Function && function)
+    {
+        Value const end = range.end();
+        for (Value current = range.begin(); current != end; ++ current)
+            function (Value (current));
+    }
+
+    template <class Value, class Function, class Enable = typename
+        std::enable_if <count_detail::is_run_time <Value>::value>::type>
+    inline void implement_for_each (count_range_tag const &,
+        count_range <Value, Value> const & range, direction::back const &,
+        Function && function)
+    {
+        Value const begin = range.begin();
+        for (Value current = range.end(); current != begin;) {
+            -- current;
+            function (Value (current));
+        }
+    }
+
+    /* find. */
+
+    template <class Value, class Predicate,
+        class NonEmptyActor, class EmptyActor,
+        class Enable = typename
+            std::enable_if <count_detail::is_run_time <Value>::value>::type,
+        class Result = typename rime::make_variant_over <meta::vector <
+            typename result_of <NonEmptyActor (count_range <Value, Value>)
+                >::type,
+            typename result_of <EmptyActor (count_range <Value, Value>)>::type
+            >>::type>
+    inline Result implement_find (count_range_tag const &,
+        count_range <Value, Value> const & range, direction::front const &,
+        Predicate && predicate, NonEmptyActor && non_empty_actor,
+        EmptyActor && empty_actor)
+    {
+        Value const end = range.end();
+        for (Value current = range.begin(); current != end; ++ current) {
+            if (predicate (Value (current)))
+                return non_empty_actor (range::count (current, end));
+        }
+        return empty_actor (range::count (end, end));
+    }
+
+    template <class Value, class Predicate,
+        class NonEmptyActor, class EmptyActor,
+        class Enable = typename
+            std::enable_if <count_detail::is_run_time <Value>::value>::type,
+        class Result = typename rime::make_variant_over <meta::vector <
+            typename result_of <NonEmptyActor (count_range <Value, Value>)
+                >::type,
+            typename result_of <EmptyActor (count_range <Value, Value>)>::type
+            >>::type>
+    inline Result implement_find (count_range_tag const &,
+        count_range <Value, Value> const & range, direction::back const &,
+        Predicate && predicate, NonEmptyActor && non_empty_actor,
+        EmptyActor && empty_actor)
+    {
+        Value const begin = range.begin();
+        for (Value end = range.end(); end != begin; -- end) {
+            if (predicate (Value (end - 1)))
+                return non_empty_actor (range::count (begin, end));
+        }
+        return empty_actor (range::count (begin, begin));
+    }
+
+    /* equal. */
+
+    /**
+    Two count ranges with the same value type are equal iff they have the same
+    size, and, unless they are empty, the same first element.
+    This is only used when the elements are compared with operator==.
+    */
+    template <class Value, class Direction, class Predicate, class Enable =
+        typename std::enable_if <count_detail::is_run_time <Value>::value
+            && std::is_same <typename std::decay <Predicate>::type,
+                equal_detail::element_equal>::value>::type>
+    inline bool implement_equal (count_range_tag const &,
+        count_range_tag const &, count_range <Value, Value> const & range1,
+        count_range <Value, Value> const & range2, Direction const &,
+        Predicate &&)
+    {
+        if (range1.end() - range1.begin() != range2.end() - range2.begin())
+            return false;
+        return range1.begin() == range1.end()
+            || range1.begin() == range2.begin();
+    }
+
+} // namespace count_operation
+
 // count() function: needs to be defined after the classes, because
 // infinite_count_range needs to be instantiated.
 
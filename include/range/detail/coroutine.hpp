@@ -0,0 +1,150 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Detect support for C++20 coroutines, and define an allocator for coroutine
+frames.
+
+RANGE_HAS_COROUTINES is defined as 1 if coroutines are supported, and as 0
+otherwise.
+*/
+
+#ifndef RANGE_DETAIL_COROUTINE_HPP_INCLUDED
+#define RANGE_DETAIL_COROUTINE_HPP_INCLUDED
+
+#if defined (__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L \
+    && defined (__has_include)
+#   if __has_include (<coroutine>)
+#       define RANGE_HAS_COROUTINES 1
+#   endif
+#endif
+
+#ifndef RANGE_HAS_COROUTINES
+#   define RANGE_HAS_COROUTINES 0
+#endif
+
+#if RANGE_HAS_COROUTINES
+
+#include <cstddef>
+#include <new>
+
+namespace range {
+
+namespace coroutine_detail {
+
+    /**
+    Allocator for coroutine frames that keeps freed frames for reuse.
+
+    Sizes are rounded up to a multiple of \c granularity bytes.
+    For each size, each thread keeps a list of at most \c max_cached free
+    frames.
+    A coroutine that is started after another one with the same function has
+    finished therefore reuses its frame without calling operator new.
+    Frames can be freed on a different thread than they were allocated on.
+    Frames larger than the largest size are not cached.
+    */
+    class frame_allocator {
+        static constexpr std::size_t granularity = 64;
+        static constexpr std::size_t size_class_num = 32;
+        static constexpr std::size_t max_cached = 16;
+
+        struct free_frame {
+            free_frame * next;
+        };
+
+        struct cache {
+            free_frame * lists [size_class_num] = {};
+            std::size_t counts [size_class_num] = {};
+
+            ~cache() {
+                for (free_frame * list : lists) {
+                    while (list) {
+                        free_frame * next = list->next;
+                        ::operator delete (list);
+                        list = next;
+                    }
+                }
+                destructed() = true;
+            }
+        };
+
+        /**
+        Whether the cache for this thread has been destructed.
+        Frames can be freed after that, while other thread-local objects are
+        destructed.
+        This has a trivial destructor, so that it remains usable.
+        */
+        static bool & destructed() {
+            static thread_local bool value = false;
+            return value;
+        }
+
+        static cache & thread_cache() {
+            static thread_local cache value;
+            return value;
+        }
+
+        static std::size_t size_class (std::size_t size) {
+            return size == 0 ? 1 : (size + granularity - 1) / granularity;
+        }
+
+    public:
+        static void * allocate (std::size_t size) {
+            std::size_t const size_class = frame_allocator::size_class (size);
+            if (size_class > size_class_num)
+                return ::operator new (size);
+
+            if (!destructed()) {
+                cache & current = thread_cache();
+                free_frame * & list = current.lists [size_class - 1];
+                if (list) {
+                    free_frame * frame = list;
+                    list = frame->next;
+                    -- current.counts [size_class - 1];
+                    return frame;
+                }
+            }
+            // Allocate the whole size class even if this thread's cache is
+            // gone, since the frame may be freed into another thread's cache.
+            return ::operator new (size_class * granularity);
+        }
+
+        static void deallocate (void * frame, std::size_t size) noexcept {
+            std::size_t const size_class = frame_allocator::size_class (size);
+            if (size_class > size_class_num || destructed()) {
+                ::operator delete (frame);
+                return;
+            }
+
+            cache & current = thread_cache();
+            if (current.counts [size_class - 1] == max_cached) {
+                ::operator delete (frame);
+                return;
+            }
+            free_frame * free = new (frame) free_frame;
+            free->next = current.lists [size_class - 1];
+            current.lists [size_class - 1] = free;
+            ++ current.counts [size_class - 1];
+        }
+    };
+
+} // namespace coroutine_detail
+
+} // namespace range
+
+#endif // RANGE_HAS_COROUTINES
+
+#endif // RANGE_DETAIL_COROUTINE_HPP_INCLUDED
@@ -0,0 +1,316 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define the hash tables that hash_aggregate and hash_join use.
+*/
+
+#ifndef RANGE_DETAIL_HASH_TABLE_HPP_INCLUDED
+#define RANGE_DETAIL_HASH_TABLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "../core.hpp"
+#include "../hash_range.hpp"
+#include "../tuple.hpp"
+
+namespace range { namespace hash_table_detail {
+
+    /**
+    The type in which a key is stored.
+    Keys are often tuples of references into elements; the table stores the
+    values.
+    */
+    template <class Key> struct key_value
+    { typedef typename std::decay <Key>::type type; };
+
+    template <class ... Types> struct key_value <tuple <Types ...>>
+    { typedef tuple <typename std::decay <Types>::type ...> type; };
+
+    template <class Key> struct key_value <Key &> : key_value <Key> {};
+    template <class Key> struct key_value <Key &&> : key_value <Key> {};
+    template <class Key> struct key_value <Key const> : key_value <Key> {};
+
+    /// Hash a key; tuples are hashed with hash_range.
+    template <class Key> inline
+        typename std::enable_if <is_tuple <Key>::value, std::size_t>::type
+        hash_key (Key const & key)
+    { return range::hash_range (key); }
+
+    template <class Key> inline
+        typename std::enable_if <!is_tuple <Key>::value, std::size_t>::type
+        hash_key (Key const & key)
+    { return boost::hash <Key>() (key); }
+
+    /**
+    Scramble the bits of a hash value.
+    boost::hash is the identity for integers, so without this, keys that are
+    multiples of a power of two would end up in a few places.
+    */
+    inline std::uint64_t mix (std::size_t hash, std::uint64_t multiplier
+        = 0x9e3779b97f4a7c15ull)
+    { return std::uint64_t (hash) * multiplier; }
+
+    /**
+    Index of an open-addressing hash table with linear probing.
+
+    This maps hash values to positions in an array of entries that is kept
+    elsewhere, so that entries are stored densely and never move when the
+    index grows.
+    Each slot holds the full hash value, so that most mismatches are detected
+    without looking at the entry, and the index can grow without hashing the
+    keys again.
+    The index is kept at most half full.
+    */
+    class index {
+    public:
+        static constexpr std::size_t no_entry
+            = std::numeric_limits <std::size_t>::max();
+
+    private:
+        struct slot {
+            std::size_t hash;
+            std::size_t entry;
+        };
+
+        std::vector <slot> slots_;
+        /// 64 - log2 (the number of slots).
+        unsigned shift_;
+        std::size_t size_;
+
+        std::size_t home (std::size_t hash) const
+        { return std::size_t (mix (hash) >> shift_); }
+
+        std::size_t mask() const { return slots_.size() - 1; }
+
+        void grow() {
+            std::vector <slot> old (2 * slots_.size(), slot {0, no_entry});
+            old.swap (slots_);
+            -- shift_;
+            for (slot const & current : old) {
+                if (current.entry != no_entry) {
+                    std::size_t position = home (current.hash);
+                    while (slots_ [position].entry != no_entry)
+                        position = (position + 1) & mask();
+                    slots_ [position] = current;
+                }
+            }
+        }
+
+    public:
+        index() : slots_ (16, slot {0, no_entry}), shift_ (64 - 4), size_ (0)
+        {}
+
+        std::size_t size() const { return size_; }
+
+        /**
+        Find the slot for a key.
+        \param hash The hash value of the key.
+        \param is_key Function that returns whether the entry at a position
+            has the key.
+        \return The position of the slot, which contains the entry for the key
+            or is empty.
+        */
+        template <class IsKey> std::size_t find_slot (
+            std::size_t hash, IsKey const & is_key) const
+        {
+            std::size_t position = home (hash);
+            while (true) {
+                slot const & current = slots_ [position];
+                if (current.entry == no_entry)
+                    return position;
+                if (current.hash == hash && is_key (current.entry))
+                    return position;
+                position = (position + 1) & mask();
+            }
+        }
+
+        /// \return The entry in the slot at \a position, or no_entry.
+        std::size_t entry (std::size_t position) const
+        { return slots_ [position].entry; }
+
+        /**
+        Put \a entry in the empty slot at \a position, which must have been
+        returned by find_slot() with \a hash, without changes in between.
+        */
+        void occupy (std::size_t position, std::size_t hash,
+            std::size_t entry)
+        {
+            slots_ [position] = slot {hash, entry};
+            ++ size_;
+            if (2 * size_ > slots_.size())
+                grow();
+        }
+    };
+
+    /**
+    Hash table that keeps one state per key, for hash_aggregate.
+    The entries are kept in the order in which their keys first appeared.
+    */
+    template <class Key, class State> class aggregate_table {
+    public:
+        typedef tuple <Key, State> entry_type;
+
+    private:
+        index index_;
+        std::vector <entry_type> entries_;
+
+    public:
+        /**
+        Fold \a element into the state for \a key, which starts as
+        \a initial.
+        */
+        template <class KeyArgument, class Function, class Element>
+            void add (KeyArgument const & key, State const & initial,
+                Function const & function, Element && element)
+        {
+            add (hash_key (key), key, initial, function,
+                std::forward <Element> (element));
+        }
+
+        /// Do the same as add(), with \a hash already computed from \a key.
+        template <class KeyArgument, class Function, class Element>
+            void add (std::size_t hash, KeyArgument const & key,
+                State const & initial, Function const & function,
+                Element && element)
+        {
+            std::size_t position = index_.find_slot (hash,
+                [this, &key] (std::size_t entry)
+                { return range::first (entries_ [entry]) == key; });
+            std::size_t entry = index_.entry (position);
+            if (entry == index::no_entry) {
+                entry = entries_.size();
+                entries_.push_back (entry_type (Key (key), initial));
+                index_.occupy (position, hash, entry);
+            }
+            State & state = range::second (entries_ [entry]);
+            state = function (std::move (state),
+                std::forward <Element> (element));
+        }
+
+        std::vector <entry_type> & entries() { return entries_; }
+    };
+
+    /**
+    Hash table that keeps all rows for each key, for hash_join.
+    Rows with the same key are chained in the order in which they were added.
+    */
+    template <class Key, class Row> class join_table {
+        index index_;
+        std::vector <Key> keys_;
+        /// The last row for each key.
+        std::vector <std::size_t> last_;
+        /// The first row for each key.
+        std::vector <std::size_t> first_;
+        std::vector <Row> rows_;
+        /// The next row with the same key.
+        std::vector <std::size_t> next_;
+
+    public:
+        typedef Row row_type;
+
+        static constexpr std::size_t no_row = index::no_entry;
+
+        template <class KeyArgument, class RowArgument>
+            void add (KeyArgument const & key, RowArgument && row)
+        { add (hash_key (key), key, std::forward <RowArgument> (row)); }
+
+        /// Do the same as add(), with \a hash already computed from \a key.
+        template <class KeyArgument, class RowArgument>
+            void add (std::size_t hash, KeyArgument const & key,
+                RowArgument && row)
+        {
+            std::size_t position = index_.find_slot (hash,
+                [this, &key] (std::size_t entry)
+                { return keys_ [entry] == key; });
+            std::size_t entry = index_.entry (position);
+            std::size_t const row_number = rows_.size();
+            // The key may refer into the row, so copy it first.
+            if (entry == index::no_entry) {
+                keys_.push_back (Key (key));
+                first_.push_back (row_number);
+                last_.push_back (row_number);
+                index_.occupy (position, hash, keys_.size() - 1);
+            } else {
+                next_ [last_ [entry]] = row_number;
+                last_ [entry] = row_number;
+            }
+            rows_.push_back (std::forward <RowArgument> (row));
+            next_.push_back (no_row);
+        }
+
+    private:
+        template <class KeyArgument> std::size_t find_converted (
+            KeyArgument const & key, std::true_type) const
+        { return find (hash_key (key), key); }
+
+        // Hash the key as Key, since the hash of another type that compares
+        // equal, like char const * for std::string, may be different.
+        template <class KeyArgument> std::size_t find_converted (
+            KeyArgument const & key, std::false_type) const
+        {
+            Key const converted (key);
+            return find (hash_key (converted), converted);
+        }
+
+    public:
+        /**
+        \return The first row with \a key, or no_row.
+        If \a key is of a different type from the stored keys, it is
+        converted first.
+        */
+        template <class KeyArgument>
+            std::size_t find (KeyArgument const & key) const
+        {
+            return find_converted (key, std::is_same <
+                typename key_value <KeyArgument>::type, Key>());
+        }
+
+        /**
+        Do the same as find(), with \a hash already computed from \a key,
+        which must be of type Key or a tuple of references to its elements.
+        */
+        template <class KeyArgument>
+            std::size_t find (std::size_t hash, KeyArgument const & key) const
+        {
+            std::size_t position = index_.find_slot (hash,
+                [this, &key] (std::size_t entry)
+                { return keys_ [entry] == key; });
+            std::size_t entry = index_.entry (position);
+            if (entry == index::no_entry)
+                return no_row;
+            return first_ [entry];
+        }
+
+        Row const & row (std::size_t number) const { return rows_ [number]; }
+
+        /// \return The next row with the same key as \a number, or no_row.
+        std::size_t next (std::size_t number) const { return next_ [number]; }
+    };
+
+    template <class Key, class Row>
+        constexpr std::size_t join_table <Key, Row>::no_row;
+
+}} // namespace range::hash_table_detail
+
+#endif // RANGE_DETAIL_HASH_TABLE_HPP_INCLUDED
@@ -0,0 +1,152 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define a function that distributes the elements of a range over worker
+threads by partition.
+*/
+
+#ifndef RANGE_DETAIL_PARTITION_HPP_INCLUDED
+#define RANGE_DETAIL_PARTITION_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rime/assert.hpp"
+
+#include "../core.hpp"
+#include "../channel.hpp"
+#include "hash_table.hpp"
+
+namespace range { namespace partition_detail {
+
+    /// The number of elements that are sent to a partition at once.
+    static constexpr std::size_t batch_size = 256;
+
+    /**
+    \return The partition for a hash value.
+    This uses a different multiplier from the hash tables, so that the
+    elements within one partition are still spread over the tables.
+    */
+    inline std::size_t partition_of (std::size_t hash,
+        std::size_t partition_num)
+    {
+        return std::size_t (hash_table_detail::mix (
+            hash, 0xc2b2ae3d27d4eb4full) >> 32) % partition_num;
+    }
+
+    /// An element with its key and the hash value of the key.
+    template <class Key, class Element> struct keyed_element {
+        std::size_t hash;
+        Key key;
+        Element element;
+    };
+
+    /**
+    Traverse \a elements on the calling thread, and call
+    <c>consume (p, hash, key, element)</c> on worker thread \c p for each
+    element.
+    \c key is <c>Key (key_function (element))</c>, \c hash is its hash value,
+    and \c p is the partition for that.
+    Each key is therefore computed and hashed once, on the calling thread, and
+    the worker threads can use them without computing them again.
+    Each worker thread sees all elements of one partition, in order, and
+    nothing else.
+    The elements are passed in batches through a \ref channel per partition,
+    so Key and Element must be default-constructible and move-assignable, and
+    moving them must not throw.
+
+    If any call throws, then after all threads have finished, the first
+    exception is rethrown.
+    */
+    template <class Key, class Element, class View, class KeyFunction,
+        class Consume>
+    inline void for_each_partitioned (View & elements,
+        std::size_t partition_num, KeyFunction const & key_function,
+        Consume const & consume)
+    {
+        typedef keyed_element <Key, Element> item_type;
+
+        rime::assert_ (partition_num != 0);
+        std::vector <std::unique_ptr <channel <item_type>>> channels;
+        for (std::size_t p = 0; p != partition_num; ++ p)
+            channels.emplace_back (new channel <item_type> (4 * batch_size));
+
+        std::vector <std::exception_ptr> exceptions (partition_num);
+        auto work = [&] (std::size_t p) {
+            auto reader = channels [p]->reader (batch_size);
+            while (!range::empty (reader, front)) {
+                item_type item = range::chop_in_place (reader, front);
+                // After an exception, keep draining the channel, so that the
+                // calling thread does not wait forever.
+                if (!exceptions [p]) {
+                    try {
+                        consume (p, item.hash, static_cast <Key const &> (
+                            item.key), std::move (item.element));
+                    } catch (...) {
+                        exceptions [p] = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::vector <std::thread> threads;
+        std::exception_ptr exception;
+        try {
+            for (std::size_t p = 0; p != partition_num; ++ p)
+                threads.emplace_back (work, p);
+
+            std::vector <std::vector <item_type>> batches (partition_num);
+            while (!range::empty (elements, front)) {
+                Element element = range::chop_in_place (elements, front);
+                // The key may refer into the element, so copy it first.
+                Key key (key_function (element));
+                std::size_t hash = hash_table_detail::hash_key (key);
+                std::size_t p = partition_of (hash, partition_num);
+                std::vector <item_type> & batch = batches [p];
+                batch.push_back (item_type {
+                    hash, std::move (key), std::move (element)});
+                if (batch.size() == batch_size) {
+                    channels [p]->push_n (batch.data(), batch.size());
+                    batch.clear();
+                }
+            }
+            for (std::size_t p = 0; p != partition_num; ++ p)
+                channels [p]->push_n (batches [p].data(), batches [p].size());
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        for (auto & partition : channels)
+            partition->close();
+        for (std::thread & thread : threads)
+            thread.join();
+
+        if (exception)
+            std::rethrow_exception (exception);
+        for (std::exception_ptr const & exception : exceptions)
+            if (exception)
+                std::rethrow_exception (exception);
+    }
+
+}} // namespace range::partition_detail
+
+#endif // RANGE_DETAIL_PARTITION_HPP_INCLUDED
@@ -28,6 +28,7 @@ Define optimised versions of "equal" and "less_lexicographical" for tuples.
 #include <boost/mpl/bool.hpp>
 
 #include "meta/vector.hpp"
+#include "meta/count.hpp"
 #include "meta/all_of_c.hpp"
 #include "meta/any_of_c.hpp"
 
@@ -66,6 +67,15 @@ namespace range { namespace tuple_detail {
             >::type type;
     };
 
+    /**
+    Return the element at \a Index in a tuple_view, counting from the front.
+    This does not instantiate any intermediate views.
+    */
+    template <std::size_t Index, class TupleView>
+        inline auto view_element (TupleView const & view)
+    RETURNS (extract <(TupleView::tuple_size - TupleView::begin_position - 1
+        - Index)>() (view.tuple()));
+
     /* equal specialised for tuple. */
 
     // Different sizes: never equal.
@@ -200,6 +210,39 @@ namespace range { namespace tuple_detail {
             }
         };
 
+        /*
+        Most common scenario: all comparisons return bool.
+        Instead of recursing, expand the indices into an initialiser list.
+        This instantiates no intermediate views, and the number of template
+        instantiations does not grow with the square of the size.
+        The initialiser list is evaluated in order, and "&&" makes sure the
+        predicate is not called after the first mismatch.
+        */
+        template <std::size_t Size> struct equal_run_time {
+        private:
+            template <class Left, class Right, class Predicate,
+                class ... Indices>
+            static bool apply (Left const & left, Right const & right,
+                Predicate && predicate, meta::vector <Indices ...>)
+            {
+                bool result = true;
+                int dummy [] = { (result = result && predicate (
+                    view_element <Indices::value> (left),
+                    view_element <Indices::value> (right)), 0) ...};
+                (void) dummy;
+                return result;
+            }
+
+        public:
+            template <class Left, class Right, class Predicate>
+                bool operator() (Left const & left, Right const & right,
+                    Predicate && predicate) const
+            {
+                return apply (left, right, predicate,
+                    typename meta::count <Size>::type());
+            }
+        };
+
         // equal.
         template <class LeftTypes, class RightTypes, class Predicate,
                 class Enable = void>
@@ -210,10 +253,17 @@ namespace range { namespace tuple_detail {
                 meta::vector <LeftTypes ...>, meta::vector <RightTypes ...>,
                 Predicate, typename std::enable_if <
                     sizeof... (LeftTypes) == sizeof... (RightTypes)>::type>
-        : equal_implementation_forwarder <
-            meta::vector <decltype (std::declval <Predicate>() (
-                std::declval <LeftTypes>(), std::declval <RightTypes>())) ...>>
-        {};
+        : std::conditional <
+            (sizeof... (LeftTypes) != 0) && meta::all_of_c <
+                std::is_same <decltype (std::declval <Predicate>() (
+                    std::declval <LeftTypes>(), std::declval <RightTypes>())),
+                    bool>::value ...>::value,
+            equal_run_time <sizeof... (LeftTypes)>,
+            equal_implementation_forwarder <
+                meta::vector <decltype (std::declval <Predicate>() (
+                    std::declval <LeftTypes>(), std::declval <RightTypes>()))
+                    ...>>
+        >::type {};
 
     } // namespace equal_detail
 
@@ -556,20 +606,84 @@ namespace range { namespace tuple_detail {
             }
         };
 
+        /*
+        Most common scenario: tuples of the same size, and all comparisons
+        return bool.
+        Expand the indices into an initialiser list, like for "equal".
+        Once one of the comparisons has decided the outcome, the predicate is
+        not called any more.
+        */
+        template <std::size_t Size> struct less_lexicographical_run_time {
+        private:
+            enum outcome { undecided, less, greater };
+
+            template <class Left, class Right, class Predicate,
+                class ... Indices>
+            static bool apply (Left const & left, Right const & right,
+                Predicate && predicate, meta::vector <Indices ...>)
+            {
+                outcome result = undecided;
+                int dummy [] = { (result = (result != undecided ? result
+                    : predicate (view_element <Indices::value> (left),
+                        view_element <Indices::value> (right)) ? less
+                    : predicate (view_element <Indices::value> (right),
+                        view_element <Indices::value> (left)) ? greater
+                    : undecided), 0) ...};
+                (void) dummy;
+                return result == less;
+            }
+
+        public:
+            template <class Left, class Right, class Predicate>
+                bool operator() (Left const & left, Right const & right,
+                    Predicate && predicate) const
+            {
+                return apply (left, right, predicate,
+                    typename meta::count <Size>::type());
+            }
+        };
+
+        template <class LeftTypes, class RightTypes, class Predicate>
+            struct is_run_time_comparison;
+
+        template <class ... LeftTypes, class ... RightTypes, class Predicate>
+            struct is_run_time_comparison <meta::vector <LeftTypes ...>,
+                meta::vector <RightTypes ...>, Predicate>
+        : meta::all_of_c <
+            std::is_same <decltype (std::declval <Predicate>() (
+                std::declval <LeftTypes>(), std::declval <RightTypes>())),
+                bool>::value ...,
+            std::is_same <decltype (std::declval <Predicate>() (
+                std::declval <RightTypes>(), std::declval <LeftTypes>())),
+                bool>::value ...> {};
+
+        /// Recursive implementation, which handles all cases.
+        template <class LeftTypes, class RightTypes, class Predicate>
+            struct less_lexicographical_recursive
+        : less_lexicographical_implementation_forwarder <
+            typename less_lexicographical_detail::predicate_results <
+                LeftTypes, RightTypes, Predicate>::type>
+        {};
+
         // less_lexicographical.
         template <class LeftTypes, class RightTypes, class Predicate,
                 class Enable = void>
-            struct less_lexicographical;
+            struct less_lexicographical
+        : less_lexicographical_recursive <LeftTypes, RightTypes, Predicate> {};
 
         template <class ... LeftTypes, class ... RightTypes, class Predicate>
             struct less_lexicographical <
                 meta::vector <LeftTypes ...>, meta::vector <RightTypes ...>,
-                Predicate>
-        : less_lexicographical_implementation_forwarder <
-            typename less_lexicographical_detail::predicate_results <
-                meta::vector <LeftTypes ...>, meta::vector <RightTypes ...>,
-                Predicate>::type>
-        {};
+                Predicate, typename std::enable_if <
+                    (sizeof... (LeftTypes) == sizeof... (RightTypes))
+                    && (sizeof... (LeftTypes) != 0)>::type>
+        : std::conditional <
+            is_run_time_comparison <meta::vector <LeftTypes ...>,
+                meta::vector <RightTypes ...>, Predicate>::value,
+            less_lexicographical_run_time <sizeof... (LeftTypes)>,
+            less_lexicographical_recursive <meta::vector <LeftTypes ...>,
+                meta::vector <RightTypes ...>, Predicate>
+        >::type {};
 
     } // namespace less_lexicographical_detail
 
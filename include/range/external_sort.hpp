@@ -0,0 +1,341 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define external_sort, which sorts ranges that do not fit in memory, using
+temporary files.
+*/
+
+#ifndef RANGE_EXTERNAL_SORT_HPP_INCLUDED
+#define RANGE_EXTERNAL_SORT_HPP_INCLUDED
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/info.hpp>
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "buffer.hpp"
+#include "binary_file.hpp"
+#include "merge.hpp"
+#include "parallel_sort.hpp"
+#include "sort.hpp"
+#include "view_shared.hpp"
+#include "std/container.hpp"
+
+namespace range {
+
+/** \brief
+Settings for external_sort().
+
+The setters return the object, so that they can be chained:
+\code
+external_sort_options().memory_budget (std::size_t (1) << 30).thread_num (4)
+\endcode
+*/
+class external_sort_options {
+    std::size_t memory_budget_;
+    std::size_t thread_num_;
+
+public:
+    /// Initialise with a memory budget of 256 MiB and one thread.
+    external_sort_options()
+    : memory_budget_ (std::size_t (256) << 20), thread_num_ (1) {}
+
+    /**
+    Set the number of bytes that records may take up in memory.
+    Half of this is used for the run that is being sorted, and half for the
+    run that is being written to a temporary file at the same time.
+    */
+    external_sort_options & memory_budget (std::size_t bytes) {
+        memory_budget_ = bytes;
+        return *this;
+    }
+
+    std::size_t memory_budget() const { return memory_budget_; }
+
+    /// Set the number of threads that sort each run.
+    external_sort_options & thread_num (std::size_t number) {
+        rime::assert_ (number != 0);
+        thread_num_ = number;
+        return *this;
+    }
+
+    std::size_t thread_num() const { return thread_num_; }
+};
+
+namespace external_sort_detail {
+
+    /// The maximum number of files that are merged at once.
+    static constexpr std::size_t merge_width = 64;
+
+    /**
+    Write runs to temporary files on a background thread, one run at a time.
+
+    To limit the number of open files, the files are kept in levels.
+    Level 0 contains runs as they are written.
+    When a level has merge_width files, they are merged into one file on the
+    next level, also on the background thread.
+    */
+    template <class Record, class Less> class spiller {
+        Less const & less_;
+        std::vector <std::vector <std::shared_ptr <FILE>>> levels_;
+        /// The run that is being written.
+        std::vector <Record> writing_;
+        std::thread thread_;
+        std::exception_ptr exception_;
+
+        static std::shared_ptr <FILE> open_temporary_file() {
+            // The file is removed automatically when it is closed.
+            FILE * handle = std::tmpfile();
+            if (!handle)
+                throw file_open_error() << boost::errinfo_errno (errno);
+            return std::shared_ptr <FILE> (handle, std::fclose);
+        }
+
+        void add (std::shared_ptr <FILE> file, std::size_t level) {
+            if (levels_.size() == level)
+                levels_.emplace_back();
+            std::vector <std::shared_ptr <FILE>> & files = levels_ [level];
+            files.push_back (std::move (file));
+            if (files.size() == merge_width) {
+                std::vector <buffer <Record>> sources;
+                for (std::shared_ptr <FILE> & file : files) {
+                    std::rewind (file.get());
+                    sources.push_back (read_binary_file <Record> (
+                        std::move (file)));
+                }
+                files.clear();
+
+                binary_writer <Record> writer (open_temporary_file());
+                writer.write_range (merge_view <buffer <Record>, Less> (
+                    std::move (sources), less_));
+                writer.flush();
+                add (writer.file(), level + 1);
+            }
+        }
+
+        void write() {
+            try {
+                binary_writer <Record> writer (open_temporary_file());
+                writer.write_n (writing_.data(), writing_.size());
+                writer.flush();
+                add (writer.file(), 0);
+            } catch (...) {
+                exception_ = std::current_exception();
+            }
+        }
+
+    public:
+        explicit spiller (Less const & less) : less_ (less) {}
+
+        spiller (spiller const &) = delete;
+        spiller & operator = (spiller const &) = delete;
+
+        ~spiller() {
+            if (thread_.joinable())
+                thread_.join();
+        }
+
+        /// Wait until the last run has been written.
+        void wait() {
+            if (thread_.joinable())
+                thread_.join();
+            if (exception_) {
+                std::exception_ptr exception = exception_;
+                exception_ = std::exception_ptr();
+                std::rethrow_exception (exception);
+            }
+        }
+
+        /**
+        Start writing \a run in the background.
+        \a run is then replaced by the previous run, cleared, so that its
+        memory is reused.
+        */
+        void start (std::vector <Record> & run) {
+            wait();
+            writing_.swap (run);
+            run.clear();
+            thread_ = std::thread (&spiller::write, this);
+        }
+
+        /**
+        Wait until all runs have been written.
+        \return The files with the runs, positioned at their starts.
+        */
+        std::vector <std::shared_ptr <FILE>> finish() {
+            wait();
+            std::vector <Record>().swap (writing_);
+            std::vector <std::shared_ptr <FILE>> result;
+            // Put the oldest records first.
+            for (std::size_t level = levels_.size(); level-- != 0;) {
+                for (std::shared_ptr <FILE> & file : levels_ [level]) {
+                    std::rewind (file.get());
+                    result.push_back (std::move (file));
+                }
+            }
+            levels_.clear();
+            return result;
+        }
+    };
+
+    template <class Run, class Less> inline void sort_run (
+        Run & run, Less const & less, std::size_t thread_num)
+    {
+        if (thread_num > 1)
+            range::parallel_sort (run, thread_num, less);
+        else
+            range::sort (run, less);
+    }
+
+    template <class Record, class View, class Less>
+        inline merge_view <buffer <Record>, Less> external_sort (
+            View & records, Less const & less,
+            external_sort_options const & options)
+    {
+        std::size_t const run_size = std::max (std::size_t (1),
+            options.memory_budget() / (2 * sizeof (Record)));
+
+        spiller <Record, Less> runs (less);
+        std::vector <Record> run;
+        run.reserve (std::min (run_size, std::size_t (1024)));
+        while (!range::empty (records, front)) {
+            // Grow the capacity up to the run size, and not beyond.
+            if (run.size() == run.capacity())
+                run.reserve (std::min (2 * run.capacity(), run_size));
+            run.push_back (range::chop_in_place (records, front));
+            if (run.size() == run_size) {
+                sort_run (run, less, options.thread_num());
+                // Sorting the next run overlaps with writing this one.
+                runs.start (run);
+            }
+        }
+        sort_run (run, less, options.thread_num());
+
+        std::vector <buffer <Record>> sources;
+        for (std::shared_ptr <FILE> & file : runs.finish())
+            sources.push_back (read_binary_file <Record> (std::move (file)));
+        // The last run stays in memory.
+        if (!run.empty())
+            sources.push_back (make_buffer (view_shared (std::move (run))));
+        return merge_view <buffer <Record>, Less> (std::move (sources), less);
+    }
+
+} // namespace external_sort_detail
+
+namespace callable {
+
+    struct external_sort {
+    private:
+        template <class View, class Less,
+            class Record = typename std::decay <decltype (range::chop_in_place (
+                std::declval <View &>(), front))>::type>
+        static merge_view <buffer <Record>, Less> apply (View records,
+            Less const & less, external_sort_options const & options)
+        {
+            return external_sort_detail::external_sort <Record> (
+                records, less, options);
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && records, Less const & less,
+            external_sort_options const & options) const
+        RETURNS (apply (range::view (std::forward <Range> (records), front),
+            less, options));
+
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && records, Less const & less) const
+        RETURNS (apply (range::view (std::forward <Range> (records), front),
+            less, external_sort_options()));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && records,
+            external_sort_options const & options) const
+        RETURNS (apply (range::view (std::forward <Range> (records), front),
+            sort_detail::less(), options));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && records) const
+        RETURNS (apply (range::view (std::forward <Range> (records), front),
+            sort_detail::less(), external_sort_options()));
+    };
+
+} // namespace callable
+
+/** \brief
+Sort a range of records that may not fit in memory, and return a lazy range
+with the sorted records.
+
+The records are read from the front with chop_in_place(), so the input can be
+a single-pass range, like a \ref buffer from read_binary_file(), or
+decode_binary() on a \ref buffer from read_gzip_file().
+Runs of records that fit in half the memory budget are collected and sorted
+in memory, with parallel_sort() if more than one thread is requested.
+Each sorted run is written to a temporary file by a background thread, while
+the next run is collected and sorted.
+The last run is kept in memory.
+The result is a merge() of the runs, which reads the temporary files lazily
+as it is traversed.
+If the input fits in one run, then no temporary files are used.
+
+\code
+auto sorted = external_sort (read_binary_file <record> ("records"),
+    compare_record(),
+    external_sort_options().memory_budget (std::size_t (1) << 30)
+        .thread_num (4));
+binary_writer <record> output ("sorted");
+output.write_range (sorted);
+\endcode
+
+The temporary files are created with std::tmpfile(), and are removed
+automatically when the result and any buffers derived from it have been
+destructed.
+To limit the number of open files, whenever 64 runs have been written, they
+are merged into one file, also in the background.
+The records must be trivially copyable, since they are written to the files
+byte by byte.
+The sort is not stable.
+
+\param records The range with records to sort.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+\param options (Optional) An \ref external_sort_options object with the
+    memory budget and the number of threads.
+\return A merge_view of \ref buffer objects, which can be traversed from the
+    front.
+*/
+static auto const external_sort = callable::external_sort();
+
+} // namespace range
+
+#endif // RANGE_EXTERNAL_SORT_HPP_INCLUDED
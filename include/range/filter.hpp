@@ -0,0 +1,350 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define an adaptor that contains only the elements of a range that match a
+predicate.
+*/
+
+#ifndef RANGE_FILTER_HPP_INCLUDED
+#define RANGE_FILTER_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+#include "utility/assignable.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "iterator_range.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+template <class Underlying, class Predicate, class Direction>
+    class filter_view;
+
+namespace filter_operation {
+    struct filter_view_tag {};
+} // namespace filter_operation
+
+template <class Underlying, class Predicate, class Direction>
+    struct tag_of_qualified <filter_view <Underlying, Predicate, Direction>>
+{ typedef filter_operation::filter_view_tag type; };
+
+namespace filter_detail {
+
+    /**
+    Move through the underlying range to the next element that matches the
+    predicate.
+    This general implementation tests one element at a time.
+    */
+    template <class Underlying, class Direction, class Enable = void>
+        class scanner
+    {
+    public:
+        /**
+        Drop elements from \a underlying until it is empty or its first element
+        matches \a predicate.
+        */
+        template <class Predicate> void skip (Underlying & underlying,
+            Predicate const & predicate, Direction const & direction)
+        {
+            while (!range::empty (underlying, direction)
+                    && !predicate (range::first (underlying, direction)))
+                underlying = range::drop (underlying, direction);
+        }
+
+        /**
+        Drop the first element, which matches, and then skip to the next
+        element that matches.
+        */
+        template <class Predicate> void next (Underlying & underlying,
+            Predicate const & predicate, Direction const & direction)
+        {
+            underlying = range::drop (underlying, direction);
+            skip (underlying, predicate, direction);
+        }
+    };
+
+    /// \return The position of the lowest set bit in \a mask, which is not 0.
+    inline unsigned lowest_bit (std::uint64_t mask) {
+        assert (mask != 0);
+#if defined (__GNUC__) || defined (__clang__)
+        return unsigned (__builtin_ctzll (mask));
+#else
+        unsigned position = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++ position;
+        }
+        return position;
+#endif
+    }
+
+    template <class Underlying, class Direction> struct is_block_scannable
+    : std::false_type {};
+
+    /**
+    Ranges of random-access iterators over arithmetic types are scanned a
+    block of elements at a time.
+    */
+    template <class Iterator, class Direction>
+        struct is_block_scannable <iterator_range <Iterator>, Direction>
+    : std::integral_constant <bool,
+        std::is_base_of <std::random_access_iterator_tag, typename
+            std::iterator_traits <Iterator>::iterator_category>::value
+        && std::is_arithmetic <typename
+            std::iterator_traits <Iterator>::value_type>::value
+        && (std::is_same <Direction, direction::front>::value
+            || std::is_same <Direction, direction::back>::value)> {};
+
+    /**
+    Scanner that evaluates the predicate for a block of up to 64 elements at
+    a time, without branching on the result, and stores the results in a
+    bitmask.
+    The compiler can often vectorise this.
+    The bitmask is kept, so that subsequent matches in the same block are
+    found without evaluating the predicate again.
+    */
+    template <class Underlying, class Direction>
+        class scanner <Underlying, Direction, typename std::enable_if <
+            is_block_scannable <Underlying, Direction>::value>::type>
+    {
+        static constexpr std::size_t block_size = 64;
+
+        /**
+        Bit i is set iff the predicate matches the element i positions away
+        from the first element of the underlying range.
+        Only the first \c known_ bits are valid; the rest are zero.
+        */
+        std::uint64_t mask_;
+        std::size_t known_;
+
+        static auto element (Underlying const & underlying, std::size_t index,
+            direction::front)
+        RETURNS (underlying.begin() [index]);
+
+        static auto element (Underlying const & underlying, std::size_t index,
+            direction::back)
+        RETURNS (*(underlying.end() - (index + 1)));
+
+        template <class Predicate> static std::uint64_t evaluate (
+            Underlying const & underlying, std::size_t count,
+            Predicate const & predicate, Direction const & direction)
+        {
+            std::uint64_t mask = 0;
+            for (std::size_t index = 0; index != count; ++ index)
+                mask |= std::uint64_t (bool (predicate (
+                    element (underlying, index, direction)))) << index;
+            return mask;
+        }
+
+        /**
+        Drop the unset bits at the start of mask_ from \a underlying.
+        \pre mask_ != 0.
+        */
+        void drop_non_matching (Underlying & underlying,
+            Direction const & direction)
+        {
+            unsigned skipped = lowest_bit (mask_);
+            underlying = range::drop (underlying, skipped, direction);
+            mask_ >>= skipped;
+            known_ -= skipped;
+        }
+
+    public:
+        scanner() : mask_ (0), known_ (0) {}
+
+        template <class Predicate> void skip (Underlying & underlying,
+            Predicate const & predicate, Direction const & direction)
+        {
+            while (true) {
+                std::size_t count = range::size (underlying, direction);
+                if (count > block_size)
+                    count = block_size;
+                if (count == 0) {
+                    known_ = 0;
+                    return;
+                }
+                mask_ = evaluate (underlying, count, predicate, direction);
+                known_ = count;
+                if (mask_ != 0) {
+                    drop_non_matching (underlying, direction);
+                    return;
+                }
+                underlying = range::drop (underlying, count, direction);
+            }
+        }
+
+        template <class Predicate> void next (Underlying & underlying,
+            Predicate const & predicate, Direction const & direction)
+        {
+            assert (known_ != 0 && (mask_ & 1));
+            underlying = range::drop (underlying, direction);
+            mask_ >>= 1;
+            -- known_;
+            if (mask_ != 0)
+                drop_non_matching (underlying, direction);
+            else {
+                // None of the known elements match.
+                underlying = range::drop (underlying, known_, direction);
+                skip (underlying, predicate, direction);
+            }
+        }
+    };
+
+} // namespace filter_detail
+
+/**
+View of the elements of an underlying view that match a predicate.
+The underlying view is always positioned at the next matching element, so
+that empty() and first() do not need to evaluate the predicate.
+*/
+template <class Underlying, class Predicate, class Direction>
+    class filter_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+public:
+    typedef Underlying underlying_type;
+    typedef Predicate predicate_type;
+
+    template <class Underlying_, class Predicate_>
+        filter_view (Underlying_ && underlying, Predicate_ && predicate,
+            Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (std::forward <Underlying_> (underlying)),
+        predicate_ (std::forward <Predicate_> (predicate)), scanner_()
+    { scanner_.skip (underlying_, predicate_.content(), direction); }
+
+    Predicate const & predicate() const { return predicate_.content(); }
+
+    /**
+    \return The part of the underlying range that has not been visited.
+    Unless it is empty, its first element matches the predicate.
+    */
+    Underlying const & underlying() const { return underlying_; }
+
+private:
+    Underlying underlying_;
+    // The predicate is not necessarily assignable.
+    utility::assignable <Predicate> predicate_;
+    filter_detail::scanner <Underlying, Direction> scanner_;
+
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (underlying_,
+        this->direction_must_be_equal (direction)));
+
+    auto first (Direction const & direction) const
+    RETURNS (range::first (underlying_,
+        this->direction_must_be_equal (direction)));
+
+    filter_view drop_one (Direction const & direction) const {
+        rime::assert_ (!range::empty (underlying_, direction));
+        filter_view result (*this);
+        result.scanner_.next (
+            result.underlying_, predicate_.content(), direction);
+        return result;
+    }
+};
+
+namespace callable {
+
+    struct filter {
+    private:
+        struct dispatch {
+            template <class View, class Predicate, class Direction>
+                auto operator() (View && view, Predicate && predicate,
+                    Direction const & direction) const
+            RETURNS (filter_view <typename std::decay <View>::type,
+                typename std::decay <Predicate>::type, Direction> (
+                    std::forward <View> (view),
+                    std::forward <Predicate> (predicate), direction));
+        };
+
+    public:
+        template <class Range, class Predicate, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, Predicate && predicate,
+            Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            std::forward <Predicate> (predicate), direction));
+
+        template <class Range, class Predicate, class Enable =
+            typename std::enable_if <
+                is_range <Range>::value && !is_direction <Predicate>::value
+            >::type>
+        auto operator() (Range && range, Predicate && predicate) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            std::forward <Predicate> (predicate),
+            range::default_direction (range)));
+    };
+
+} // namespace callable
+
+/**
+Return a view of the elements of a range for which a predicate returns true.
+
+\code
+std::vector <int> v = {1, 2, 3, 4, 5};
+auto odd = filter (v, [](int i) { return i % 2 != 0; });
+// odd contains 1, 3, 5.
+\endcode
+
+The view keeps the underlying view positioned at the next matching element.
+Therefore, empty() and first() do not evaluate the predicate, and the predicate
+is evaluated once for each element that is traversed.
+When the view is constructed, the predicate is evaluated until the first
+matching element is found.
+
+If the underlying view is an iterator_range over random-access iterators to
+arithmetic types (for example, a view of a std::vector <float>), the predicate
+is evaluated on blocks of elements at a time, and the results are kept in a
+bitmask.
+This can be much faster, because the evaluation is free of branches.
+The predicate may then be evaluated on elements beyond the next matching
+element, so it should not have side effects.
+
+The result has no size, and only supports dropping one element at a time.
+The underlying view must be copyable, and dropping elements from it must return
+the same type.
+
+\param range The range to filter.
+\param predicate The function that is called with an element and returns
+    \c true if it should be included in the result.
+    It is called as a const object.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const filter = callable::filter();
+
+} // namespace range
+
+#endif // RANGE_FILTER_HPP_INCLUDED
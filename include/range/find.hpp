@@ -243,17 +243,54 @@ Forward to a newly constructed mutable find_detail::finder <...>.
 
 /* Interface. */
 
+namespace helper {
+
+    /** \brief
+    Hook for implementing find() for a type of range.
+
+    This does normally not have to be implemented, because the general
+    implementation is fine, but it might be an optimisation.
+    For example, a range that consists of segments can search each segment
+    separately.
+
+    \param tag The range tag.
+    \param range The range to find an element in.
+    \param direction The direction in which the range is traversed.
+    \param predicate The function that is called with every element until it
+        returns \c true.
+    \param non_empty_actor The function to call with the remaining range if an
+        element is found.
+    \param empty_actor The function to call with the empty range if no element
+        is found.
+    */
+    void implement_find (unusable);
+
+} // namespace helper
+
 namespace callable {
 
-    class find {
-    private:
+    namespace find_implementation {
+        using helper::implement_find;
+
         struct dispatch {
-            // All arguments.
+            // Use implement_find, if it is implemented.
             template <class Range, class Direction,
                 class Predicate, class NonEmptyActor, class EmptyActor>
             auto operator() (Range && range, Direction const & direction,
                 Predicate && predicate, NonEmptyActor && non_empty_actor,
-                    EmptyActor && empty_actor) const
+                EmptyActor && empty_actor, overload_order <1> *) const
+            RETURNS (implement_find (typename tag_of <Range>::type(),
+                std::forward <Range> (range), direction,
+                std::forward <Predicate> (predicate),
+                std::forward <NonEmptyActor> (non_empty_actor),
+                std::forward <EmptyActor> (empty_actor)));
+
+            // Use the general implementation.
+            template <class Range, class Direction,
+                class Predicate, class NonEmptyActor, class EmptyActor>
+            auto operator() (Range && range, Direction const & direction,
+                Predicate && predicate, NonEmptyActor && non_empty_actor,
+                EmptyActor && empty_actor, overload_order <2> *) const
             RETURNS (
                 find_detail::finder <Predicate, NonEmptyActor, EmptyActor> (
                         std::forward <Predicate> (predicate),
@@ -261,30 +298,45 @@ namespace callable {
                         std::forward <EmptyActor> (empty_actor)
                     ) (
                         std::forward <Range> (range), direction));
+        };
+
+    } // namespace find_implementation
+
+    class find {
+    private:
+        struct dispatch {
+            // All arguments.
+            template <class Range, class Direction,
+                class Predicate, class NonEmptyActor, class EmptyActor>
+            auto operator() (Range && range, Direction const & direction,
+                Predicate && predicate, NonEmptyActor && non_empty_actor,
+                    EmptyActor && empty_actor) const
+            RETURNS (find_implementation::dispatch() (
+                std::forward <Range> (range), direction,
+                std::forward <Predicate> (predicate),
+                std::forward <NonEmptyActor> (non_empty_actor),
+                std::forward <EmptyActor> (empty_actor), pick_overload()));
 
             // No empty_actor.
             template <class Range, class Direction,
                 class Predicate, class Actor>
             auto operator() (Range && range, Direction const & direction,
                 Predicate && predicate, Actor && actor) const
-            RETURNS (
-                find_detail::finder <Predicate, Actor, Actor> (
-                        std::forward <Predicate> (predicate),
-                        std::forward <Actor> (actor),
-                        std::forward <Actor> (actor)
-                    ) (std::forward <Range> (range), direction));
+            RETURNS (find_implementation::dispatch() (
+                std::forward <Range> (range), direction,
+                std::forward <Predicate> (predicate),
+                std::forward <Actor> (actor), std::forward <Actor> (actor),
+                pick_overload()));
 
             // No actors.
             template <class Range, class Direction, class Predicate>
             auto operator() (Range && range, Direction const & direction,
                 Predicate && predicate) const
-            RETURNS (
-                find_detail::finder <Predicate,
-                    find_detail::identity, find_detail::identity> (
-                        std::forward <Predicate> (predicate),
-                        find_detail::identity(), find_detail::identity()
-                    ) (
-                        std::forward <Range> (range), direction));
+            RETURNS (find_implementation::dispatch() (
+                std::forward <Range> (range), direction,
+                std::forward <Predicate> (predicate),
+                find_detail::identity(), find_detail::identity(),
+                pick_overload()));
         };
 
     public:
@@ -17,9 +17,16 @@ limitations under the License.
 #ifndef RANGE_FUNCTION_RANGE_HPP_INCLUDED
 #define RANGE_FUNCTION_RANGE_HPP_INCLUDED
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
 
 #include "rime/always.hpp"
+#include "rime/assert.hpp"
 
 #include "core.hpp"
 
@@ -62,6 +69,165 @@ private:
     auto chop_in_place (direction::front) RETURNS (function_());
 };
 
+namespace function_range_detail {
+
+    /// The number of elements in a block by default: up to 256 bytes.
+    template <class Element> struct default_block_size {
+        static constexpr std::size_t value =
+            (sizeof (Element) < 256) ? 256 / sizeof (Element) : 1;
+    };
+
+    /**
+    State of a block_function_range.
+    The elements that the function has generated but that have not been
+    returned yet are kept in a block.
+    The block is refilled only when an element is requested, so that it is
+    possible to hand the function a block owned by the caller instead.
+    */
+    template <class Element, class Function> class block_state {
+        Function function_;
+        std::unique_ptr <Element []> block_;
+        std::size_t block_size_;
+        /// The elements that have not been returned are [first_, end_).
+        std::size_t first_;
+        std::size_t end_;
+        /// Whether the function has returned 0.
+        bool exhausted_;
+
+    public:
+        template <class Function_>
+            block_state (Function_ && function, std::size_t block_size)
+        : function_ (std::forward <Function_> (function)),
+            block_ (new Element [block_size]), block_size_ (block_size),
+            first_ (0), end_ (0), exhausted_ (false)
+        { rime::assert_ (block_size != 0); }
+
+        Function & function() { return function_; }
+
+        /**
+        Call the function to write at most \a max elements to \a out.
+        \return The number of elements written, which is 0 only if the
+            function is exhausted.
+        */
+        std::size_t generate (Element * out, std::size_t max) {
+            if (exhausted_)
+                return 0;
+            std::size_t number = function_ (out, max);
+            rime::assert_ (number <= max);
+            if (number == 0)
+                exhausted_ = true;
+            return number;
+        }
+
+        /// Make sure the block is non-empty, unless the function is exhausted.
+        void load() {
+            if (first_ == end_) {
+                first_ = 0;
+                end_ = generate (block_.get(), block_size_);
+            }
+        }
+
+        bool empty() {
+            load();
+            return first_ == end_;
+        }
+
+        Element chop() {
+            load();
+            rime::assert_ (first_ != end_);
+            return std::move (block_ [first_ ++]);
+        }
+
+        /**
+        Move at most \a max next elements into \a out.
+        Elements that are in the block are moved first; if there are none,
+        the function writes directly to \a out.
+        \return The number of elements written, which is 0 only if there are
+            no elements left.
+        */
+        std::size_t read (Element * out, std::size_t max) {
+            if (first_ == end_)
+                return generate (out, max);
+            std::size_t number = std::min (max, end_ - first_);
+            std::move (block_.get() + first_, block_.get() + first_ + number,
+                out);
+            first_ += number;
+            return number;
+        }
+
+        /// Call \a consumer with each remaining element, block by block.
+        template <class Consumer> void for_each (Consumer && consumer) {
+            for (load(); first_ != end_; load()) {
+                std::size_t const end = end_;
+                while (first_ != end)
+                    consumer (std::move (block_ [first_ ++]));
+            }
+        }
+    };
+
+} // namespace function_range_detail
+
+/**
+Range whose elements are generated a block at a time by a function.
+The function has the signature <c>std::size_t (Element * out, std::size_t
+max)</c>.
+The elements are kept in a block inside the range until they are requested.
+Like function_range, this is noncopyable, but movable.
+*/
+template <class Element, class Function> class block_function_range {
+public:
+    typedef typename std::conditional <std::is_function <Function>::value,
+        typename std::add_pointer <Function>::type, Function>::type
+        function_type;
+
+private:
+    typedef function_range_detail::block_state <Element, function_type>
+        state_type;
+
+    std::unique_ptr <state_type> state_;
+
+public:
+    block_function_range (Function const & function, std::size_t block_size)
+    : state_ (new state_type (function, block_size)) {}
+
+    block_function_range (Function && function, std::size_t block_size)
+    : state_ (new state_type (std::move (function), block_size)) {}
+
+    block_function_range (block_function_range const &) = delete;
+    block_function_range (block_function_range &&) = default;
+
+    block_function_range & operator = (block_function_range const &) = delete;
+    block_function_range & operator = (block_function_range &&) = default;
+
+    function_type & function() { return state_->function(); }
+
+    /**
+    Move at most \a max next elements into \a out, which must point to
+    constructed elements.
+    Elements that have been generated but not returned yet come first.
+    If there are none, the function is called to write directly to \a out.
+    This is how consumers that have their own memory, like \ref buffer, avoid
+    copying elements.
+    \return The number of elements written.
+        This is 0 if and only if the range is empty.
+    */
+    std::size_t read (Element * out, std::size_t max)
+    { return state_->read (out, max); }
+
+private:
+    friend class helper::member_access;
+
+    // The state is behind a pointer, so that empty() can generate the next
+    // block.
+    bool empty (direction::front) const { return state_->empty(); }
+
+    Element chop_in_place (direction::front) { return state_->chop(); }
+
+    template <class Consumer>
+        void for_each (direction::front, Consumer && consumer)
+    { state_->for_each (std::forward <Consumer> (consumer)); }
+};
+
 namespace function_range_operation {
 
     struct function_range_tag {};
@@ -71,11 +237,23 @@ namespace function_range_operation {
         function_range <Function> && range, direction::front const & direction)
     RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
 
+    struct block_function_range_tag {};
+
+    template <class Element, class Function>
+    inline auto implement_chop (block_function_range_tag const & tag,
+        block_function_range <Element, Function> && range,
+        direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
 } // namespace function_range_operation
 
 template <class Function> struct tag_of_qualified <function_range <Function>>
 { typedef function_range_operation::function_range_tag type; };
 
+template <class Element, class Function>
+    struct tag_of_qualified <block_function_range <Element, Function>>
+{ typedef function_range_operation::block_function_range_tag type; };
+
 /** \brief
 Create a range whose elements are the results of consecutive function calls.
 
@@ -87,6 +265,53 @@ template <class Function> function_range <Function>
     make_function_range (Function const & function)
 { return function_range <Function> (function); }
 
+/** \brief
+Create a range whose elements are generated in blocks by a function.
+
+The function is called as <c>function (out, max)</c>, where \c out is an
+<c>Element *</c> that points to \c max constructed elements, and \c max is
+greater than zero.
+It should assign up to \c max elements, and return the number of elements it
+has written as a \c std::size_t.
+Returning 0 indicates that there are no more elements; after that, the function
+is not called again.
+
+This is useful for sources that produce many elements at a time, like random
+number generators and synthetic data generators.
+Compared to \ref make_function_range, it replaces the function call for each
+element by one for each block.
+make_buffer() called on an rvalue of this range has the function write directly
+to the chunks of the buffer, and for_each() traverses the range one block at a
+time.
+Element-by-element access with chop_in_place() reads from an internal block.
+
+\code
+std::size_t iota (int * out, std::size_t max) {
+    static int next = 0;
+    for (std::size_t i = 0; i != max; ++ i)
+        out [i] = next ++;
+    return max;
+}
+auto numbers = make_buffer (make_block_function_range <int> (iota));
+\endcode
+
+Like the result of \ref make_function_range, the resulting range is noncopyable,
+but movable.
+It can only be traversed from the front.
+
+\tparam Element The type of the elements.
+    This must be default-constructible and move-assignable.
+\param function The function that generates the elements.
+\param block_size (optional) The number of elements in the internal block.
+    By default, the block takes 256 bytes.
+*/
+template <class Element, class Function>
+    block_function_range <Element, Function>
+    make_block_function_range (Function const & function,
+        std::size_t block_size =
+            function_range_detail::default_block_size <Element>::value)
+{ return block_function_range <Element, Function> (function, block_size); }
+
 } // namespace range
 
 #endif // RANGE_FUNCTION_RANGE_HPP_INCLUDED
@@ -0,0 +1,222 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define generator, a range whose elements are produced by a coroutine.
+
+This requires compiler support for C++20 coroutines.
+If it is available, RANGE_HAS_GENERATOR is defined as 1; otherwise, it is
+defined as 0, and this header defines nothing else.
+*/
+
+#ifndef RANGE_GENERATOR_HPP_INCLUDED
+#define RANGE_GENERATOR_HPP_INCLUDED
+
+#include "detail/coroutine.hpp"
+
+#define RANGE_HAS_GENERATOR RANGE_HAS_COROUTINES
+
+#if RANGE_HAS_GENERATOR
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+
+namespace range {
+
+template <class Element> class generator;
+
+namespace generator_operation {
+
+    struct generator_tag {};
+
+    template <class Element>
+    inline auto implement_chop (generator_tag const & tag,
+        generator <Element> && range, direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
+} // namespace generator_operation
+
+template <class Element> struct tag_of_qualified <generator <Element>>
+{ typedef generator_operation::generator_tag type; };
+
+/** \brief
+Range whose elements are yielded by a coroutine.
+
+A function that returns a generator \<Element> and uses \c co_yield becomes a
+coroutine.
+Each time the next element is needed, the coroutine is resumed until it
+yields an element or returns.
+
+\code
+range::generator <int> fibonacci() {
+    int current = 0, next = 1;
+    while (true) {
+        co_yield current;
+        current = std::exchange (next, current + next);
+    }
+}
+\endcode
+
+The coroutine is not started until empty(), first() or chop_in_place() is
+called.
+An exception that escapes from the coroutine is thrown from that call, and
+the range is then empty.
+
+The range can only be traversed once, from the front, with chop_in_place().
+It is noncopyable, but movable.
+It can be wrapped with make_buffer() to allow copies, with an any_range with
+capability::unique_capabilities to erase its type, and with
+python::python_iterator to traverse it from Python.
+
+The coroutine frame is allocated with a per-thread cache of freed frames, so
+that creating a generator that is used briefly does not normally need a heap
+allocation.
+
+\tparam Element The type of the elements.
+    This must be an object type; it cannot be a reference.
+    An rvalue that is yielded is moved out by chop_in_place().
+    An lvalue is copied first.
+*/
+template <class Element> class generator {
+    static_assert (!std::is_reference <Element>::value,
+        "The element type of a generator cannot be a reference.");
+public:
+    class promise_type;
+    typedef std::coroutine_handle <promise_type> handle_type;
+
+    class promise_type {
+        /// The element that has been yielded, or null.
+        Element * value_;
+        std::exception_ptr exception_;
+
+        friend class generator;
+
+        /// Awaiter that keeps a copy of a yielded lvalue.
+        struct copy_awaiter {
+            Element copy;
+            promise_type * promise;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend (handle_type) noexcept
+            { promise->value_ = std::addressof (copy); }
+            void await_resume() const noexcept {}
+        };
+
+    public:
+        promise_type() : value_ (nullptr) {}
+
+        generator get_return_object()
+        { return generator (handle_type::from_promise (*this)); }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_always final_suspend() const noexcept { return {}; }
+
+        std::suspend_always yield_value (Element && value) noexcept {
+            value_ = std::addressof (value);
+            return {};
+        }
+
+        copy_awaiter yield_value (Element const & value)
+        { return copy_awaiter {value, this}; }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception()
+        { exception_ = std::current_exception(); }
+
+        // A generator only produces elements; it does not wait for anything.
+        template <class Awaitable>
+            void await_transform (Awaitable &&) = delete;
+
+        static void * operator new (std::size_t size)
+        { return coroutine_detail::frame_allocator::allocate (size); }
+
+        static void operator delete (void * frame, std::size_t size) noexcept
+        { coroutine_detail::frame_allocator::deallocate (frame, size); }
+    };
+
+private:
+    handle_type handle_;
+
+    explicit generator (handle_type handle) : handle_ (handle) {}
+
+    /// Resume the coroutine if no element is available and it has not
+    /// finished.
+    void load() const {
+        promise_type & promise = handle_.promise();
+        if (!promise.value_ && !handle_.done()) {
+            handle_.resume();
+            if (promise.exception_)
+                std::rethrow_exception (
+                    std::exchange (promise.exception_, nullptr));
+        }
+    }
+
+public:
+    generator (generator const &) = delete;
+    generator (generator && other) noexcept
+    : handle_ (std::exchange (other.handle_, nullptr)) {}
+
+    generator & operator = (generator const &) = delete;
+    generator & operator = (generator && other) noexcept {
+        std::swap (handle_, other.handle_);
+        return *this;
+    }
+
+    ~generator() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const {
+        load();
+        return handle_.done();
+    }
+
+    Element const & first (direction::front) const {
+        load();
+        rime::assert_ (!handle_.done());
+        return *handle_.promise().value_;
+    }
+
+    Element chop_in_place (direction::front) {
+        load();
+        rime::assert_ (!handle_.done());
+        promise_type & promise = handle_.promise();
+        Element result = std::move (*promise.value_);
+        promise.value_ = nullptr;
+        return result;
+    }
+};
+
+} // namespace range
+
+#endif // RANGE_HAS_GENERATOR
+
+#endif // RANGE_GENERATOR_HPP_INCLUDED
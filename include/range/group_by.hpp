@@ -0,0 +1,390 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define adaptors that split a range into runs of consecutive elements with
+equal keys.
+*/
+
+#ifndef RANGE_GROUP_BY_HPP_INCLUDED
+#define RANGE_GROUP_BY_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+
+namespace range {
+
+template <class Underlying, class KeyFunction> class group_view;
+template <class Underlying, class KeyFunction> class group_by_range;
+template <class Underlying> class run_length_range;
+
+namespace group_by_operation {
+    struct group_view_tag {};
+    struct group_by_range_tag {};
+    struct run_length_range_tag {};
+} // namespace group_by_operation
+
+template <class Underlying, class KeyFunction>
+    struct tag_of_qualified <group_view <Underlying, KeyFunction>>
+{ typedef group_by_operation::group_view_tag type; };
+
+template <class Underlying, class KeyFunction>
+    struct tag_of_qualified <group_by_range <Underlying, KeyFunction>>
+{ typedef group_by_operation::group_by_range_tag type; };
+
+template <class Underlying>
+    struct tag_of_qualified <run_length_range <Underlying>>
+{ typedef group_by_operation::run_length_range_tag type; };
+
+namespace group_by_detail {
+
+    struct identity {
+        template <class Element>
+            Element const & operator() (Element const & element) const
+        { return element; }
+    };
+
+    /**
+    Traversal state of the underlying range.
+    The underlying range is only traversed with chop_in_place(), so that it
+    can be a single-pass range.
+    One element is read ahead, so that it is known whether it is in the
+    current group.
+    */
+    template <class Underlying, class KeyFunction> class state {
+        typedef decltype (range::chop_in_place (
+            std::declval <Underlying &>(), front)) chop_type;
+
+    public:
+        /**
+        Type of the element that is read ahead.
+        Lvalue references are kept; other elements are stored by value.
+        */
+        typedef typename std::conditional <
+            std::is_lvalue_reference <chop_type>::value, chop_type,
+            typename std::decay <chop_type>::type>::type element_type;
+
+        typedef typename std::decay <decltype (std::declval <
+            KeyFunction const &>() (std::declval <element_type &>()))>::type
+            key_type;
+
+    private:
+        Underlying underlying_;
+        KeyFunction key_function_;
+        /// The element read ahead, or none if the underlying range is empty.
+        boost::optional <element_type> current_;
+        /// The key of current_.
+        boost::optional <key_type> next_key_;
+        /// The key of the current group.
+        boost::optional <key_type> key_;
+        /// The number of groups that have been started.
+        std::size_t group_;
+        /// Whether current_ is in the current group.
+        bool in_group_;
+
+        void load() {
+            if (range::empty (underlying_, front)) {
+                current_ = boost::none;
+                in_group_ = false;
+            } else {
+                current_ = boost::optional <element_type> (
+                    range::chop_in_place (underlying_, front));
+                next_key_ = key_function_ (*current_);
+                in_group_ = key_ && *next_key_ == *key_;
+            }
+        }
+
+    public:
+        template <class Underlying_, class KeyFunction_>
+            state (Underlying_ && underlying, KeyFunction_ && key_function)
+        : underlying_ (std::forward <Underlying_> (underlying)),
+            key_function_ (std::forward <KeyFunction_> (key_function)),
+            group_ (0), in_group_ (false)
+        { load(); }
+
+        /// \return \c true iff there are no more elements.
+        bool at_end() const { return !current_; }
+
+        std::size_t group() const { return group_; }
+        bool in_group() const { return in_group_; }
+
+        key_type const & key() const { return *key_; }
+        key_type && move_key() { return std::move (*key_); }
+
+        /// \return The first element of the current group.
+        element_type & current() {
+            rime::assert_ (in_group_);
+            return *current_;
+        }
+
+        /// Remove the first element of the current group.
+        element_type chop() {
+            rime::assert_ (in_group_);
+            element_type result = static_cast <element_type &&> (*current_);
+            load();
+            return static_cast <element_type &&> (result);
+        }
+
+        /**
+        Skip the rest of the current group.
+        \return The number of elements that were skipped.
+        */
+        std::size_t skip_group() {
+            std::size_t count = 0;
+            for (; in_group_; ++ count)
+                load();
+            return count;
+        }
+
+        /**
+        Start a new group at the current element.
+        \pre The previous group has been skipped, and at_end() is false.
+        */
+        void start_group() {
+            rime::assert_ (!in_group_ && current_);
+            key_ = std::move (next_key_);
+            ++ group_;
+            in_group_ = true;
+        }
+    };
+
+} // namespace group_by_detail
+
+/**
+View of one group of a group_by_range.
+It reads elements from the state of the underlying range, which it shares
+with the group_by_range and with its own copies.
+It therefore becomes empty as soon as the next group is requested.
+*/
+template <class Underlying, class KeyFunction> class group_view {
+public:
+    typedef group_by_detail::state <Underlying, KeyFunction> state_type;
+    typedef typename state_type::element_type element_type;
+
+    group_view (std::shared_ptr <state_type> const & state, std::size_t group)
+    : state_ (state), group_ (group) {}
+
+private:
+    std::shared_ptr <state_type> state_;
+    std::size_t group_;
+
+    friend class helper::member_access;
+
+    bool empty (direction::front) const
+    { return state_->group() != group_ || !state_->in_group(); }
+
+    element_type const & first (direction::front) const {
+        rime::assert_ (!empty (front));
+        return state_->current();
+    }
+
+    element_type chop_in_place (direction::front) {
+        rime::assert_ (!empty (front));
+        return state_->chop();
+    }
+};
+
+/**
+Single-pass range of groups of consecutive elements with equal keys.
+Each element is a std::pair of the key and a group_view.
+Copies of this range share their position.
+*/
+template <class Underlying, class KeyFunction> class group_by_range {
+public:
+    typedef group_by_detail::state <Underlying, KeyFunction> state_type;
+    typedef typename state_type::key_type key_type;
+    typedef group_view <Underlying, KeyFunction> group_type;
+
+    template <class Underlying_, class KeyFunction_>
+        group_by_range (Underlying_ && underlying, KeyFunction_ && key_function)
+    : state_ (std::make_shared <state_type> (
+        std::forward <Underlying_> (underlying),
+        std::forward <KeyFunction_> (key_function))) {}
+
+private:
+    std::shared_ptr <state_type> state_;
+
+    friend class helper::member_access;
+
+    // The rest of the current group must be skipped to find out whether
+    // another group follows.
+    bool empty (direction::front) const {
+        state_->skip_group();
+        return state_->at_end();
+    }
+
+    std::pair <key_type, group_type> chop_in_place (direction::front) {
+        state_->skip_group();
+        state_->start_group();
+        return std::pair <key_type, group_type> (
+            state_->key(), group_type (state_, state_->group()));
+    }
+};
+
+/**
+Single-pass range of runs of consecutive equal elements.
+Each element is a std::pair of the value and the length of the run.
+*/
+template <class Underlying> class run_length_range {
+public:
+    typedef group_by_detail::state <Underlying, group_by_detail::identity>
+        state_type;
+    typedef typename state_type::key_type value_type;
+
+    template <class Underlying_>
+        explicit run_length_range (Underlying_ && underlying)
+    : state_ (std::forward <Underlying_> (underlying),
+        group_by_detail::identity()) {}
+
+private:
+    state_type state_;
+
+    friend class helper::member_access;
+
+    bool empty (direction::front) const { return state_.at_end(); }
+
+    std::pair <value_type, std::size_t> chop_in_place (direction::front) {
+        state_.start_group();
+        std::size_t count = state_.skip_group();
+        return std::pair <value_type, std::size_t> (state_.move_key(), count);
+    }
+};
+
+namespace callable {
+
+    struct group_by {
+    private:
+        template <class View, class KeyFunction>
+            static group_by_range <typename std::decay <View>::type,
+                typename std::decay <KeyFunction>::type>
+            make (View && view, KeyFunction && key_function)
+        {
+            return group_by_range <typename std::decay <View>::type,
+                typename std::decay <KeyFunction>::type> (
+                    std::forward <View> (view),
+                    std::forward <KeyFunction> (key_function));
+        }
+
+    public:
+        template <class Range, class KeyFunction, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, KeyFunction && key_function) const
+        RETURNS (make (range::view (std::forward <Range> (range), front),
+            std::forward <KeyFunction> (key_function)));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range) const
+        RETURNS (make (range::view (std::forward <Range> (range), front),
+            group_by_detail::identity()));
+    };
+
+    struct run_length {
+    private:
+        template <class View>
+            static run_length_range <typename std::decay <View>::type>
+            make (View && view)
+        {
+            return run_length_range <typename std::decay <View>::type> (
+                std::forward <View> (view));
+        }
+
+    public:
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range) const
+        RETURNS (make (range::view (std::forward <Range> (range), front)));
+    };
+
+} // namespace callable
+
+/** \brief
+Split a range into groups of consecutive elements with equal keys.
+
+This is useful, for example, to aggregate the records of a sorted stream that
+have the same key.
+The result is a single-pass range.
+Each of its elements is a std::pair of the key and a view of the elements in
+the group.
+The underlying range is traversed with chop_in_place() only, one element at a
+time, so it can be a single-pass range, like a \ref buffer or a
+\ref function_range.
+The elements of a group are not copied into a container.
+
+\code
+std::vector <std::pair <int, double>> v = {{1, .5}, {1, 2.}, {3, 1.}};
+RANGE_FOR_EACH (group, group_by (v, [](std::pair <int, double> const & p)
+    { return p.first; }))
+{
+    double total = 0;
+    RANGE_FOR_EACH (element, group.second)
+        total += element.second;
+    // total is 2.5 for key 1, and 1 for key 3.
+}
+\endcode
+
+The groups share the position in the underlying range with the range of
+groups.
+Requesting the next group, or calling empty() on the range of groups, skips the
+elements of the current group that have not been visited.
+The current group is then empty.
+Copies of the range of groups, and of the groups, also share the position.
+
+The underlying range is traversed from the front.
+One element of the underlying range is read ahead.
+If it is returned as an lvalue reference, then so are the elements of the
+groups; otherwise, it is stored by value.
+
+\param range The range to split into groups.
+\param key_function (Optional) The function that computes the key for an
+    element.
+    Keys are compared with operator==.
+    The key function is called exactly once for each element.
+    By default, the elements themselves are used as keys.
+*/
+static auto const group_by = callable::group_by();
+
+/** \brief
+Compress a range into runs of consecutive equal elements.
+
+The result is a single-pass range of std::pair's of the value and the number of
+times it is repeated.
+Elements are compared with operator==.
+The underlying range is traversed from the front with chop_in_place(), so that
+it can be a single-pass range, like a \ref buffer.
+
+\code
+std::vector <int> v = {7, 7, 7, 2, 7, 7};
+// run_length (v) contains (7, 3), (2, 1), (7, 2).
+\endcode
+
+\param range The range to compress.
+*/
+static auto const run_length = callable::run_length();
+
+} // namespace range
+
+#endif // RANGE_GROUP_BY_HPP_INCLUDED
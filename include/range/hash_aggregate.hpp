@@ -0,0 +1,198 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define hash_aggregate, which folds the elements of a range per key.
+*/
+
+#ifndef RANGE_HASH_AGGREGATE_HPP_INCLUDED
+#define RANGE_HASH_AGGREGATE_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/returns.hpp"
+
+#include "core.hpp"
+#include "tuple.hpp"
+#include "detail/hash_table.hpp"
+#include "detail/partition.hpp"
+
+namespace range {
+
+namespace hash_aggregate_detail {
+
+    template <class View> struct element
+    : std::decay <decltype (range::chop_in_place (
+        std::declval <View &>(), front))> {};
+
+    template <class View, class KeyFunction> struct key
+    : hash_table_detail::key_value <decltype (
+        std::declval <KeyFunction const &>() (
+            std::declval <typename element <View>::type const &>()))> {};
+
+    template <class View, class KeyFunction, class State,
+        class Key = typename key <View, KeyFunction>::type>
+    struct result
+    { typedef std::vector <tuple <Key, State>> type; };
+
+    template <class View, class KeyFunction, class State, class Function,
+        class Key = typename key <View, KeyFunction>::type>
+    inline typename result <View, KeyFunction, State>::type
+        aggregate (View elements, KeyFunction const & key,
+            State const & initial, Function const & function)
+    {
+        hash_table_detail::aggregate_table <Key, State> table;
+        while (!range::empty (elements, front)) {
+            auto && element = range::chop_in_place (elements, front);
+            table.add (key (element), initial, function,
+                std::forward <decltype (element)> (element));
+        }
+        return std::move (table.entries());
+    }
+
+    template <class View, class KeyFunction, class State, class Function,
+        class Element = typename element <View>::type,
+        class Key = typename key <View, KeyFunction>::type>
+    inline typename result <View, KeyFunction, State>::type
+        parallel_aggregate (View elements, KeyFunction const & key,
+            State const & initial, Function const & function,
+            std::size_t thread_num)
+    {
+        std::vector <hash_table_detail::aggregate_table <Key, State>>
+            tables (thread_num);
+        partition_detail::for_each_partitioned <Key, Element> (
+            elements, thread_num, key,
+            [&] (std::size_t partition, std::size_t hash,
+                Key const & element_key, Element && element)
+            {
+                tables [partition].add (hash, element_key, initial, function,
+                    std::move (element));
+            });
+
+        typename result <View, KeyFunction, State>::type result;
+        for (auto & table : tables) {
+            if (result.empty())
+                result = std::move (table.entries());
+            else {
+                for (auto & entry : table.entries())
+                    result.push_back (std::move (entry));
+            }
+        }
+        return result;
+    }
+
+} // namespace hash_aggregate_detail
+
+namespace callable {
+
+    struct hash_aggregate {
+        template <class Range, class KeyFunction, class State,
+            class Function, class Enable =
+                typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, KeyFunction const & key,
+            State const & state, Function const & function) const
+        RETURNS (hash_aggregate_detail::aggregate (
+            range::view (std::forward <Range> (range), front),
+            key, state, function));
+    };
+
+    struct parallel_hash_aggregate {
+        template <class Range, class KeyFunction, class State,
+            class Function, class Enable =
+                typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, KeyFunction const & key,
+            State const & state, Function const & function,
+            std::size_t thread_num) const
+        RETURNS (hash_aggregate_detail::parallel_aggregate (
+            range::view (std::forward <Range> (range), front),
+            key, state, function, thread_num));
+    };
+
+} // namespace callable
+
+/** \brief
+Group the elements of a range by key, and fold the elements in each group.
+
+This is like fold(), but with one state for each distinct key.
+For each element, in order, the state for its key is replaced by
+<c>function (state, element)</c>.
+The state for a key starts as a copy of \a state when the key is first seen.
+\code
+// Compute the total amount per customer.
+auto totals = hash_aggregate (orders,
+    [] (order const & o) { return o.customer; },
+    0., [] (double total, order const & o) { return total + o.amount; });
+\endcode
+
+The states are kept in an open-addressing hash table with linear probing.
+The table stores the entries densely, in the order in which their keys first
+appeared, and a separate index with the hash values of the keys, so that
+probing does not touch the entries.
+Keys that are tuples are hashed with hash_range(); other keys with
+boost::hash.
+The key function may return a tuple of references into the element; the
+table then stores a tuple of values.
+
+The aggregation is eager, since no result is known before the whole range has
+been traversed.
+
+\param range The range to aggregate.
+    It is traversed once from the front.
+\param key The function that returns the key of an element.
+\param state The initial state for each key.
+\param function The function that folds an element into the state.
+\return A \c std::vector of \ref tuple objects with the key and the final
+    state, in the order in which the keys first appeared.
+*/
+static auto const hash_aggregate = callable::hash_aggregate();
+
+/** \brief
+Do the same as hash_aggregate(), on multiple threads.
+
+The calling thread traverses the range, computes and hashes the key of each
+element, and divides the elements into \a thread_num partitions by the hash
+values.
+Each partition is aggregated on its own thread into its own table, so the
+tables do not need locking.
+The keys and their hash values are sent along with the elements, so they are
+computed only once.
+This pays off when \a function is expensive compared to \a key and reading
+the range, or when there are many distinct keys.
+
+The elements and keys must be default-constructible and movable, and moving
+them must not throw, since they are sent to the worker threads in batches.
+\a function is called from multiple threads at once.
+The elements for one key are still folded in their original order.
+
+\param range The range to aggregate.
+\param key The function that returns the key of an element.
+\param state The initial state for each key.
+\param function The function that folds an element into the state.
+\param thread_num The number of worker threads and partitions.
+\return A \c std::vector of \ref tuple objects with the key and the final
+    state.
+    The keys are in the order in which they first appeared within each
+    partition, and the partitions are in order.
+*/
+static auto const parallel_hash_aggregate
+    = callable::parallel_hash_aggregate();
+
+} // namespace range
+
+#endif // RANGE_HASH_AGGREGATE_HPP_INCLUDED
@@ -0,0 +1,323 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define hash_join, which pairs up the elements of two ranges with equal keys.
+*/
+
+#ifndef RANGE_HASH_JOIN_HPP_INCLUDED
+#define RANGE_HASH_JOIN_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "tuple.hpp"
+#include "detail/hash_table.hpp"
+#include "detail/partition.hpp"
+
+namespace range {
+
+template <class Table, class ProbeView, class ProbeKey> class hash_join_range;
+
+namespace hash_join_operation {
+
+    struct hash_join_range_tag {};
+
+    template <class Table, class ProbeView, class ProbeKey>
+    inline auto implement_chop (hash_join_range_tag const & tag,
+        hash_join_range <Table, ProbeView, ProbeKey> && range,
+        direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
+} // namespace hash_join_operation
+
+template <class Table, class ProbeView, class ProbeKey>
+    struct tag_of_qualified <hash_join_range <Table, ProbeView, ProbeKey>>
+{ typedef hash_join_operation::hash_join_range_tag type; };
+
+namespace hash_join_detail {
+
+    template <class View> struct element
+    : std::decay <decltype (range::chop_in_place (
+        std::declval <View &>(), front))> {};
+
+    template <class View, class KeyFunction> struct key
+    : hash_table_detail::key_value <decltype (
+        std::declval <KeyFunction const &>() (
+            std::declval <typename element <View>::type const &>()))> {};
+
+    template <class BuildView, class BuildKey,
+        class Build = typename element <BuildView>::type,
+        class Key = typename key <BuildView, BuildKey>::type>
+    struct table
+    { typedef hash_table_detail::join_table <Key, Build> type; };
+
+    /// Put all elements of \a elements in \a table.
+    template <class Table, class View, class KeyFunction>
+        inline void build (Table & table, View & elements,
+            KeyFunction const & key)
+    {
+        while (!range::empty (elements, front)) {
+            auto && element = range::chop_in_place (elements, front);
+            table.add (key (element),
+                std::forward <decltype (element)> (element));
+        }
+    }
+
+} // namespace hash_join_detail
+
+/**
+Range that pairs each element of a probe range with the elements in a hash
+table that have the same key.
+It can only be traversed from the front with chop_in_place().
+*/
+template <class Table, class ProbeView, class ProbeKey> class hash_join_range {
+public:
+    typedef typename Table::row_type build_type;
+    typedef typename hash_join_detail::element <ProbeView>::type probe_type;
+
+    /**
+    The type of the elements.
+    The build element is a reference into the table, which stays alive as
+    long as any copy of the range does.
+    */
+    typedef tuple <build_type const &, probe_type> element_type;
+
+private:
+    std::shared_ptr <Table const> table_;
+    ProbeKey probe_key_;
+    // empty() may need to read ahead in the probe range to find a match.
+    mutable ProbeView probe_;
+    mutable boost::optional <probe_type> current_;
+    mutable std::size_t row_;
+
+    /// Make sure that row_ is a match for current_, if there is one.
+    void advance() const {
+        while (row_ == Table::no_row && !range::empty (probe_, front)) {
+            current_ = range::chop_in_place (probe_, front);
+            row_ = table_->find (probe_key_ (*current_));
+        }
+    }
+
+public:
+    hash_join_range (std::shared_ptr <Table const> table,
+        ProbeView probe, ProbeKey const & probe_key)
+    : table_ (std::move (table)), probe_key_ (probe_key),
+        probe_ (std::move (probe)), row_ (Table::no_row) {}
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const {
+        advance();
+        return row_ == Table::no_row;
+    }
+
+    element_type chop_in_place (direction::front) {
+        advance();
+        rime::assert_ (row_ != Table::no_row);
+        element_type result (table_->row (row_), *current_);
+        row_ = table_->next (row_);
+        return result;
+    }
+};
+
+namespace callable {
+
+    struct hash_join {
+    private:
+        template <class BuildView, class ProbeView,
+            class BuildKey, class ProbeKey,
+            class Table = typename hash_join_detail::table <
+                BuildView, BuildKey>::type>
+        static hash_join_range <Table, ProbeView, ProbeKey> apply (
+            BuildView build, ProbeView probe,
+            BuildKey const & build_key, ProbeKey const & probe_key)
+        {
+            std::shared_ptr <Table> table = std::make_shared <Table>();
+            hash_join_detail::build (*table, build, build_key);
+            return hash_join_range <Table, ProbeView, ProbeKey> (
+                std::move (table), std::move (probe), probe_key);
+        }
+
+    public:
+        template <class BuildRange, class ProbeRange,
+            class BuildKey, class ProbeKey, class Enable =
+                typename std::enable_if <is_range <BuildRange>::value
+                    && is_range <ProbeRange>::value>::type>
+        auto operator() (BuildRange && build, ProbeRange && probe,
+            BuildKey const & build_key, ProbeKey const & probe_key) const
+        RETURNS (apply (
+            range::view (std::forward <BuildRange> (build), front),
+            range::view (std::forward <ProbeRange> (probe), front),
+            build_key, probe_key));
+
+        template <class BuildRange, class ProbeRange, class Key,
+            class Enable = typename std::enable_if <
+                is_range <BuildRange>::value
+                && is_range <ProbeRange>::value>::type>
+        auto operator() (BuildRange && build, ProbeRange && probe,
+            Key const & key) const
+        RETURNS (apply (
+            range::view (std::forward <BuildRange> (build), front),
+            range::view (std::forward <ProbeRange> (probe), front),
+            key, key));
+    };
+
+    struct parallel_hash_join {
+    private:
+        template <class BuildView, class ProbeView,
+            class BuildKey, class ProbeKey,
+            class Build = typename hash_join_detail::element <BuildView>::type,
+            class Probe = typename hash_join_detail::element <ProbeView>::type,
+            class Key = typename hash_join_detail::key <
+                BuildView, BuildKey>::type,
+            class Table = hash_table_detail::join_table <Key, Build>>
+        static std::vector <tuple <Build, Probe>> apply (
+            BuildView build, ProbeView probe,
+            BuildKey const & build_key, ProbeKey const & probe_key,
+            std::size_t thread_num)
+        {
+            std::vector <Table> tables (thread_num);
+            partition_detail::for_each_partitioned <Key, Build> (
+                build, thread_num, build_key,
+                [&] (std::size_t partition, std::size_t hash,
+                    Key const & key, Build && element)
+                { tables [partition].add (hash, key, std::move (element)); });
+
+            // The probe keys are converted to the type of the build keys, so
+            // that they are hashed in the same way.
+            std::vector <std::vector <tuple <Build, Probe>>> results (
+                thread_num);
+            partition_detail::for_each_partitioned <Key, Probe> (
+                probe, thread_num, probe_key,
+                [&] (std::size_t partition, std::size_t hash,
+                    Key const & key, Probe && element)
+                {
+                    Table const & table = tables [partition];
+                    for (std::size_t row = table.find (hash, key);
+                            row != Table::no_row; row = table.next (row))
+                        results [partition].emplace_back (
+                            table.row (row), element);
+                });
+
+            std::vector <tuple <Build, Probe>> result;
+            for (auto & partition : results) {
+                if (result.empty())
+                    result = std::move (partition);
+                else {
+                    for (auto & pair : partition)
+                        result.push_back (std::move (pair));
+                }
+            }
+            return result;
+        }
+
+    public:
+        template <class BuildRange, class ProbeRange,
+            class BuildKey, class ProbeKey, class Enable =
+                typename std::enable_if <is_range <BuildRange>::value
+                    && is_range <ProbeRange>::value>::type>
+        auto operator() (BuildRange && build, ProbeRange && probe,
+            BuildKey const & build_key, ProbeKey const & probe_key,
+            std::size_t thread_num) const
+        RETURNS (apply (
+            range::view (std::forward <BuildRange> (build), front),
+            range::view (std::forward <ProbeRange> (probe), front),
+            build_key, probe_key, thread_num));
+    };
+
+} // namespace callable
+
+/** \brief
+Join two ranges on equal keys: return a lazy range with, for each element of
+\a probe, a pair with each element of \a build that has the same key.
+
+\a build is traversed first, eagerly, and its elements are stored in an
+open-addressing hash table with linear probing.
+The table stores the elements densely, in their original order, and a
+separate index with the hash values of the keys, so that probing does not
+touch the elements.
+\a probe is then traversed lazily, as the result is traversed.
+Keys that are tuples are hashed with hash_range(); other keys with
+boost::hash.
+The key functions may return tuples of references into the elements.
+Probe keys of a different type from the build keys are converted to the type
+of the build keys before they are hashed, so that, for example, a
+<c>char const *</c> finds a \c std::string.
+To pair each order with its customer, for example:
+\code
+auto pairs = hash_join (customers, orders,
+    [] (customer const & c) { return c.id; },
+    [] (order const & o) { return o.customer_id; });
+\endcode
+The smaller range should normally be \a build.
+
+\param build The range whose elements are stored in the hash table.
+\param probe The range that is traversed lazily.
+\param build_key The function that returns the key of an element of \a build.
+\param probe_key (Optional) The function that returns the key of an element
+    of \a probe.
+    If this is not given, \a build_key is used for both ranges.
+\return A range that can be traversed from the front with chop_in_place(),
+    with elements of type <c>tuple <Build const &, Probe></c>.
+    The references point into the hash table, which is kept alive by the
+    range.
+    The elements are in the order of \a probe, and then in the order of
+    \a build.
+*/
+static auto const hash_join = callable::hash_join();
+
+/** \brief
+Do the same as hash_join(), on multiple threads, and eagerly.
+
+Both ranges are divided into \a thread_num partitions by the hash values of
+their keys.
+The keys are computed and hashed once, on the calling thread, and sent to the
+worker threads along with the elements.
+Each partition of \a build is put in its own hash table on its own thread, and
+then each partition of \a probe is joined with the matching table on the same
+thread.
+The elements of both ranges and the keys must be default-constructible and
+movable, and moving them must not throw; the elements of \a build must also
+be copyable.
+
+\param build The range whose elements are stored in the hash tables.
+\param probe The other range.
+\param build_key The function that returns the key of an element of \a build.
+\param probe_key The function that returns the key of an element of
+    \a probe.
+\param thread_num The number of worker threads and partitions.
+\return A \c std::vector of \ref tuple objects with copies of the elements of
+    \a build and \a probe.
+    Within each partition, the order is as for hash_join(); the partitions are
+    in order.
+*/
+static auto const parallel_hash_join = callable::parallel_hash_join();
+
+} // namespace range
+
+#endif // RANGE_HASH_JOIN_HPP_INCLUDED
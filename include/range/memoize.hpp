@@ -0,0 +1,298 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define an adaptor that computes each element of a range at most once.
+*/
+
+#ifndef RANGE_MEMOIZE_HPP_INCLUDED
+#define RANGE_MEMOIZE_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <bitset>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "buffer.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+template <class Underlying, class Direction> class memoize_view;
+
+namespace memoize_operation {
+    struct memoize_view_tag {};
+} // namespace memoize_operation
+
+template <class Underlying, class Direction>
+    struct tag_of_qualified <memoize_view <Underlying, Direction>>
+{ typedef memoize_operation::memoize_view_tag type; };
+
+namespace memoize_detail {
+
+    /**
+    Storage for the elements at positions [start, start + Number) of a
+    memoize_view.
+    Each element is constructed only when it is first requested.
+    The chunks form a singly linked list, ordered by position.
+    Chunks are only created for positions that are visited, so dropping many
+    elements at once does not allocate chunks for the skipped positions.
+    */
+    template <class Element, std::size_t Number> class cache_chunk {
+        typedef typename std::aligned_storage <
+            sizeof (Element), alignof (Element)>::type storage_type;
+
+        std::size_t start_;
+        storage_type memory_ [Number];
+        std::bitset <Number> present_;
+        std::shared_ptr <cache_chunk> next_;
+
+        Element * element (std::size_t position)
+        { return reinterpret_cast <Element *> (&memory_ [position - start_]); }
+
+    public:
+        explicit cache_chunk (std::size_t start) : start_ (start) {}
+
+        cache_chunk (cache_chunk const &) = delete;
+        cache_chunk & operator= (cache_chunk const &) = delete;
+
+        ~cache_chunk() {
+            for (std::size_t index = 0; index != Number; ++ index)
+                if (present_ [index])
+                    element (start_ + index)->~Element();
+
+            // Destruct the rest of the list iteratively, not recursively, so
+            // that long lists do not overflow the stack.
+            std::shared_ptr <cache_chunk> next = std::move (next_);
+            while (next && next.use_count() == 1) {
+                std::shared_ptr <cache_chunk> after = std::move (next->next_);
+                next = std::move (after);
+            }
+        }
+
+        /// \return \c true iff the element at \a position has been computed.
+        bool has (std::size_t position) const
+        { return present_ [position - start_]; }
+
+        Element const & get (std::size_t position) {
+            assert (has (position));
+            return *element (position);
+        }
+
+        template <class Value>
+            Element const & set (std::size_t position, Value && value)
+        {
+            assert (!has (position));
+            new (element (position)) Element (std::forward <Value> (value));
+            // Only mark the element as present once it has been constructed.
+            present_.set (position - start_);
+            return *element (position);
+        }
+
+        /**
+        Return the chunk that contains \a position, starting at \a current.
+        If the chunk does not exist yet, insert it into the list.
+        */
+        static std::shared_ptr <cache_chunk> find (
+            std::shared_ptr <cache_chunk> current, std::size_t position)
+        {
+            assert (current->start_ <= position);
+            std::size_t start = position - position % Number;
+            while (current->start_ != start) {
+                if (!current->next_ || start < current->next_->start_) {
+                    std::shared_ptr <cache_chunk> inserted
+                        = std::make_shared <cache_chunk> (start);
+                    inserted->next_ = std::move (current->next_);
+                    current->next_ = std::move (inserted);
+                }
+                current = current->next_;
+            }
+            return current;
+        }
+    };
+
+} // namespace memoize_detail
+
+/**
+View that computes each element of the underlying view at most once.
+The elements are stored in chunks, which are shared between copies of the view.
+*/
+template <class Underlying, class Direction> class memoize_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+public:
+    typedef Underlying underlying_type;
+
+    typedef typename std::decay <decltype (range::first (
+        std::declval <Underlying const &>(), std::declval <Direction>()))
+        >::type element_type;
+
+private:
+    typedef memoize_detail::cache_chunk <element_type,
+            buffer_detail::compute_element_num <element_type, 0>::value>
+        chunk_type;
+
+    Underlying underlying_;
+    std::shared_ptr <chunk_type> chunk_;
+    std::size_t position_;
+
+    memoize_view (Underlying && underlying, Direction const & direction,
+        std::shared_ptr <chunk_type> const & chunk, std::size_t position)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (std::move (underlying)),
+        chunk_ (chunk_type::find (chunk, position)), position_ (position) {}
+
+public:
+    memoize_view (Underlying const & underlying, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (underlying),
+        chunk_ (std::make_shared <chunk_type> (0)), position_ (0) {}
+
+    memoize_view (Underlying && underlying, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        underlying_ (std::move (underlying)),
+        chunk_ (std::make_shared <chunk_type> (0)), position_ (0) {}
+
+    /// \return The part of the underlying range that has not been visited.
+    Underlying const & underlying() const { return underlying_; }
+
+private:
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (underlying_,
+        this->direction_must_be_equal (direction)));
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    auto size (Direction const & direction) const
+    RETURNS (range::size (underlying_,
+        this->direction_must_be_equal (direction)));
+
+    element_type const & first (Direction const & direction) const {
+        rime::assert_ (!range::empty (underlying_, direction));
+        if (chunk_->has (position_))
+            return chunk_->get (position_);
+        else
+            return chunk_->set (position_,
+                range::first (underlying_, direction));
+    }
+
+    memoize_view drop_one (Direction const & direction) const {
+        rime::assert_ (!range::empty (underlying_, direction));
+        return memoize_view (range::drop (underlying_, direction),
+            direction, chunk_, position_ + 1);
+    }
+
+    template <class Increment, class Enable = decltype (range::drop (
+        std::declval <Underlying const &>(), std::declval <Increment>(),
+        std::declval <Direction>()))>
+    memoize_view drop (Increment const & increment,
+        Direction const & direction) const
+    {
+        std::size_t increment_value = increment;
+        return memoize_view (range::drop (underlying_, increment, direction),
+            direction, chunk_, position_ + increment_value);
+    }
+};
+
+namespace callable {
+
+    struct memoize {
+    private:
+        struct dispatch {
+            template <class View, class Direction>
+                auto operator() (View && view, Direction const & direction)
+                const
+            RETURNS (memoize_view <typename std::decay <View>::type,
+                Direction> (std::forward <View> (view), direction));
+        };
+
+    public:
+        template <class Range, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            direction));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            range::default_direction (range)));
+    };
+
+} // namespace callable
+
+/**
+Return a view of a range that computes each element at most once.
+
+Some views compute their elements every time first() is called.
+For example, a \ref transform view calls its function every time.
+Algorithms that call first() more than once on the same position, or that
+traverse copies of a view, then compute elements more than once.
+If computing an element is expensive (e.g. parsing or decoding), memoize can be
+used to cache the elements.
+
+\code
+auto parsed = memoize (transform (lines, parse));
+// parse is called once for each line, even though parsed is traversed twice.
+auto total = fold (0, parsed, add_size());
+bool same = equal (parsed, expected);
+\endcode
+
+Copies of the view share the cache, so an element that one copy has computed is
+not computed again by another copy.
+The elements are stored in chunks, like in \ref buffer.
+When all copies of the view have moved past a chunk, the chunk is deallocated.
+As with \ref buffer, the view is not thread-safe: copies that share a cache
+must not be used from different threads at the same time.
+
+The elements are the decayed type of the elements of the underlying range.
+first() returns a const reference to the element in the cache, so it does not
+copy the element.
+The reference is valid as long as a copy of the view exists that has not moved
+past the element.
+
+The underlying view must be copyable, and dropping elements from it must return
+the same type.
+The view supports only the one direction it was constructed with.
+If the underlying view has a size, then so does the result.
+
+\param range The range to memoize.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const memoize = callable::memoize();
+
+} // namespace range
+
+#endif // RANGE_MEMOIZE_HPP_INCLUDED
@@ -0,0 +1,284 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define an adaptor that merges a number of sorted ranges into one sorted range.
+*/
+
+#ifndef RANGE_MERGE_HPP_INCLUDED
+#define RANGE_MERGE_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/returns.hpp"
+#include "utility/assignable.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "for_each.hpp"
+
+namespace range {
+
+template <class View, class Less> class merge_view;
+
+namespace merge_operation {
+    struct merge_view_tag {};
+} // namespace merge_operation
+
+template <class View, class Less>
+    struct tag_of_qualified <merge_view <View, Less>>
+{ typedef merge_operation::merge_view_tag type; };
+
+namespace merge_detail {
+
+    struct less {
+        template <class Left, class Right>
+        auto operator() (Left && left, Right && right) const
+        RETURNS (std::forward <Left> (left) < std::forward <Right> (right));
+    };
+
+    template <class View> struct collect {
+        std::vector <View> * sources;
+
+        template <class Range> void operator() (Range && range) const {
+            sources->push_back (
+                View (range::view (std::forward <Range> (range))));
+        }
+    };
+
+    template <class Ranges> struct source_type {
+        typedef typename std::decay <decltype (range::view (range::first (
+            std::declval <Ranges>())))>::type type;
+    };
+
+} // namespace merge_detail
+
+/**
+View that merges a number of sorted views into one sorted view.
+
+The current element of each view is kept in a loser tree (a kind of tournament
+tree).
+The root holds the view with the smallest first element.
+Each of the other nodes holds the view that lost the comparison at that node.
+After an element is taken, the view it came from only has to be compared with
+the losers on the path from its leaf to the root.
+Finding the next element therefore takes about log2 (k) comparisons for k
+views.
+
+This is a homogeneous range that can only be traversed from the front.
+It is cheapest to traverse it with chop_in_place(), which updates the tree in
+place.
+drop() copies all underlying views.
+*/
+template <class View, class Less> class merge_view {
+    static_assert (is_view <View, direction::front>::value,
+        "The underlying ranges must be views from the front.");
+public:
+    typedef decltype (range::first (
+        std::declval <View const &>(), front)) element_type;
+
+private:
+    typedef decltype (range::chop_in_place (
+        std::declval <View &>(), front)) chop_type;
+
+    std::vector <View> sources_;
+    /**
+    tree_ [0] is the index of the view with the smallest first element.
+    tree_ [node] for 0 < node < k contains the loser at that node.
+    The leaves, at k <= node < 2k, are implicit: leaf node contains view
+    node - k.
+    */
+    std::vector <std::size_t> tree_;
+    // The comparison function is not necessarily assignable.
+    utility::assignable <Less> less_;
+
+    /**
+    \return \c true iff the first element of view \a left should come before
+    the first element of view \a right.
+    Empty views come last.
+    Equal elements are ordered by the index of their views, so that the merge
+    is stable.
+    */
+    bool beats (std::size_t left, std::size_t right) const {
+        if (range::empty (sources_ [left], front))
+            return false;
+        if (range::empty (sources_ [right], front))
+            return true;
+        if (left < right)
+            return !less_.content() (range::first (sources_ [right], front),
+                range::first (sources_ [left], front));
+        else
+            return less_.content() (range::first (sources_ [left], front),
+                range::first (sources_ [right], front));
+    }
+
+    /**
+    Fill in the losers in the subtree at \a node.
+    \return The index of the winner of the subtree.
+    */
+    std::size_t build (std::size_t node) {
+        std::size_t k = sources_.size();
+        if (node >= k)
+            return node - k;
+        std::size_t left = build (2 * node);
+        std::size_t right = build (2 * node + 1);
+        if (beats (left, right)) {
+            tree_ [node] = right;
+            return left;
+        } else {
+            tree_ [node] = left;
+            return right;
+        }
+    }
+
+    /**
+    Restore the tree after the first element of view \a current has been
+    removed.
+    */
+    void replay (std::size_t current) {
+        for (std::size_t node = (current + sources_.size()) / 2; node != 0;
+            node /= 2)
+        {
+            if (beats (tree_ [node], current))
+                std::swap (tree_ [node], current);
+        }
+        tree_ [0] = current;
+    }
+
+public:
+    merge_view (std::vector <View> sources, Less const & less)
+    : sources_ (std::move (sources)), tree_ (sources_.size()), less_ (less)
+    {
+        if (!sources_.empty())
+            tree_ [0] = build (1);
+    }
+
+    merge_view (std::vector <View> sources, Less && less)
+    : sources_ (std::move (sources)), tree_ (sources_.size()),
+        less_ (std::move (less))
+    {
+        if (!sources_.empty())
+            tree_ [0] = build (1);
+    }
+
+    /// \return The underlying views, in their current state.
+    std::vector <View> const & sources() const { return sources_; }
+
+private:
+    friend class helper::member_access;
+
+    bool empty (direction::front) const {
+        return sources_.empty()
+            || range::empty (sources_ [tree_ [0]], front);
+    }
+
+    element_type first (direction::front) const {
+        rime::assert_ (!empty (front));
+        return range::first (sources_ [tree_ [0]], front);
+    }
+
+    merge_view drop_one (direction::front) const {
+        rime::assert_ (!empty (front));
+        merge_view result (*this);
+        std::size_t winner = result.tree_ [0];
+        result.sources_ [winner] = range::drop (
+            std::move (result.sources_ [winner]), front);
+        result.replay (winner);
+        return result;
+    }
+
+    chop_type chop_in_place (direction::front) {
+        rime::assert_ (!empty (front));
+        std::size_t winner = tree_ [0];
+        chop_type result = range::chop_in_place (sources_ [winner], front);
+        replay (winner);
+        return static_cast <chop_type> (result);
+    }
+};
+
+namespace callable {
+
+    struct merge {
+    private:
+        template <class Ranges, class Less,
+            class View = typename merge_detail::source_type <Ranges>::type,
+            class Result = merge_view <View, typename std::decay <Less>::type>>
+        static Result make (Ranges && ranges, Less && less) {
+            std::vector <View> sources;
+            range::for_each (std::forward <Ranges> (ranges),
+                merge_detail::collect <View> {&sources});
+            return Result (std::move (sources), std::forward <Less> (less));
+        }
+
+    public:
+        template <class Ranges, class Less, class Enable =
+            typename std::enable_if <is_range <Ranges>::value>::type>
+        auto operator() (Ranges && ranges, Less && less) const
+        RETURNS (make (std::forward <Ranges> (ranges),
+            std::forward <Less> (less)));
+
+        template <class Ranges, class Enable =
+            typename std::enable_if <is_range <Ranges>::value>::type>
+        auto operator() (Ranges && ranges) const
+        RETURNS (make (std::forward <Ranges> (ranges), merge_detail::less()));
+    };
+
+} // namespace callable
+
+/** \brief
+Merge a number of sorted ranges into one sorted range.
+
+The elements are produced lazily, so that the inputs can be streams, like
+\ref buffer's of sorted data read from files.
+Only the current element of each input is examined.
+Finding each element takes about log2 (k) comparisons for k inputs, using a
+loser tree.
+The merge is stable: equal elements from earlier inputs come first.
+
+\code
+std::vector <std::vector <int>> inputs = {{1, 4, 7}, {2, 5}, {3, 6, 8}};
+auto merged = merge (inputs);
+// merged contains 1, 2, 3, 4, 5, 6, 7, 8.
+\endcode
+
+The inputs are given as a range of ranges.
+This can be a container of containers, or of views, like a
+std::vector <buffer <int>>.
+To merge a fixed number of ranges, use, for example, std::tie (r1, r2, r3).
+The views of the inputs must all have the same type, and they are traversed
+from the front.
+The inputs are converted into views when merge is called.
+If they are containers, they must therefore remain alive while the result is
+in use.
+
+The result is a homogeneous range that can only be traversed from the front.
+Traversing it with chop_in_place(), as RANGE_FOR_EACH does, is efficient;
+drop() copies the views of all inputs.
+
+\param ranges The range of sorted ranges to merge.
+\param less (Optional) The comparison function.
+    The inputs must be sorted according to it.
+    By default, operator< is used.
+*/
+static auto const merge = callable::merge();
+
+} // namespace range
+
+#endif // RANGE_MERGE_HPP_INCLUDED
@@ -0,0 +1,254 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define parallel_sort, which sorts a random-access range on multiple threads.
+*/
+
+#ifndef RANGE_PARALLEL_SORT_HPP_INCLUDED
+#define RANGE_PARALLEL_SORT_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core.hpp"
+#include "sort.hpp"
+
+namespace range {
+
+namespace parallel_sort_detail {
+
+    /// Ranges smaller than this are sorted on the calling thread.
+    static constexpr std::size_t sequential_threshold = 1 << 13;
+    /// The number of buckets per thread, for load balancing.
+    static constexpr std::size_t buckets_per_thread = 4;
+    /// The number of samples per bucket.
+    static constexpr std::size_t oversampling = 16;
+
+    /**
+    Call function (index) for each index in [0, thread_num), each on its own
+    thread, one of which is the calling thread.
+    If any call throws, the first exception is rethrown after all threads have
+    finished.
+    */
+    template <class Function>
+        inline void run (std::size_t thread_num, Function const & function)
+    {
+        std::vector <std::exception_ptr> exceptions (thread_num);
+        auto run_one = [&function, &exceptions] (std::size_t index) {
+            try {
+                function (index);
+            } catch (...) {
+                exceptions [index] = std::current_exception();
+            }
+        };
+
+        std::vector <std::thread> threads;
+        threads.reserve (thread_num - 1);
+        try {
+            for (std::size_t index = 1; index < thread_num; ++ index)
+                threads.emplace_back (run_one, index);
+        } catch (...) {
+            for (std::thread & thread : threads)
+                thread.join();
+            throw;
+        }
+        run_one (0);
+        for (std::thread & thread : threads)
+            thread.join();
+
+        for (std::exception_ptr const & exception : exceptions)
+            if (exception)
+                std::rethrow_exception (exception);
+    }
+
+    /**
+    Sort with a sample sort.
+    Splitters are chosen from a sorted sample, and each element is assigned to
+    a bucket between two splitters, in parallel.
+    The elements are then swapped into their buckets, and the buckets are
+    sorted in parallel.
+    Only positions are sampled, classified and permuted, so elements are
+    never copied.
+    */
+    template <class Sequence> inline void sample_sort (
+        Sequence const & s, std::size_t thread_num)
+    {
+        std::size_t const size = s.size();
+        if (thread_num <= 1 || size < sequential_threshold) {
+            sort_detail::introsort (s, 0, size,
+                sort_detail::depth_limit (size));
+            return;
+        }
+
+        // Make sure that there are enough elements to sample.
+        thread_num = std::min (thread_num,
+            size / (buckets_per_thread * oversampling));
+        std::size_t const bucket_num = buckets_per_thread * thread_num;
+
+        // Take one random sample from each of sample_num equal parts.
+        std::size_t const sample_num = bucket_num * oversampling;
+        std::size_t const step = size / sample_num;
+        std::vector <std::size_t> sample (sample_num);
+        std::minstd_rand random;
+        for (std::size_t i = 0; i != sample_num; ++ i)
+            sample [i] = i * step + random() % step;
+        std::sort (sample.begin(), sample.end(),
+            [&s] (std::size_t left, std::size_t right)
+            { return s.is_less (left, right); });
+
+        std::vector <std::size_t> splitters (bucket_num - 1);
+        for (std::size_t b = 0; b != bucket_num - 1; ++ b)
+            splitters [b] = sample [(b + 1) * oversampling];
+
+        // Classify the elements in blocks, one per thread, and count the
+        // number of elements in each bucket per block.
+        std::size_t const block_size = (size + thread_num - 1) / thread_num;
+        std::vector <std::uint32_t> buckets (size);
+        std::vector <std::size_t> counts (thread_num * bucket_num, 0);
+        run (thread_num, [&] (std::size_t block) {
+            std::size_t const begin = std::min (block * block_size, size);
+            std::size_t const end = std::min (begin + block_size, size);
+            std::size_t * block_counts = &counts [block * bucket_num];
+            for (std::size_t i = begin; i != end; ++ i) {
+                // Find the first splitter that is greater than the element.
+                std::size_t low = 0;
+                std::size_t high = splitters.size();
+                while (low != high) {
+                    std::size_t middle = low + (high - low) / 2;
+                    if (s.is_less (i, splitters [middle]))
+                        high = middle;
+                    else
+                        low = middle + 1;
+                }
+                buckets [i] = std::uint32_t (low);
+                ++ block_counts [low];
+            }
+        });
+
+        // Turn the counts into the positions that each block writes to in
+        // each bucket.
+        std::vector <std::size_t> bucket_begins (bucket_num + 1);
+        std::size_t total = 0;
+        for (std::size_t b = 0; b != bucket_num; ++ b) {
+            bucket_begins [b] = total;
+            for (std::size_t block = 0; block != thread_num; ++ block) {
+                std::size_t & count = counts [block * bucket_num + b];
+                std::size_t const block_count = count;
+                count = total;
+                total += block_count;
+            }
+        }
+        bucket_begins [bucket_num] = size;
+
+        std::vector <std::size_t> order (size);
+        run (thread_num, [&] (std::size_t block) {
+            std::size_t const begin = std::min (block * block_size, size);
+            std::size_t const end = std::min (begin + block_size, size);
+            std::size_t * block_positions = &counts [block * bucket_num];
+            for (std::size_t i = begin; i != end; ++ i)
+                order [block_positions [buckets [i]] ++] = i;
+        });
+        std::vector <std::uint32_t>().swap (buckets);
+
+        sort_detail::permute (s, order);
+
+        std::atomic <std::size_t> next_bucket (0);
+        run (thread_num, [&] (std::size_t) {
+            std::size_t b;
+            while ((b = next_bucket ++) < bucket_num) {
+                std::size_t const begin = bucket_begins [b];
+                std::size_t const end = bucket_begins [b + 1];
+                sort_detail::introsort (s, begin, end,
+                    sort_detail::depth_limit (end - begin));
+            }
+        });
+    }
+
+} // namespace parallel_sort_detail
+
+namespace callable {
+
+    struct parallel_sort {
+    private:
+        template <class View, class Less> static void apply (
+            View const & view, std::size_t thread_num, Less const & less)
+        {
+            parallel_sort_detail::sample_sort (
+                sort_detail::make_sequence (view, less), thread_num);
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t thread_num,
+            Less const & less) const
+        {
+            apply (range::view (std::forward <Range> (range), front),
+                thread_num, less);
+        }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t thread_num) const {
+            apply (range::view (std::forward <Range> (range), front),
+                thread_num, sort_detail::less());
+        }
+    };
+
+} // namespace callable
+
+/** \brief
+Sort the elements of a random-access range in place, on multiple threads.
+
+This is a sample sort.
+A sorted sample of the elements is used to choose splitters that divide the
+elements into a number of buckets per thread.
+The threads classify the elements into buckets, the elements are swapped into
+their buckets, and the threads then sort the buckets with the same algorithm
+as sort().
+As with sort(), elements are only compared and swapped, so that a zip() of
+containers can be sorted without materialising tuples.
+The swapping into buckets happens on the calling thread.
+
+Small ranges are sorted on the calling thread.
+Many elements that are equal to a splitter end up in one bucket, which then
+reduces the parallelism.
+
+The same requirements as for sort() hold.
+In addition, at() on the range and the comparison function must be safe to
+call from multiple threads at once, and swapping different elements on
+different threads must be safe.
+The sort is not stable.
+
+\param range The range to sort.
+\param thread_num The number of threads to use, including the calling thread.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+*/
+static auto const parallel_sort = callable::parallel_sort();
+
+} // namespace range
+
+#endif // RANGE_PARALLEL_SORT_HPP_INCLUDED
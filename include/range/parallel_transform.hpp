@@ -0,0 +1,364 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define parallel_transform, which applies a function to the elements of a range
+on worker threads, and returns the results in order.
+*/
+
+#ifndef RANGE_PARALLEL_TRANSFORM_HPP_INCLUDED
+#define RANGE_PARALLEL_TRANSFORM_HPP_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+
+namespace range {
+
+template <class Underlying, class Function> class parallel_transform_range;
+
+namespace parallel_transform_operation {
+
+    struct parallel_transform_range_tag {};
+
+    template <class Underlying, class Function>
+    inline auto implement_chop (parallel_transform_range_tag const & tag,
+        parallel_transform_range <Underlying, Function> && range,
+        direction::front const & direction)
+    RETURNS (helper::chop_by_chop_in_place (std::move (range), direction));
+
+} // namespace parallel_transform_operation
+
+template <class Underlying, class Function>
+    struct tag_of_qualified <parallel_transform_range <Underlying, Function>>
+{ typedef parallel_transform_operation::parallel_transform_range_tag type; };
+
+namespace parallel_transform_detail {
+
+    /**
+    State shared between the worker threads and the consumer.
+
+    Each element of the underlying range gets a sequence number when a worker
+    takes it.
+    Its result goes into slot (number % window size).
+    Workers only take an element if its slot has been emptied by the
+    consumer, so that at most "window size" results are in flight.
+    The consumer waits for the slot of the next result to be filled.
+    */
+    template <class Underlying, class Function> class state {
+    public:
+        typedef typename std::decay <decltype (range::chop_in_place (
+            std::declval <Underlying &>(), front))>::type element_type;
+        typedef typename std::decay <decltype (std::declval <Function const &>()
+            (std::declval <element_type>()))>::type result_type;
+
+    private:
+        struct slot {
+            boost::optional <result_type> result;
+            std::exception_ptr exception;
+            bool ready;
+
+            slot() : ready (false) {}
+        };
+
+        std::mutex mutex_;
+        std::condition_variable worker_condition_;
+        std::condition_variable consumer_condition_;
+
+        Underlying underlying_;
+        Function const function_;
+
+        std::vector <slot> slots_;
+        /// The sequence number of the next element to be taken from the
+        /// underlying range.
+        std::size_t next_input_;
+        /// The sequence number of the next result for the consumer.
+        std::size_t next_output_;
+        /// Whether the underlying range is exhausted, or threw an exception.
+        bool input_finished_;
+        bool stop_;
+
+        std::vector <std::thread> threads_;
+
+        bool can_take_input() const {
+            return !input_finished_
+                && next_input_ - next_output_ < slots_.size();
+        }
+
+        slot & next_slot() { return slots_ [next_output_ % slots_.size()]; }
+
+        bool output_available() {
+            return next_slot().ready
+                || (input_finished_ && next_output_ == next_input_);
+        }
+
+        void work() {
+            std::unique_lock <std::mutex> lock (mutex_);
+            while (true) {
+                worker_condition_.wait (lock,
+                    [this] { return stop_ || can_take_input(); });
+                if (stop_)
+                    return;
+
+                // Take an element from the underlying range.
+                // This is done under the lock, since it is a single-pass
+                // range.
+                boost::optional <element_type> element;
+                std::exception_ptr exception;
+                try {
+                    if (range::empty (underlying_, front)) {
+                        input_finished_ = true;
+                        consumer_condition_.notify_all();
+                        continue;
+                    }
+                    element = range::chop_in_place (underlying_, front);
+                } catch (...) {
+                    exception = std::current_exception();
+                    input_finished_ = true;
+                }
+                std::size_t const number = next_input_ ++;
+
+                // Apply the function without the lock.
+                boost::optional <result_type> result;
+                if (element) {
+                    lock.unlock();
+                    try {
+                        result = function_ (std::move (*element));
+                    } catch (...) {
+                        exception = std::current_exception();
+                    }
+                    lock.lock();
+                }
+
+                slot & destination = slots_ [number % slots_.size()];
+                destination.result = std::move (result);
+                destination.exception = exception;
+                destination.ready = true;
+                if (number == next_output_)
+                    consumer_condition_.notify_all();
+            }
+        }
+
+    public:
+        template <class Underlying_, class Function_>
+            state (Underlying_ && underlying, Function_ && function,
+                std::size_t thread_num, std::size_t window_size)
+        : underlying_ (std::forward <Underlying_> (underlying)),
+            function_ (std::forward <Function_> (function)),
+            slots_ (window_size), next_input_ (0), next_output_ (0),
+            input_finished_ (false), stop_ (false)
+        {
+            rime::assert_ (thread_num != 0);
+            rime::assert_ (window_size != 0);
+            threads_.reserve (thread_num);
+            try {
+                for (std::size_t i = 0; i != thread_num; ++ i)
+                    threads_.emplace_back ([this] { work(); });
+            } catch (...) {
+                stop();
+                throw;
+            }
+        }
+
+        ~state() { stop(); }
+
+        /// Discard all results in flight, and wait for the threads to finish.
+        void stop() {
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                stop_ = true;
+            }
+            worker_condition_.notify_all();
+            for (std::thread & thread : threads_)
+                thread.join();
+            threads_.clear();
+        }
+
+        bool empty() {
+            std::unique_lock <std::mutex> lock (mutex_);
+            consumer_condition_.wait (lock,
+                [this] { return output_available(); });
+            return !next_slot().ready;
+        }
+
+        result_type chop() {
+            std::unique_lock <std::mutex> lock (mutex_);
+            consumer_condition_.wait (lock,
+                [this] { return output_available(); });
+            slot & current = next_slot();
+            rime::assert_ (current.ready);
+
+            boost::optional <result_type> result = std::move (current.result);
+            std::exception_ptr exception = current.exception;
+            current.result = boost::none;
+            current.exception = std::exception_ptr();
+            current.ready = false;
+            ++ next_output_;
+            lock.unlock();
+            // A slot has become free.
+            worker_condition_.notify_one();
+
+            if (exception)
+                std::rethrow_exception (exception);
+            return std::move (*result);
+        }
+    };
+
+} // namespace parallel_transform_detail
+
+/**
+Single-pass range with the results of a function applied to the elements of
+an underlying range on worker threads.
+It owns the worker threads, which are stopped when it is destructed.
+It is noncopyable, but movable.
+*/
+template <class Underlying, class Function> class parallel_transform_range {
+    typedef parallel_transform_detail::state <Underlying, Function> state_type;
+
+    std::unique_ptr <state_type> state_;
+
+public:
+    typedef typename state_type::result_type result_type;
+
+    template <class Underlying_, class Function_>
+        parallel_transform_range (Underlying_ && underlying,
+            Function_ && function, std::size_t thread_num,
+            std::size_t window_size)
+    : state_ (new state_type (std::forward <Underlying_> (underlying),
+        std::forward <Function_> (function), thread_num, window_size)) {}
+
+    parallel_transform_range (parallel_transform_range const &) = delete;
+    parallel_transform_range (parallel_transform_range &&) = default;
+
+    parallel_transform_range & operator = (parallel_transform_range const &)
+        = delete;
+    parallel_transform_range & operator = (parallel_transform_range &&)
+        = default;
+
+private:
+    friend class helper::member_access;
+
+    // The state is behind a pointer, so that empty() can wait for the next
+    // result.
+    bool empty (direction::front) const { return state_->empty(); }
+
+    result_type chop_in_place (direction::front) { return state_->chop(); }
+};
+
+namespace callable {
+
+    struct parallel_transform {
+    private:
+        template <class View, class Function>
+            static parallel_transform_range <typename std::decay <View>::type,
+                typename std::decay <Function>::type>
+            make (View && view, Function && function, std::size_t thread_num,
+                std::size_t window_size)
+        {
+            return parallel_transform_range <
+                typename std::decay <View>::type,
+                typename std::decay <Function>::type> (
+                    std::forward <View> (view),
+                    std::forward <Function> (function),
+                    thread_num, window_size);
+        }
+
+    public:
+        template <class Range, class Function, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, Function && function,
+            std::size_t thread_num, std::size_t window_size) const
+        RETURNS (make (range::view (std::forward <Range> (range), front),
+            std::forward <Function> (function), thread_num, window_size));
+
+        template <class Range, class Function, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, Function && function,
+            std::size_t thread_num) const
+        RETURNS (make (range::view (std::forward <Range> (range), front),
+            std::forward <Function> (function), thread_num, 4 * thread_num));
+    };
+
+} // namespace callable
+
+/** \brief
+Apply a function to the elements of a range on worker threads, and return a
+range with the results in the original order.
+
+This is like transform(), but it is useful when the function is expensive,
+for example decompression or parsing.
+Worker threads take elements from the underlying range one at a time, apply
+the function without holding a lock, and put the result into a bounded
+reordering window.
+The consumer receives the results in the order of the underlying range.
+When the window is full, the workers wait for the consumer, so that memory use
+is bounded even if the underlying range is infinite.
+
+\code
+auto records = parallel_transform (make_buffer (read_file ("data")),
+    parse_record, 4);
+RANGE_FOR_EACH (record, records)
+    ...
+\endcode
+
+The underlying range is traversed from the front with chop_in_place(), always
+while holding a lock, so it can be a single-pass range, like a \ref buffer.
+It is traversed ahead of the consumer by up to \a window_size elements.
+Elements are copied or moved out of it, so they must not refer to memory that
+chop_in_place() invalidates.
+
+The function is called concurrently from multiple threads, on a const
+reference.
+If it throws an exception, then the exception is rethrown from
+chop_in_place() on the result, at the position of the element.
+If the underlying range throws an exception, it is rethrown at that position,
+and the range then ends.
+
+The result is a single-pass range that implements empty() and
+chop_in_place().
+It is noncopyable, but movable.
+It owns the worker threads; when it is destructed, results that have not been
+consumed are discarded, and the threads are joined.
+
+\param range The range to read elements from.
+    The worker threads keep reading from a view of it, so a container must
+    outlive the result.
+\param function The function to apply to each element.
+\param thread_num The number of worker threads.
+\param window_size (optional) The maximum number of elements that have been
+    taken from the underlying range but not consumed.
+    This must be at least 1.
+    By default, it is four times \a thread_num.
+*/
+static auto const parallel_transform = callable::parallel_transform();
+
+} // namespace range
+
+#endif // RANGE_PARALLEL_TRANSFORM_HPP_INCLUDED
@@ -0,0 +1,142 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Allow C++ code called from Python to run without holding the global
+interpreter lock.
+*/
+
+#ifndef RANGE_PYTHON_GIL_HPP_INCLUDED
+#define RANGE_PYTHON_GIL_HPP_INCLUDED
+
+// Include the Python C API, safely.
+#include <boost/python/detail/wrap_python.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "range/core.hpp"
+#include "range/python/range.hpp"
+
+namespace range { namespace python {
+
+    /** \brief
+    Release the global interpreter lock (GIL) for the lifetime of this object.
+
+    The GIL is reacquired when this object is destructed, also when an
+    exception is thrown.
+    While the GIL is released, no Python objects may be touched, not even to
+    change their reference count.
+    This includes python_range objects.
+    */
+    class gil_release : boost::noncopyable {
+        PyThreadState * state_;
+    public:
+        gil_release() : state_ (PyEval_SaveThread()) {}
+        ~gil_release() { PyEval_RestoreThread (state_); }
+    };
+
+    namespace detail {
+
+        template <class Element, class Range> inline
+            void copy_elements (std::vector <Element> & result, Range range)
+        {
+            while (!::range::empty (range))
+                result.push_back (::range::chop_in_place (range));
+        }
+
+        // The element type can be read from a buffer: use it if it is there.
+        template <class Element, class Range> inline
+            void materialise (std::vector <Element> & result,
+                Range const & range, std::true_type)
+        {
+            if (range.is_contiguous()) {
+                auto view = range.contiguous_view();
+                result.assign (view.begin(), view.end());
+            } else
+                copy_elements (result, range);
+        }
+
+        // The element type cannot be read from a buffer.
+        template <class Element, class Range> inline
+            void materialise (std::vector <Element> & result,
+                Range const & range, std::false_type)
+        { copy_elements (result, range); }
+
+    } // namespace detail
+
+    /** \brief
+    Copy the elements of a python_range into a std::vector.
+
+    This requires the GIL.
+    The result contains only C++ objects, so it can be used after the GIL has
+    been released.
+    If the Python object supports the buffer protocol with the right element
+    type (see python_range), the elements are copied in one go.
+
+    \tparam Element The element type of the vector.
+    \param range The range to copy the elements from.
+    */
+    template <class Element, class ... Types> inline
+        std::vector <Element> materialise (python_range <Types ...> range)
+    {
+        std::vector <Element> result;
+        detail::materialise (result, range,
+            std::integral_constant <bool,
+                detail::buffer_element_of <Types ...>::kind
+                    != detail::buffer_kind::none>());
+        return result;
+    }
+
+    /** \brief
+    Call a function with the GIL released, and return its result.
+
+    The GIL is reacquired before this returns, also if the function throws an
+    exception.
+    The function and its arguments must not refer to Python objects.
+    Therefore, convert any Python input first, for example with materialise().
+    The result of the function is converted to Python after the GIL has been
+    reacquired, by Boost.Python.
+
+    For example:
+    \code
+    double sum (python_range <double> r) {
+        std::vector <double> values = python::materialise <double> (r);
+        return python::call_without_gil ([&values]() {
+            return range::fold (0., values, std::plus <double>());
+        });
+    }
+    \endcode
+
+    This allows multithreaded Python programs to run several C++ computations
+    at the same time.
+    */
+    template <class Function, class ... Arguments> inline
+        auto call_without_gil (Function && function, Arguments && ... arguments)
+    -> decltype (std::forward <Function> (function) (
+        std::forward <Arguments> (arguments) ...))
+    {
+        gil_release release;
+        return std::forward <Function> (function) (
+            std::forward <Arguments> (arguments) ...);
+    }
+
+}} // namespace range::python
+
+#endif // RANGE_PYTHON_GIL_HPP_INCLUDED
@@ -24,12 +24,15 @@ Expose views as Python iterators.
 // Include the Python C API, safely.
 #include <boost/python/detail/wrap_python.hpp>
 
+#include <cstddef>
 #include <type_traits>
 
 #include <boost/python/object.hpp>
+#include <boost/python/list.hpp>
 #include <boost/python/class.hpp>
 #include <boost/python/return_arg.hpp>
 #include <boost/python/errors.hpp>
+#include <boost/python/handle.hpp>
 #include <boost/python/manage_new_object.hpp>
 #include <boost/python/to_python_converter.hpp>
 #include <boost/python/errors.hpp>
@@ -48,6 +51,20 @@ namespace range { namespace python {
 
     The underlying range must implement \c empty() and \c chop_in_place().
 
+    Each call to \c next() from Python goes through the Python method call
+    machinery.
+    To traverse a long range faster, Python code can call
+    \c next_batch(n) to retrieve elements in blocks, for example:
+    \code
+    iterator = iter (get_range())
+    while True:
+        batch = iterator.next_batch (1024)
+        if not batch:
+            break
+        for element in batch:
+            ...
+    \endcode
+
     If you want to use a full-fledged container, instead of using this, see
     http://www.boost.org/doc/libs/release/libs/python/doc/v2/indexing.html
     */
@@ -87,11 +104,48 @@ namespace range { namespace python {
             return boost::python::object (chop_in_place (range));
         }
 
+        /** \brief
+        Return a Python list with the next \a maximum elements of the view,
+        or fewer if the view runs out, and move past them.
+
+        At the end of the view, an empty list is returned; StopIteration is
+        not raised.
+        The elements are converted and appended to the list in C++, so that
+        the cost of a Python call is paid only once for each batch.
+        */
+        boost::python::list next_batch (std::size_t maximum) {
+            boost::python::list result;
+            for (; maximum != 0 && !empty (range); -- maximum) {
+                boost::python::object element = chop_in_place (range);
+                // Avoid calling the Python method "append".
+                if (PyList_Append (result.ptr(), element.ptr()) != 0)
+                    boost::python::throw_error_already_set();
+            }
+            return result;
+        }
+
         python_iterator & iter() { return *this; }
     };
 
     namespace detail {
 
+        /**
+        Make a Python iterator that holds a view of \a range.
+        \return A new reference to the Python object.
+        */
+        template <class Range> inline PyObject * new_iterator (Range && range)
+        {
+            // Make a typed iterator. On the heap!
+            python_iterator * iterator = new python_iterator (
+                range::view (std::forward <Range> (range)));
+
+            // Make converter that takes ownership of the new object.
+            boost::python::manage_new_object
+                ::apply <python_iterator *>::type iterator_converter;
+
+            return iterator_converter (iterator);
+        }
+
         /* Returning views. */
         template <class Range> struct iterator_converter {
             static_assert (is_range <Range>::value, "Range must be a range.");
@@ -107,16 +161,7 @@ namespace range { namespace python {
                     "Boost.Python should call this with a possibly "
                     "differently-qualified version of Range.");
 
-                // Make a typed iterator. On the heap!
-                python_iterator * iterator =
-                    new python_iterator (
-                        range::view (std::forward <QRange> (range)));
-
-                // Make converter that takes ownership of the new object.
-                boost::python::manage_new_object
-                    ::apply <python_iterator *>::type iterator_converter;
-
-                return iterator_converter (iterator);
+                return new_iterator (std::forward <QRange> (range));
             }
 
             PyTypeObject const * get_pytype() const { return 0; }
@@ -131,6 +176,23 @@ namespace range { namespace python {
 
     } // namespace detail
 
+    /** \brief
+    Return a Python iterator that takes ownership of a range.
+
+    Unlike register_view(), this does not need to copy the range, so it also
+    works for ranges that can only be moved, like \ref generator and
+    \ref function_range.
+    The range is traversed in direction \ref front.
+    initialise_iterator() must have been called.
+    */
+    template <class Range, class Enable = typename
+        std::enable_if <is_range <Range>::value>::type>
+    inline boost::python::object make_iterator (Range && range)
+    {
+        return boost::python::object (boost::python::handle<> (
+            detail::new_iterator (std::forward <Range> (range))));
+    }
+
     /** \brief
     Initialise support for Python iterators.
 
@@ -149,6 +211,7 @@ namespace range { namespace python {
                 "next",
 #endif
                 &python_iterator::next)
+            .def ("next_batch", &python_iterator::next_batch)
             .def ("__iter__", &python_iterator::iter, return_self<>());
     }
 
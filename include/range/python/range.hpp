@@ -30,7 +30,14 @@ Allow interaction with Python iterables.
 #include <boost/python/extract.hpp>
 #include <boost/python/converter/registry.hpp>
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
 #include "range/core.hpp"
+#include "range/iterator_range.hpp"
 
 namespace range {
 
@@ -69,6 +76,20 @@ def <void (python_range <double>)> ("my_function", my_function);
 
 Python exceptions are propagated.
 
+If there is exactly one type, and it is an arithmetic type, and the Python
+object supports the buffer protocol with a matching element type, then the
+elements are read directly from the memory that the object exposes.
+This is the case for, for example, one-dimensional contiguous NumPy arrays,
+\c array.array, \c bytes, and \c memoryview.
+No Python objects are then created for the elements.
+For example, a NumPy array with \c dtype \c float64 can be read by
+python_range <double> without any conversion.
+The element types must match exactly: a Python buffer of \c int32 will not be
+converted to \c double, but will fall back to the iterator protocol.
+is_contiguous() indicates whether this fast path is used, and
+contiguous_view() then returns the remaining elements as an iterator_range
+over pointers.
+
 This class is defined to call next() on the Python iterator lazily.
 However, it is not defined when it is called exactly; it may be called earlier
 than expected.
@@ -89,6 +110,12 @@ Python iterator already.
 first_ is necessary because all operations can need to call next() on the
 Python iterator, because of how the Python iterator protocol works: next() tells
 whether the range is empty and if so returns the first element.
+
+If the buffer protocol is used (see
+https://docs.python.org/3/c-api/buffer.html), iterator_ and first_ are null.
+buffer_ then holds the Py_buffer, which is released when the last range that
+uses it is destructed.
+position_ and end_ point into the memory of the buffer.
 */
 template <class ... Types> class python_range;
 
@@ -103,17 +130,164 @@ template <class ... Types>
 namespace python {
 namespace detail {
 
+    /* Buffer protocol. */
+
+    /**
+    Kind of element that can be read from a Python buffer.
+    */
+    enum class buffer_kind {
+        none, signed_integer, unsigned_integer, floating_point, boolean,
+        character };
+
+    /**
+    Description of the element type that a buffer should contain.
+    */
+    struct buffer_element {
+        buffer_kind kind;
+        std::size_t size;
+    };
+
+    template <class Type> struct buffer_kind_of
+    : std::integral_constant <buffer_kind,
+        std::is_same <Type, bool>::value ? buffer_kind::boolean
+        : std::is_same <Type, char>::value ? buffer_kind::character
+        : std::is_floating_point <Type>::value ? buffer_kind::floating_point
+        : std::is_integral <Type>::value
+            ? (std::is_signed <Type>::value ? buffer_kind::signed_integer
+                : buffer_kind::unsigned_integer)
+        : buffer_kind::none> {};
+
+    /**
+    Describe the element type that python_range <Types ...> can read from
+    a buffer.
+    Only ranges with exactly one arithmetic type can.
+    */
+    template <class ... Types> struct buffer_element_of {
+        static constexpr buffer_kind kind = buffer_kind::none;
+        static buffer_element get() { return buffer_element {kind, 0}; }
+    };
+
+    template <class Type> struct buffer_element_of <Type> {
+        static constexpr buffer_kind kind = buffer_kind_of <Type>::value;
+        static buffer_element get()
+        { return buffer_element {kind, sizeof (Type)}; }
+    };
+
+    /// The type in \a Types if there is exactly one; otherwise void.
+    template <class ... Types> struct single_type { typedef void type; };
+    template <class Type> struct single_type <Type> { typedef Type type; };
+
+    /**
+    Return the kind of element that a single-character code in the format
+    string of the "struct" module indicates.
+    */
+    inline buffer_kind buffer_format_kind (char code) {
+        switch (code) {
+        case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+            return buffer_kind::signed_integer;
+        case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+            return buffer_kind::unsigned_integer;
+        case 'f': case 'd':
+            return buffer_kind::floating_point;
+        case '?':
+            return buffer_kind::boolean;
+        case 'c':
+            return buffer_kind::character;
+        default:
+            return buffer_kind::none;
+        }
+    }
+
+    inline bool is_little_endian() {
+        std::uint16_t value = 1;
+        unsigned char first_byte;
+        std::memcpy (&first_byte, &value, 1);
+        return first_byte == 1;
+    }
+
+    /**
+    Return \c true iff a buffer with format string \a format and items of
+    \a item_size bytes contains elements of the type described by
+    \a element.
+    */
+    inline bool buffer_format_matches (char const * format,
+        Py_ssize_t item_size, buffer_element const & element)
+    {
+        if (element.kind == buffer_kind::none
+                || item_size < 0 || std::size_t (item_size) != element.size)
+            return false;
+        // A null format means unsigned bytes.
+        if (format == nullptr)
+            format = "B";
+        // Byte order: only native byte order is acceptable.
+        switch (*format) {
+        case '@': case '=':
+            ++ format;
+            break;
+        case '<':
+            if (!is_little_endian())
+                return false;
+            ++ format;
+            break;
+        case '>': case '!':
+            if (is_little_endian())
+                return false;
+            ++ format;
+            break;
+        }
+        // Exactly one element code should follow.
+        if (format [0] == 0 || format [1] != 0)
+            return false;
+        buffer_kind kind = buffer_format_kind (format [0]);
+        if (kind == element.kind)
+            return true;
+        // char can be read from a buffer of bytes of either signedness.
+        return element.kind == buffer_kind::character
+            && (kind == buffer_kind::signed_integer
+                || kind == buffer_kind::unsigned_integer);
+    }
+
+    /**
+    Deleter for a Py_buffer that has been filled by PyObject_GetBuffer.
+    */
+    struct release_buffer {
+        void operator() (Py_buffer * buffer) const {
+            PyBuffer_Release (buffer);
+            delete buffer;
+        }
+    };
+
     class python_range_base {
     protected:
         explicit python_range_base (boost::python::object const & iterable)
         // PyObject_GetIter is equivalent to iter(o).
-        : iterator_ (PyObject_GetIter (iterable.ptr()))
+        : iterator_ (PyObject_GetIter (iterable.ptr())),
+            position_ (nullptr), end_ (nullptr)
         {
             if (!iterator_ && PyErr_Occurred())
                 boost::python::throw_error_already_set();
         }
 
-        python_range_base (python_range_base const & that) {
+        /**
+        Construct from a Python iterable, using the buffer protocol if the
+        object supports it with elements as described by \a element, and
+        the iterator protocol otherwise.
+        */
+        python_range_base (boost::python::object const & iterable,
+            buffer_element const & element)
+        : position_ (nullptr), end_ (nullptr)
+        {
+            if (!acquire_buffer (iterable, element)) {
+                iterator_ = boost::python::handle<> (
+                    PyObject_GetIter (iterable.ptr()));
+            }
+        }
+
+        python_range_base (python_range_base const & that)
+        // A buffer can be shared.
+        : buffer_ (that.buffer_), position_ (that.position_),
+            end_ (that.end_)
+        {
             // Steal the iterator from "that".
             using std::swap;
             swap (this->iterator_, that.iterator_);
@@ -121,9 +295,14 @@ namespace detail {
         }
 
         python_range_base (boost::python::handle<> && iterator)
-        : iterator_ (iterator.release()) {}
+        : iterator_ (iterator.release()), position_ (nullptr), end_ (nullptr)
+        {}
 
     private:
+        python_range_base (std::shared_ptr <Py_buffer> const & buffer,
+            char const * position, char const * end)
+        : buffer_ (buffer), position_ (position), end_ (end) {}
+
         // Both the iterator and the cached first element are handles, so that
         // they can be null.
         // boost::python::object's can be None, but we want to distinguish
@@ -131,14 +310,89 @@ namespace detail {
         mutable boost::python::handle<> iterator_;
         mutable boost::python::handle<> first_;
 
+        // If the buffer protocol is used: the buffer, and the range of
+        // memory that has not been visited yet.
+        std::shared_ptr <Py_buffer> buffer_;
+        char const * position_;
+        char const * end_;
+
+        /**
+        Try to acquire a buffer for \a object.
+        \return \c true iff the buffer has been acquired and its elements are
+            as described by \a element.
+        */
+        bool acquire_buffer (boost::python::object const & object,
+            buffer_element const & element)
+        {
+            if (element.kind == buffer_kind::none
+                    || !PyObject_CheckBuffer (object.ptr()))
+                return false;
+            std::unique_ptr <Py_buffer> view (new Py_buffer);
+            // Request a C-contiguous buffer with format information.
+            if (PyObject_GetBuffer (object.ptr(), view.get(),
+                PyBUF_ND | PyBUF_FORMAT) != 0)
+            {
+                // E.g. the array is not contiguous: use the iterator instead.
+                PyErr_Clear();
+                return false;
+            }
+            // If this throws, the deleter is called.
+            std::shared_ptr <Py_buffer> buffer (
+                view.release(), release_buffer());
+            if (buffer->ndim != 1 || !buffer_format_matches (
+                    buffer->format, buffer->itemsize, element))
+                return false;
+
+            buffer_ = std::move (buffer);
+            position_ = static_cast <char const *> (buffer_->buf);
+            end_ = position_ + buffer_->len;
+            return true;
+        }
+
     protected:
+        /// \return \c true iff the elements are read from a buffer.
+        bool has_buffer() const { return !!buffer_; }
+
+        char const * buffer_position() const { return position_; }
+        char const * buffer_end() const { return end_; }
+
+        /// Read the element at the front of the buffer.
+        template <class Type> Type buffer_first() const {
+            assert (position_ != end_ && "This range is empty.");
+            // Use memcpy in case the buffer is not aligned.
+            Type result;
+            std::memcpy (&result, position_, sizeof (Type));
+            return result;
+        }
+
+        /// Read the element at the front of the buffer and move past it.
+        template <class Type> Type buffer_chop() {
+            Type result = buffer_first <Type>();
+            position_ += sizeof (Type);
+            return result;
+        }
+
+        /**
+        Return \c true iff the range is empty.
+        This is correct for both the buffer and the iterator protocol.
+        */
+        bool base_empty() const {
+            if (buffer_)
+                return position_ == end_;
+            return !fill_first();
+        }
+
         /**
-        Return a boost::python::object that contains the iterator starting at
-        the next element.
+        Return a python_range_base that starts at the next element.
         */
-        boost::python::object next_iterator() {
+        python_range_base next_base() {
+            if (buffer_) {
+                assert (position_ != end_ && "This range is empty.");
+                return python_range_base (
+                    buffer_, position_ + buffer_->itemsize, end_);
+            }
             fill_first();
-            return boost::python::object (iterator_);
+            return python_range_base (boost::python::object (iterator_));
         }
 
         /**
@@ -169,9 +423,14 @@ namespace detail {
         }
     };
 
-    template <class Range> inline
-        boost::python::object next_iterator (Range & range)
-    { return range.next_iterator(); }
+    struct python_range_access {
+        /**
+        Return a range of type \a Result that starts at the element after
+        the first element of \a range.
+        */
+        template <class Result, class Range> static Result next (Range & range)
+        { return Result (range.next_base()); }
+    };
 
 } // namespace detail
 
@@ -192,7 +451,8 @@ public:
         raises a ValueError.
     */
     explicit python_range (boost::python::object const & iterable)
-    : base_type (iterable) {}
+    : base_type (iterable, python::detail::buffer_element_of <Types ...>::get())
+    {}
 
     /**
     Construct from another python_range, stealing its state.
@@ -202,9 +462,42 @@ public:
     */
     python_range (python_range const & that) = default;
 
+    /**
+    \return \c true iff the elements are read directly from the memory of a
+        Python object that supports the buffer protocol.
+        This can only be the case if \a Types is one arithmetic type.
+    */
+    bool is_contiguous() const { return this->has_buffer(); }
+
+    /**
+    Return the elements that have not been visited yet, as an iterator_range
+    over pointers to the memory of the Python object.
+    This is a zero-copy view.
+    It is only valid while this python_range, or a copy of it, exists, and
+    only if is_contiguous() returns \c true.
+    The Python object must not be changed in the meantime.
+    The memory must be aligned for \a Type; for NumPy arrays and
+    \c array.array this is the case.
+    */
+    template <class Type = typename std::conditional <
+            python::detail::buffer_element_of <Types ...>::kind
+                != python::detail::buffer_kind::none,
+            void, python::detail::buffer_kind>::type,
+        class Enable = typename std::enable_if <
+            std::is_void <Type>::value>::type,
+        class Element = typename python::detail::single_type <Types ...>::type>
+    iterator_range <Element const *> contiguous_view() const
+    {
+        assert (is_contiguous() && "Elements are not in a buffer.");
+        assert (reinterpret_cast <std::uintptr_t> (this->buffer_position())
+            % std::alignment_of <Element>::value == 0);
+        return iterator_range <Element const *> (
+            reinterpret_cast <Element const *> (this->buffer_position()),
+            reinterpret_cast <Element const *> (this->buffer_end()));
+    }
+
 private:
-    friend boost::python::object
-        python::detail::next_iterator <python_range> (python_range &);
+    friend struct python::detail::python_range_access;
 
     /**
     Construct from a Python iterator with the first element it will produce as
@@ -213,11 +506,22 @@ private:
     python_range (boost::python::handle<> && iterator)
     : base_type (std::move (iterator)) {}
 
+    /**
+    Construct from a base object, stealing its state.
+    */
+    explicit python_range (base_type const & base)
+    : base_type (base) {}
+
+    /// Whether the elements can be read from a buffer.
+    typedef std::integral_constant <bool,
+        python::detail::buffer_element_of <Types ...>::kind
+            != python::detail::buffer_kind::none> buffer_possible;
+
 private:
     friend class helper::member_access;
 
     /* empty. */
-    bool empty (direction::front) const { return !fill_first(); }
+    bool empty (direction::front) const { return this->base_empty(); }
 
     /* first. */
     /// Extract the first type (if any) from a boost::python::object.
@@ -237,29 +541,51 @@ private:
         { return boost::python::extract <FirstType> (std::move (object)); }
     };
 
-    typename extract_first <Types ...>::result_type
-        first (direction::front) const
-    {
+    typedef typename extract_first <Types ...>::result_type first_type;
+
+    first_type first_from_iterator() const {
         boost::python::handle<> & first = fill_first();
         assert (!!first || "This range is empty.");
         return extract_first <Types ...>() (boost::python::object (first));
     }
 
+    first_type first_implementation (std::false_type) const
+    { return first_from_iterator(); }
+
+    first_type first_implementation (std::true_type) const {
+        if (this->has_buffer())
+            return this->template buffer_first <first_type>();
+        return first_from_iterator();
+    }
+
+    first_type first (direction::front) const
+    { return first_implementation (buffer_possible()); }
+
     /* chop_in_place. */
     class unavailable_type;
     typedef typename std::conditional <(sizeof ... (Types) <= 1),
         direction::front, unavailable_type>::type front_if_homogeneous;
 
     // This is the natural way of using a Python iterator.
-    typename extract_first <Types ...>::result_type
-        chop_in_place (front_if_homogeneous)
-    {
+    first_type chop_from_iterator() {
         boost::python::handle<> & first = fill_first();
         assert (!!first || "This range is empty.");
         // Set first to 0 and return as an object.
         return extract_first <Types ...>() (boost::python::object (
             boost::python::handle<> (first.release())));
     }
+
+    first_type chop_implementation (std::false_type)
+    { return chop_from_iterator(); }
+
+    first_type chop_implementation (std::true_type) {
+        if (this->has_buffer())
+            return this->template buffer_chop <first_type>();
+        return chop_from_iterator();
+    }
+
+    first_type chop_in_place (front_if_homogeneous)
+    { return chop_implementation (buffer_possible()); }
 };
 
 namespace python_range_operation {
@@ -271,8 +597,8 @@ namespace python_range_operation {
             python_range_tag const &, python_range <Types ...> && range,
             direction::front)
     {
-        return python_range <Types ...> (
-            ::range::python::detail::next_iterator (range));
+        return ::range::python::detail::python_range_access::next <
+            python_range <Types ...>> (range);
     }
 
     // For two or more types, remove the first type.
@@ -282,8 +608,8 @@ namespace python_range_operation {
             python_range <FirstType, SecondType, Types ...> && range,
             direction::front)
     {
-        return python_range <SecondType, Types ...> (
-            ::range::python::detail::next_iterator (range));
+        return ::range::python::detail::python_range_access::next <
+            python_range <SecondType, Types ...>> (range);
     }
 
     // chop is implemented automatically.
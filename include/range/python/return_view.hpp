@@ -15,7 +15,7 @@ limitations under the License.
 */
 
 /** \file
-Expose return values that are ranges as Python iterators.
+Expose return values that are ranges as Python iterators, or as Python arrays.
 */
 
 #ifndef RANGE_PYTHON_RETURN_VIEW_HPP_INCLUDED
@@ -24,13 +24,28 @@ Expose return values that are ranges as Python iterators.
 // Include the Python C API, safely.
 #include <boost/python/detail/wrap_python.hpp>
 
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
 #include <boost/python/default_call_policies.hpp>
 #include <boost/python/make_constructor.hpp>
 #include <boost/python/with_custodian_and_ward.hpp>
+#include <boost/python/import.hpp>
+#include <boost/python/list.hpp>
 
 #include "iterator.hpp"
 
 #include "range/core.hpp"
+#include "range/for_each.hpp"
+#include "range/iterator_range.hpp"
 
 namespace range { namespace python {
 
@@ -121,6 +136,213 @@ namespace range { namespace python {
         };
     };
 
+    namespace detail {
+
+        /* Returning arrays. */
+
+        /**
+        The type that elements of type \a Element are stored as in a Python
+        array.
+        Python arrays do not support \c bool, so it is stored as unsigned
+        char.
+        */
+        template <class Element> struct array_element {
+            static_assert (std::is_arithmetic <Element>::value,
+                "Only arithmetic types can be stored in a Python array.");
+            static_assert (!std::is_same <Element, long double>::value,
+                "Python arrays do not support long double.");
+            typedef Element type;
+        };
+
+        template <> struct array_element <bool>
+        { typedef unsigned char type; };
+
+        /**
+        Return the type code for the Python "array" module for \a Element.
+        */
+        template <class Element> inline char array_typecode() {
+            if (std::is_floating_point <Element>::value)
+                return sizeof (Element) == sizeof (float) ? 'f' : 'd';
+            bool is_signed = std::is_signed <Element>::value;
+            switch (sizeof (Element)) {
+            case sizeof (char): return is_signed ? 'b' : 'B';
+            case sizeof (short): return is_signed ? 'h' : 'H';
+            case sizeof (int): return is_signed ? 'i' : 'I';
+            default:
+                if (sizeof (Element) == sizeof (long))
+                    return is_signed ? 'l' : 'L';
+                return is_signed ? 'q' : 'Q';
+            }
+        }
+
+        /**
+        Return a new Python array.array with type code \a typecode and
+        \a size elements, all zero.
+        This does not create a Python object for each element.
+        */
+        inline boost::python::object make_array (char typecode,
+            std::size_t size)
+        {
+            boost::python::object array_type =
+                boost::python::import ("array").attr ("array");
+            boost::python::list zero;
+            zero.append (0);
+            boost::python::object one = array_type (
+                std::string (1, typecode), zero);
+            return one * size;
+        }
+
+        /**
+        Writable view of the memory of a Python object, for the duration of
+        the lifetime of this object.
+        */
+        class writable_buffer : boost::noncopyable {
+#if PY_VERSION_HEX >= 0x03000000
+            Py_buffer buffer_;
+        public:
+            explicit writable_buffer (boost::python::object const & object) {
+                if (PyObject_GetBuffer (object.ptr(), &buffer_,
+                        PyBUF_WRITABLE | PyBUF_ND) != 0)
+                    boost::python::throw_error_already_set();
+            }
+
+            ~writable_buffer() { PyBuffer_Release (&buffer_); }
+
+            void * data() const { return buffer_.buf; }
+#else
+            // Python 2: array.array only supports the old buffer protocol.
+            void * data_;
+        public:
+            explicit writable_buffer (boost::python::object const & object) {
+                Py_ssize_t length;
+                if (PyObject_AsWriteBuffer (object.ptr(), &data_, &length)
+                        != 0)
+                    boost::python::throw_error_already_set();
+            }
+
+            void * data() const { return data_; }
+#endif
+        };
+
+        /**
+        Evaluate to \c true iff \a Iterator points to elements that are
+        stored contiguously.
+        This is conservative: only pointers and iterators into std::vector
+        are recognised.
+        */
+        template <class Iterator, class Value = typename
+            std::iterator_traits <Iterator>::value_type>
+        struct is_contiguous_iterator
+        : std::integral_constant <bool, std::is_pointer <Iterator>::value
+            || (!std::is_same <Value, bool>::value && (
+                std::is_same <Iterator,
+                    typename std::vector <Value>::iterator>::value
+                || std::is_same <Iterator,
+                    typename std::vector <Value>::const_iterator>::value))>
+        {};
+
+        template <class Element> struct write_element {
+            Element * & destination;
+
+            template <class Value> void operator() (Value && value) const
+            { * destination ++ = Element (std::forward <Value> (value)); }
+        };
+
+        // Contiguous elements of the same type: copy the memory in one go.
+        template <class Element, class Iterator, class Enable =
+            typename std::enable_if <is_contiguous_iterator <Iterator>::value
+                && std::is_same <Element, typename
+                    std::iterator_traits <Iterator>::value_type>::value
+            >::type>
+        inline void fill_array (Element * destination,
+            iterator_range <Iterator> const & view, overload_order <1> *)
+        {
+            if (view.begin() != view.end())
+                std::memcpy (destination, std::addressof (*view.begin()),
+                    std::size_t (view.end() - view.begin()) * sizeof (Element));
+        }
+
+        // Anything else: convert and copy the elements one by one.
+        template <class Element, class View>
+        inline void fill_array (Element * destination, View && view,
+            overload_order <2> *)
+        {
+            ::range::for_each (std::forward <View> (view),
+                write_element <Element> {destination});
+        }
+
+        template <class Range> struct array_converter {
+            static_assert (is_range <Range>::value, "Range must be a range.");
+
+            typedef decltype (::range::view (std::declval <Range>()))
+                view_type;
+            static_assert (has <callable::size (view_type)>::value,
+                "To be returned as an array, a range must have a size.");
+            static_assert (is_homogeneous <view_type>::value,
+                "To be returned as an array, a range must be homogeneous.");
+
+            typedef typename array_element <typename decayed_result_of <
+                callable::first (view_type)>::type>::type element_type;
+
+            bool convertible() const { return true; }
+
+            template <class QRange>
+                PyObject * operator() (QRange && range) const
+            {
+                auto view = ::range::view (std::forward <QRange> (range));
+                std::size_t size = ::range::size (view);
+
+                boost::python::object array = make_array (
+                    array_typecode <element_type>(), size);
+                {
+                    writable_buffer buffer (array);
+                    fill_array (static_cast <element_type *> (buffer.data()),
+                        std::move (view), pick_overload());
+                }
+                return boost::python::incref (array.ptr());
+            }
+
+            PyTypeObject const * get_pytype() const { return 0; }
+        };
+
+    } // namespace detail
+
+    /** \brief
+    A call policy for Boost.Python to return a range as a Python array, of
+    type \c array.array.
+
+    The range is converted into a view, which must have a size, and whose
+    elements must be of an arithmetic type.
+    The elements are copied into the array straight away; the range is not
+    used afterwards.
+    Compared to \ref return_view, this does not create Python objects for the
+    elements.
+    It is therefore much faster to use if the Python code wants all elements,
+    for example to pass them to NumPy with \c numpy.frombuffer.
+
+    If the view is an iterator_range over pointers or std::vector iterators,
+    the elements are copied with one call to memcpy.
+    Otherwise, each element is converted to the array's element type.
+    \c bool elements are stored as unsigned bytes.
+
+    The return type can be a view, a container, or a reference to a
+    container.
+    */
+    template <class BasePolicy = boost::python::default_call_policies>
+        struct return_view_as_array
+    : BasePolicy
+    {
+        struct result_converter {
+            template <class Range> struct apply {
+                static_assert (is_range <Range>::value,
+                    "To use the return_view_as_array call policy for "
+                    "Boost.Python, the return type must be a range.");
+
+                typedef detail::array_converter <Range> type;
+            };
+        };
+    };
+
 }} // namespace range::python
 
 #endif // RANGE_PYTHON_RETURN_VIEW_HPP_INCLUDED
@@ -0,0 +1,319 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define adaptors that present overlapping windows of consecutive elements of a
+range.
+*/
+
+#ifndef RANGE_SLIDING_WINDOW_HPP_INCLUDED
+#define RANGE_SLIDING_WINDOW_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "take.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+template <class Underlying, class Direction> class sliding_window_view;
+template <class Underlying, class Direction> class adjacent_view;
+
+namespace sliding_window_operation {
+    struct sliding_window_view_tag {};
+    struct adjacent_view_tag {};
+} // namespace sliding_window_operation
+
+template <class Underlying, class Direction>
+    struct tag_of_qualified <sliding_window_view <Underlying, Direction>>
+{ typedef sliding_window_operation::sliding_window_view_tag type; };
+
+template <class Underlying, class Direction>
+    struct tag_of_qualified <adjacent_view <Underlying, Direction>>
+{ typedef sliding_window_operation::adjacent_view_tag type; };
+
+/**
+View of all windows of a fixed number of consecutive elements of an underlying
+view.
+Two views of the underlying view are kept: one at the start of the current
+window, and one at the last element of the current window.
+*/
+template <class Underlying, class Direction> class sliding_window_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+public:
+    typedef Underlying underlying_type;
+
+    sliding_window_view (Underlying const & underlying,
+        std::size_t window_size, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        start_ (underlying), last_ (underlying), window_size_ (window_size)
+    {
+        rime::assert_ (window_size != 0);
+        for (std::size_t i = 1;
+                i != window_size && !range::empty (last_, direction); ++ i)
+            last_ = range::drop (last_, direction);
+    }
+
+    std::size_t window_size() const { return window_size_; }
+
+private:
+    Underlying start_;
+    Underlying last_;
+    std::size_t window_size_;
+
+    sliding_window_view (Underlying && start, Underlying && last,
+        std::size_t window_size, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        start_ (std::move (start)), last_ (std::move (last)),
+        window_size_ (window_size) {}
+
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (last_, this->direction_must_be_equal (direction)));
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    auto size (Direction const & direction) const
+    RETURNS (range::size (last_, this->direction_must_be_equal (direction)));
+
+    auto first (Direction const & direction) const
+    RETURNS (range::take (start_, window_size_,
+        this->direction_must_be_equal (direction)));
+
+    sliding_window_view drop_one (Direction const & direction) const {
+        rime::assert_ (!range::empty (last_, direction));
+        return sliding_window_view (range::drop (start_, direction),
+            range::drop (last_, direction), window_size_, direction);
+    }
+
+    template <class Increment, class Enable = decltype (range::drop (
+        std::declval <Underlying const &>(), std::declval <Increment>(),
+        std::declval <Direction>()))>
+    sliding_window_view drop (Increment const & increment,
+        Direction const & direction) const
+    {
+        return sliding_window_view (
+            range::drop (start_, increment, direction),
+            range::drop (last_, increment, direction),
+            window_size_, direction);
+    }
+};
+
+/**
+View of all pairs of consecutive elements of an underlying view.
+*/
+template <class Underlying, class Direction> class adjacent_view
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+
+    typedef decltype (range::first (std::declval <Underlying const &>(),
+        std::declval <Direction>())) underlying_element_type;
+
+public:
+    typedef Underlying underlying_type;
+    typedef std::pair <underlying_element_type, underlying_element_type>
+        element_type;
+
+    adjacent_view (Underlying const & underlying, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        current_ (underlying), next_ (underlying)
+    {
+        if (!range::empty (next_, direction))
+            next_ = range::drop (next_, direction);
+    }
+
+private:
+    Underlying current_;
+    Underlying next_;
+
+    adjacent_view (Underlying && current, Underlying && next,
+        Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        current_ (std::move (current)), next_ (std::move (next)) {}
+
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (next_, this->direction_must_be_equal (direction)));
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    auto size (Direction const & direction) const
+    RETURNS (range::size (next_, this->direction_must_be_equal (direction)));
+
+    element_type first (Direction const & direction) const {
+        rime::assert_ (!range::empty (next_, direction));
+        return element_type (range::first (current_, direction),
+            range::first (next_, direction));
+    }
+
+    adjacent_view drop_one (Direction const & direction) const {
+        rime::assert_ (!range::empty (next_, direction));
+        return adjacent_view (Underlying (next_),
+            range::drop (next_, direction), direction);
+    }
+
+    template <class Increment, class Enable = decltype (range::drop (
+        std::declval <Underlying const &>(), std::declval <Increment>(),
+        std::declval <Direction>()))>
+    adjacent_view drop (Increment const & increment,
+        Direction const & direction) const
+    {
+        return adjacent_view (range::drop (current_, increment, direction),
+            range::drop (next_, increment, direction), direction);
+    }
+};
+
+namespace callable {
+
+    struct sliding_window {
+    private:
+        struct dispatch {
+            template <class View, class Direction>
+                auto operator() (View && view, std::size_t window_size,
+                    Direction const & direction) const
+            RETURNS (sliding_window_view <typename std::decay <View>::type,
+                Direction> (std::forward <View> (view), window_size,
+                    direction));
+        };
+
+    public:
+        template <class Range, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, std::size_t window_size,
+            Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            window_size, direction));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, std::size_t window_size) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            window_size, range::default_direction (range)));
+    };
+
+    struct adjacent {
+    private:
+        struct dispatch {
+            template <class View, class Direction>
+                auto operator() (View && view, Direction const & direction)
+                const
+            RETURNS (adjacent_view <typename std::decay <View>::type,
+                Direction> (std::forward <View> (view), direction));
+        };
+
+    public:
+        template <class Range, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            direction));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            range::default_direction (range)));
+    };
+
+} // namespace callable
+
+/**
+Return a view of all windows of \a window_size consecutive elements of a range.
+
+Each element of the result is a range of \a window_size elements, computed with
+take().
+The first window starts at the first element; each next window starts one
+element further.
+If the range has fewer than \a window_size elements, the result is empty.
+
+\code
+std::vector <int> v = {1, 2, 3, 4};
+auto windows = sliding_window (v, 3);
+// windows contains {1, 2, 3} and {2, 3, 4}.
+\endcode
+
+The windows are not copied: they are views of the underlying range.
+Computing an aggregate over each window by traversing it costs
+O (window_size) per window; to update an aggregate incrementally, use
+\ref window_fold.
+
+The underlying view must be copyable, and dropping elements from it must return
+the same type.
+A \ref buffer, for example, works; its elements are kept in memory as long as a
+window refers to them.
+If the underlying view has a size, then so does the result.
+If the underlying view can drop more than one element at a time, then so can
+the result.
+
+\param range The range to take windows of.
+\param window_size The number of elements in each window.
+    This must be greater than zero.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const sliding_window = callable::sliding_window();
+
+/**
+Return a view of all pairs of consecutive elements of a range.
+
+Each element of the result is a std::pair of an element of the range and the
+next element.
+The types of the elements of the pair are the exact types that first() returns
+on the underlying range, so they can be references.
+
+\code
+std::vector <int> v = {1, 2, 4};
+auto pairs = adjacent (v);
+// pairs contains (1, 2) and (2, 4).
+\endcode
+
+The underlying view must be copyable, and dropping elements from it must return
+the same type.
+If the underlying view has a size, then so does the result.
+
+\param range The range to take pairs of elements from.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const adjacent = callable::adjacent();
+
+} // namespace range
+
+#endif // RANGE_SLIDING_WINDOW_HPP_INCLUDED
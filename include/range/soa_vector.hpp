@@ -0,0 +1,393 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define a container that stores tuples as one contiguous array per element
+("structure of arrays").
+*/
+
+#ifndef RANGE_SOA_VECTOR_HPP_INCLUDED
+#define RANGE_SOA_VECTOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "meta/vector.hpp"
+#include "meta/count.hpp"
+#include "meta/all_of_c.hpp"
+
+#include "rime/enable_if_constant.hpp"
+
+#include "core.hpp"
+#include "heavyweight.hpp"
+#include "iterator_range.hpp"
+#include "tuple.hpp"
+#include "zip.hpp"
+#include "for_each.hpp"
+#include "std/container.hpp"
+
+namespace range {
+
+template <class ... Types> class soa_vector;
+
+namespace soa_vector_operation {
+    struct soa_vector_tag : heavyweight::heavyweight_tag {};
+} // namespace soa_vector_operation
+
+template <class ... Types> struct tag_of_qualified <soa_vector <Types ...>>
+{ typedef soa_vector_operation::soa_vector_tag type; };
+
+namespace soa_vector_detail {
+
+    template <std::size_t Index, class ... Types> struct column_type {
+        typedef typename std::tuple_element <Index, std::tuple <Types ...>
+            >::type type;
+    };
+
+    /**
+    Iterator type for a column: a pointer, or a move iterator wrapping a
+    pointer.
+    */
+    template <bool Move, class Type> struct column_iterator
+    { typedef Type * type; };
+
+    template <class Type> struct column_iterator <true, Type>
+    { typedef std::move_iterator <Type *> type; };
+
+    // Functions to be applied to each column.
+    struct reserve_column {
+        std::size_t size;
+        template <class Column> void operator() (Column & column) const
+        { column.reserve (size); }
+    };
+
+    struct resize_column {
+        std::size_t size;
+        template <class Column> void operator() (Column & column) const
+        { column.resize (size); }
+    };
+
+    struct clear_column {
+        template <class Column> void operator() (Column & column) const
+        { column.clear(); }
+    };
+
+    struct pop_back_column {
+        template <class Column> void operator() (Column & column) const
+        { column.pop_back(); }
+    };
+
+    struct shrink_column {
+        template <class Column> void operator() (Column & column) const
+        { column.shrink_to_fit(); }
+    };
+
+    struct make_view;
+
+} // namespace soa_vector_detail
+
+/** \brief
+Container that holds a sequence of tuples, but stores each element of the tuples
+in a separate contiguous array.
+
+This is also known as "structure of arrays".
+It is useful when algorithms touch only some of the fields of the tuples, or
+when columns should be passed to code that expects contiguous arrays.
+
+As a range, this is a heavyweight container.
+Its view is a \ref zip of contiguous ranges, one per column, and it can be
+traversed from the front or from the back.
+Its elements are tuples of references to the elements in the columns.
+
+\code
+soa_vector <int, double> v;
+v.push_back (1, 1.5);
+v.push_back (2, 2.5);
+// The columns are contiguous ranges.
+assert (size (v.column <1>()) == 2);
+assert (v.data <1>() [1] == 2.5);
+// Iterating over the container yields tuple <int &, double &>.
+assert (second (first (v)) == 1.5);
+\endcode
+
+\tparam Types
+    The element types of the tuples.
+    They are stored in std::vector's, so they must be suitable for that.
+    \c bool is not allowed, because std::vector <bool> is not contiguous.
+*/
+template <class ... Types> class soa_vector {
+    static_assert (sizeof... (Types) != 0,
+        "soa_vector must have at least one column.");
+    static_assert (meta::all_of_c <
+            !std::is_same <typename std::decay <Types>::type, bool>::value ...
+        >::value,
+        "std::vector <bool> is not contiguous, so bool is not allowed as a "
+        "column type.");
+    static_assert (meta::all_of_c <
+            std::is_same <typename std::decay <Types>::type, Types>::value ...
+        >::value,
+        "The column types must be unqualified.");
+
+    typedef range::tuple <std::vector <Types> ...> columns_type;
+    columns_type columns_;
+
+    typedef typename meta::count <sizeof... (Types)>::type indices;
+
+    friend struct soa_vector_detail::make_view;
+
+    /* Implementations. */
+
+    template <class ... Arguments, class ... Indices>
+        void push_back_implementation (meta::vector <Indices ...>,
+            Arguments && ... arguments)
+    {
+        std::size_t pushed = 0;
+        try {
+            int dummy [] = { (range::at_c <Indices::value> (columns_)
+                .emplace_back (std::forward <Arguments> (arguments)),
+                ++ pushed, 0) ...};
+            (void) dummy;
+        } catch (...) {
+            // Remove the elements that were added, so that all columns have
+            // the same length again.
+            int dummy [] = { (Indices::value < pushed
+                ? range::at_c <Indices::value> (columns_).pop_back()
+                : void(), 0) ...};
+            (void) dummy;
+            throw;
+        }
+    }
+
+    template <class ... Indices>
+        tuple <Types & ...> at_implementation (std::size_t index,
+            meta::vector <Indices ...>)
+    {
+        return tuple <Types & ...> (
+            range::at_c <Indices::value> (columns_) [index] ...);
+    }
+
+    template <class ... Indices>
+        tuple <Types const & ...> at_implementation (std::size_t index,
+            meta::vector <Indices ...>) const
+    {
+        return tuple <Types const & ...> (
+            range::at_c <Indices::value> (columns_) [index] ...);
+    }
+
+    template <bool Move, class Direction, class ... Indices>
+        zip_range <Direction, iterator_range <typename
+            soa_vector_detail::column_iterator <Move, Types>::type> ...>
+        rows (Direction const & direction, meta::vector <Indices ...>)
+    {
+        return zip_range <Direction, iterator_range <typename
+            soa_vector_detail::column_iterator <Move, Types>::type> ...> (
+                direction, iterator_range <typename
+                    soa_vector_detail::column_iterator <Move, Types>::type> (
+                        typename soa_vector_detail::column_iterator <
+                            Move, Types>::type (
+                                this->template data <Indices::value>()),
+                        typename soa_vector_detail::column_iterator <
+                            Move, Types>::type (
+                                this->template data <Indices::value>()
+                                    + this->size()))
+                    ...);
+    }
+
+    template <class Direction, class ... Indices>
+        zip_range <Direction, iterator_range <Types const *> ...>
+        rows (Direction const & direction, meta::vector <Indices ...>) const
+    {
+        return zip_range <Direction, iterator_range <Types const *> ...> (
+            direction, this->template column <Indices::value>() ...);
+    }
+
+public:
+    /// Construct an empty container.
+    soa_vector() {}
+
+    /// Construct with \a size default-constructed elements.
+    explicit soa_vector (std::size_t size) { resize (size); }
+
+    /// Return the number of elements.
+    std::size_t size() const { return range::first (columns_).size(); }
+
+    /// Return \c true iff there are no elements.
+    bool empty() const { return range::first (columns_).empty(); }
+
+    /// Reserve space for \a size elements in each column.
+    void reserve (std::size_t size)
+    { range::for_each (columns_, soa_vector_detail::reserve_column {size}); }
+
+    /// Resize all columns to \a size elements.
+    void resize (std::size_t size)
+    { range::for_each (columns_, soa_vector_detail::resize_column {size}); }
+
+    /// Remove all elements.
+    void clear()
+    { range::for_each (columns_, soa_vector_detail::clear_column()); }
+
+    /// Release unused memory in all columns.
+    void shrink_to_fit()
+    { range::for_each (columns_, soa_vector_detail::shrink_column()); }
+
+    /**
+    Append an element.
+    Each argument is used to construct the element in the corresponding
+    column.
+    If an exception is thrown, the container is left unchanged.
+    */
+    template <class ... Arguments> void push_back (Arguments && ... arguments)
+    {
+        static_assert (sizeof... (Arguments) == sizeof... (Types),
+            "push_back requires one argument for each column.");
+        push_back_implementation (indices(),
+            std::forward <Arguments> (arguments) ...);
+    }
+
+    /// Remove the last element.
+    void pop_back()
+    { range::for_each (columns_, soa_vector_detail::pop_back_column()); }
+
+    /**
+    Return a tuple with references to the elements at position \a index in
+    each column.
+    */
+    tuple <Types & ...> operator[] (std::size_t index)
+    { return at_implementation (index, indices()); }
+
+    tuple <Types const & ...> operator[] (std::size_t index) const
+    { return at_implementation (index, indices()); }
+
+    /**
+    Return a pointer to the first element of column \a Index.
+    The column is stored contiguously.
+    */
+    template <std::size_t Index>
+        typename soa_vector_detail::column_type <Index, Types ...>::type *
+        data()
+    { return range::at_c <Index> (columns_).data(); }
+
+    template <std::size_t Index>
+        typename soa_vector_detail::column_type <Index, Types ...>::type const *
+        data() const
+    { return range::at_c <Index> (columns_).data(); }
+
+    /**
+    Return a contiguous range with the elements of column \a Index.
+    The range is an iterator_range over pointers.
+    */
+    template <std::size_t Index> iterator_range <
+        typename soa_vector_detail::column_type <Index, Types ...>::type *>
+        column()
+    {
+        return make_iterator_range (
+            this->template data <Index>(),
+            this->template data <Index>() + size());
+    }
+
+    template <std::size_t Index> iterator_range <typename
+        soa_vector_detail::column_type <Index, Types ...>::type const *>
+        column() const
+    {
+        return make_iterator_range (
+            this->template data <Index>(),
+            this->template data <Index>() + size());
+    }
+
+    /**
+    Swap the contents with another soa_vector.
+    */
+    void swap (soa_vector & that) { columns_.swap (that.columns_); }
+};
+
+/**
+Swap the contents of two soa_vector's.
+*/
+template <class ... Types>
+inline void swap (soa_vector <Types ...> & v1, soa_vector <Types ...> & v2)
+{ v1.swap (v2); }
+
+namespace soa_vector_detail {
+
+    struct make_view {
+        template <class Direction, class ... Types>
+            auto operator() (soa_vector <Types ...> & container,
+                Direction const & direction) const
+        RETURNS (container.template rows <false> (
+            direction, typename soa_vector <Types ...>::indices()));
+
+        template <class Direction, class ... Types>
+            auto operator() (soa_vector <Types ...> const & container,
+                Direction const & direction) const
+        RETURNS (container.rows (
+            direction, typename soa_vector <Types ...>::indices()));
+
+        // Rvalue that will be traversed once: move the elements out.
+        template <class Direction, class ... Types>
+            auto operator() (soa_vector <Types ...> && container,
+                Direction const & direction) const
+        RETURNS (container.template rows <true> (
+            direction, typename soa_vector <Types ...>::indices()));
+    };
+
+} // namespace soa_vector_detail
+
+namespace soa_vector_operation {
+
+    // Lvalues, and rvalues that may be traversed more than once.
+    template <class Once, class Container, class Direction,
+        class Enable1 = typename rime::disable_if_constant_true <Once>::type,
+        class Enable2 = typename std::enable_if <
+            std::is_same <Direction, direction::front>::value
+            || std::is_same <Direction, direction::back>::value>::type>
+    inline auto implement_make_view (soa_vector_tag, Once,
+        Container && container, Direction const & direction)
+    RETURNS (soa_vector_detail::make_view() (container, direction));
+
+    // Lvalues that will be traversed once.
+    template <class Once, class Container, class Direction,
+        class Enable1 = typename rime::enable_if_constant_true <Once>::type,
+        class Enable2 = typename std::enable_if <
+            std::is_lvalue_reference <Container>::value>::type,
+        class Enable3 = typename std::enable_if <
+            std::is_same <Direction, direction::front>::value
+            || std::is_same <Direction, direction::back>::value>::type>
+    inline auto implement_make_view (soa_vector_tag, Once,
+        Container && container, Direction const & direction)
+    RETURNS (soa_vector_detail::make_view() (container, direction));
+
+    // Rvalues that will be traversed once.
+    template <class Once, class Container, class Direction,
+        class Enable1 = typename rime::enable_if_constant_true <Once>::type,
+        class Enable2 = typename std::enable_if <
+            !std::is_lvalue_reference <Container>::value>::type,
+        class Enable3 = typename std::enable_if <
+            std::is_same <Direction, direction::front>::value
+            || std::is_same <Direction, direction::back>::value>::type>
+    inline auto implement_make_view (soa_vector_tag, Once,
+        Container && container, Direction const & direction)
+    RETURNS (soa_vector_detail::make_view() (
+        std::move (container), direction));
+
+} // namespace soa_vector_operation
+
+} // namespace range
+
+#endif  // RANGE_SOA_VECTOR_HPP_INCLUDED
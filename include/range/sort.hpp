@@ -0,0 +1,713 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define algorithms that sort random-access ranges in place.
+*/
+
+#ifndef RANGE_SORT_HPP_INCLUDED
+#define RANGE_SORT_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/returns.hpp"
+
+#include "core.hpp"
+#include "take.hpp"
+#include "tuple.hpp"
+
+namespace range {
+
+namespace sort_detail {
+
+    struct less {
+        template <class Left, class Right>
+        auto operator() (Left && left, Right && right) const
+        RETURNS (std::forward <Left> (left) < std::forward <Right> (right));
+    };
+
+    struct identity {
+        template <class Element>
+            Element && operator() (Element && element) const
+        { return std::forward <Element> (element); }
+    };
+
+    /// Ranges with fewer elements than this are sorted with insertion sort.
+    static constexpr std::size_t insertion_threshold = 16;
+
+    /* Swapping elements. */
+
+    template <std::size_t Index, std::size_t Size> struct swap_components;
+
+    /**
+    Swap two elements that are lvalues.
+    */
+    template <class Element> inline
+        typename std::enable_if <!is_tuple <Element>::value>::type
+        swap_elements (Element & left, Element & right)
+    {
+        using std::swap;
+        swap (left, right);
+    }
+
+    /**
+    Swap two tuples component by component.
+    The tuples can be temporaries that contain references, like the elements
+    of a zip() range, so that the elements they refer to are swapped.
+    */
+    template <class Tuple> inline
+        typename std::enable_if <is_tuple <Tuple>::value>::type
+        swap_elements (Tuple && left, Tuple && right)
+    { swap_components <0, tuple_size <Tuple>::value>() (left, right); }
+
+    template <std::size_t Index, std::size_t Size> struct swap_components {
+        template <class Tuple> void operator() (Tuple & left, Tuple & right)
+            const
+        {
+            swap_elements (range::at_c <Index> (left, front),
+                range::at_c <Index> (right, front));
+            swap_components <Index + 1, Size>() (left, right);
+        }
+    };
+
+    template <std::size_t Size> struct swap_components <Size, Size> {
+        template <class Tuple> void operator() (Tuple &, Tuple &) const {}
+    };
+
+    /**
+    Random-access view with a comparison function.
+    The algorithms below use only comparisons and swaps of elements at
+    positions, so that elements are never copied.
+    */
+    template <class View, class Less> class sequence {
+        View const & view_;
+        Less const & less_;
+
+    public:
+        sequence (View const & view, Less const & less)
+        : view_ (view), less_ (less) {}
+
+        std::size_t size() const { return range::size (view_, front); }
+
+        auto operator[] (std::size_t position) const
+        RETURNS (range::at (view_, position, front));
+
+        bool is_less (std::size_t left, std::size_t right) const
+        { return less_ ((*this) [left], (*this) [right]); }
+
+        void swap (std::size_t left, std::size_t right) const {
+            if (left != right)
+                swap_elements ((*this) [left], (*this) [right]);
+        }
+    };
+
+    template <class View, class Less>
+        inline sequence <View, Less> make_sequence (
+            View const & view, Less const & less)
+    { return sequence <View, Less> (view, less); }
+
+    /// \return The depth limit for introsort: twice the base-2 logarithm.
+    inline std::size_t depth_limit (std::size_t size) {
+        std::size_t depth = 0;
+        for (; size > 1; size /= 2)
+            depth += 2;
+        return depth;
+    }
+
+    /* Algorithms on positions [begin, end) in a sequence. */
+
+    template <class Sequence> inline void insertion_sort (
+        Sequence const & s, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin + 1; i < end; ++ i)
+            for (std::size_t j = i; j != begin && s.is_less (j, j - 1); -- j)
+                s.swap (j, j - 1);
+    }
+
+    /// Restore the heap property for the heap of \a size elements at
+    /// \a begin, below \a root, which is relative to \a begin.
+    template <class Sequence> inline void sift_down (Sequence const & s,
+        std::size_t begin, std::size_t root, std::size_t size)
+    {
+        while (true) {
+            std::size_t child = 2 * root + 1;
+            if (child >= size)
+                return;
+            if (child + 1 < size && s.is_less (begin + child, begin + child + 1))
+                ++ child;
+            if (!s.is_less (begin + root, begin + child))
+                return;
+            s.swap (begin + root, begin + child);
+            root = child;
+        }
+    }
+
+    template <class Sequence> inline void make_heap (
+        Sequence const & s, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t root = (end - begin) / 2; root-- != 0;)
+            sift_down (s, begin, root, end - begin);
+    }
+
+    template <class Sequence> inline void sort_heap (
+        Sequence const & s, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t size = end - begin; size > 1; -- size) {
+            s.swap (begin, begin + size - 1);
+            sift_down (s, begin, 0, size - 1);
+        }
+    }
+
+    /// Put the smallest (middle - begin) elements, sorted, at the start.
+    template <class Sequence> inline void partial_sort (Sequence const & s,
+        std::size_t begin, std::size_t middle, std::size_t end)
+    {
+        if (begin == middle)
+            return;
+        make_heap (s, begin, middle);
+        for (std::size_t i = middle; i != end; ++ i) {
+            if (s.is_less (i, begin)) {
+                s.swap (i, begin);
+                sift_down (s, begin, 0, middle - begin);
+            }
+        }
+        sort_heap (s, begin, middle);
+    }
+
+    /// Move the median of three elements to \a begin.
+    template <class Sequence> inline void move_median_to_first (
+        Sequence const & s, std::size_t begin, std::size_t end)
+    {
+        std::size_t a = begin + 1;
+        std::size_t b = begin + (end - begin) / 2;
+        std::size_t c = end - 1;
+        if (s.is_less (a, b)) {
+            if (s.is_less (b, c))
+                s.swap (begin, b);
+            else if (s.is_less (a, c))
+                s.swap (begin, c);
+            else
+                s.swap (begin, a);
+        } else if (s.is_less (a, c))
+            s.swap (begin, a);
+        else if (s.is_less (b, c))
+            s.swap (begin, c);
+        else
+            s.swap (begin, b);
+    }
+
+    /**
+    Partition around a pivot, which is chosen as a median of three.
+    Elements equal to the pivot are spread over both sides.
+    \return The final position of the pivot.
+    Elements before it are not greater, and elements after it are not less.
+    */
+    template <class Sequence> inline std::size_t partition (
+        Sequence const & s, std::size_t begin, std::size_t end)
+    {
+        move_median_to_first (s, begin, end);
+        std::size_t i = begin + 1;
+        std::size_t j = end - 1;
+        while (true) {
+            while (i <= j && s.is_less (i, begin))
+                ++ i;
+            while (i <= j && s.is_less (begin, j))
+                -- j;
+            if (i >= j)
+                break;
+            s.swap (i, j);
+            ++ i;
+            -- j;
+        }
+        s.swap (begin, j);
+        return j;
+    }
+
+    template <class Sequence> inline void introsort (Sequence const & s,
+        std::size_t begin, std::size_t end, std::size_t depth)
+    {
+        while (end - begin > insertion_threshold) {
+            if (depth == 0) {
+                make_heap (s, begin, end);
+                sort_heap (s, begin, end);
+                return;
+            }
+            -- depth;
+            std::size_t pivot = partition (s, begin, end);
+            // Recurse into the smaller part, to bound the stack depth.
+            if (pivot - begin < end - pivot) {
+                introsort (s, begin, pivot, depth);
+                begin = pivot + 1;
+            } else {
+                introsort (s, pivot + 1, end, depth);
+                end = pivot;
+            }
+        }
+        insertion_sort (s, begin, end);
+    }
+
+    template <class Sequence> inline void introselect (Sequence const & s,
+        std::size_t begin, std::size_t nth, std::size_t end, std::size_t depth)
+    {
+        while (end - begin > insertion_threshold) {
+            if (depth == 0) {
+                partial_sort (s, begin, nth + 1, end);
+                return;
+            }
+            -- depth;
+            std::size_t pivot = partition (s, begin, end);
+            if (pivot == nth)
+                return;
+            if (nth < pivot)
+                end = pivot;
+            else
+                begin = pivot + 1;
+        }
+        insertion_sort (s, begin, end);
+    }
+
+    /**
+    Rearrange the elements so that position i receives the element that was at
+    order [i].
+    This follows the cycles of the permutation, so each element is swapped
+    into place once.
+    \a order is overwritten.
+    */
+    template <class Sequence> inline void permute (
+        Sequence const & s, std::vector <std::size_t> & order)
+    {
+        for (std::size_t start = 0; start != order.size(); ++ start) {
+            std::size_t current = start;
+            while (order [current] != start) {
+                std::size_t next = order [current];
+                s.swap (current, next);
+                order [current] = current;
+                current = next;
+            }
+            order [current] = current;
+        }
+    }
+
+    template <class Sequence> inline void stable_sort (Sequence const & s) {
+        std::vector <std::size_t> order (s.size());
+        for (std::size_t i = 0; i != order.size(); ++ i)
+            order [i] = i;
+        std::stable_sort (order.begin(), order.end(),
+            [&s] (std::size_t left, std::size_t right)
+            { return s.is_less (left, right); });
+        permute (s, order);
+    }
+
+    /* Radix sort. */
+
+    /**
+    Convert an integer into an unsigned integer with the same order.
+    Only the lowest sizeof (Integer) bytes of the result are used.
+    */
+    template <class Integer> inline std::uint64_t radix_digits (
+        Integer const & value)
+    {
+        static_assert (std::is_integral <Integer>::value,
+            "radix_sort requires integral keys, or tuples of integral keys.");
+        std::uint64_t result = std::uint64_t (value);
+        // Flip the sign bit so that negative numbers come first.
+        if (std::is_signed <Integer>::value)
+            result ^= std::uint64_t (1) << (8 * sizeof (Integer) - 1);
+        return result;
+    }
+
+    template <std::size_t Index, std::size_t Size> struct store_components {
+        template <class Tuple>
+            void operator() (Tuple const & key, std::uint64_t * digits) const
+        {
+            digits [Index] = radix_digits (range::at_c <Index> (key, front));
+            store_components <Index + 1, Size>() (key, digits);
+        }
+    };
+
+    template <std::size_t Size> struct store_components <Size, Size> {
+        template <class Tuple>
+            void operator() (Tuple const &, std::uint64_t *) const {}
+    };
+
+    /**
+    Describe how a key is split into components, from most to least
+    significant, and how many bytes each has.
+    */
+    template <class Key> struct radix_key {
+        static constexpr std::size_t component_num = 1;
+
+        static void widths (std::size_t * widths)
+        { widths [0] = sizeof (Key); }
+
+        static void store (Key const & key, std::uint64_t * digits)
+        { digits [0] = radix_digits (key); }
+    };
+
+    template <class ... Types> struct radix_key <tuple <Types ...>> {
+        static_assert (sizeof ... (Types) != 0,
+            "radix_sort requires non-empty tuples as keys.");
+
+        static constexpr std::size_t component_num = sizeof ... (Types);
+
+        static void widths (std::size_t * widths) {
+            std::size_t const sizes [] =
+                { sizeof (typename std::decay <Types>::type) ...};
+            std::copy (sizes, sizes + component_num, widths);
+        }
+
+        static void store (tuple <Types ...> const & key,
+            std::uint64_t * digits)
+        { store_components <0, component_num>() (key, digits); }
+    };
+
+    /**
+    Sort stably by key, with a least-significant-digit radix sort, one byte at
+    a time.
+    The keys are computed once and the sort permutes positions; the elements
+    are then moved into place with swaps.
+    */
+    template <class Sequence, class Key>
+        inline void radix_sort (Sequence const & s, Key const & key)
+    {
+        typedef typename std::decay <decltype (key (s [0]))>::type key_type;
+        typedef radix_key <key_type> traits;
+        std::size_t const component_num = traits::component_num;
+        std::size_t const size = s.size();
+
+        std::vector <std::uint64_t> digits (size * component_num);
+        for (std::size_t i = 0; i != size; ++ i)
+            traits::store (key (s [i]), &digits [i * component_num]);
+        std::size_t widths [component_num];
+        traits::widths (widths);
+
+        std::vector <std::size_t> order (size);
+        for (std::size_t i = 0; i != size; ++ i)
+            order [i] = i;
+        std::vector <std::size_t> next (size);
+
+        for (std::size_t component = component_num; component-- != 0;) {
+            for (std::size_t byte = 0; byte != widths [component]; ++ byte) {
+                auto digit = [&] (std::size_t position) {
+                    return std::size_t ((digits [
+                        position * component_num + component] >> (8 * byte))
+                        & 0xff);
+                };
+                std::size_t counts [257] = {};
+                for (std::size_t position : order)
+                    ++ counts [digit (position) + 1];
+                // Skip this pass if all digits are the same.
+                if (std::find (counts + 1, counts + 257, size)
+                        != counts + 257)
+                    continue;
+                for (std::size_t d = 1; d != 257; ++ d)
+                    counts [d] += counts [d - 1];
+                for (std::size_t position : order)
+                    next [counts [digit (position)] ++] = position;
+                order.swap (next);
+            }
+        }
+        permute (s, order);
+    }
+
+} // namespace sort_detail
+
+namespace callable {
+
+    struct sort {
+    private:
+        template <class View, class Less>
+            static void apply (View const & view, Less const & less)
+        {
+            auto s = sort_detail::make_sequence (view, less);
+            sort_detail::introsort (s, 0, s.size(),
+                sort_detail::depth_limit (s.size()));
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, Less const & less) const
+        { apply (range::view (std::forward <Range> (range), front), less); }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range) const {
+            apply (range::view (std::forward <Range> (range), front),
+                sort_detail::less());
+        }
+    };
+
+    struct stable_sort {
+    private:
+        template <class View, class Less>
+            static void apply (View const & view, Less const & less)
+        { sort_detail::stable_sort (sort_detail::make_sequence (view, less)); }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, Less const & less) const
+        { apply (range::view (std::forward <Range> (range), front), less); }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range) const {
+            apply (range::view (std::forward <Range> (range), front),
+                sort_detail::less());
+        }
+    };
+
+    struct partial_sort {
+    private:
+        template <class View, class Less> static void apply (
+            View const & view, std::size_t middle, Less const & less)
+        {
+            auto s = sort_detail::make_sequence (view, less);
+            sort_detail::partial_sort (s, 0, std::min (middle, s.size()),
+                s.size());
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t middle,
+            Less const & less) const
+        {
+            apply (range::view (std::forward <Range> (range), front), middle,
+                less);
+        }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t middle) const {
+            apply (range::view (std::forward <Range> (range), front), middle,
+                sort_detail::less());
+        }
+    };
+
+    struct top_k {
+    private:
+        template <class View, class Less> static auto apply (
+            View view, std::size_t number, Less const & less)
+        -> decltype (range::take (std::move (view), number, front))
+        {
+            partial_sort() (view, number, less);
+            return range::take (std::move (view), number, front);
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, std::size_t number,
+            Less const & less) const
+        RETURNS (apply (range::view (std::forward <Range> (range), front),
+            number, less));
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, std::size_t number) const
+        RETURNS (apply (range::view (std::forward <Range> (range), front),
+            number, sort_detail::less()));
+    };
+
+    struct nth_element {
+    private:
+        template <class View, class Less> static void apply (
+            View const & view, std::size_t nth, Less const & less)
+        {
+            auto s = sort_detail::make_sequence (view, less);
+            if (nth < s.size())
+                sort_detail::introselect (s, 0, nth, s.size(),
+                    sort_detail::depth_limit (s.size()));
+        }
+
+    public:
+        template <class Range, class Less, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t nth,
+            Less const & less) const
+        {
+            apply (range::view (std::forward <Range> (range), front), nth,
+                less);
+        }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, std::size_t nth) const {
+            apply (range::view (std::forward <Range> (range), front), nth,
+                sort_detail::less());
+        }
+    };
+
+    struct radix_sort {
+    private:
+        template <class View, class Key>
+            static void apply (View const & view, Key const & key)
+        {
+            sort_detail::radix_sort (
+                sort_detail::make_sequence (view, sort_detail::less()), key);
+        }
+
+    public:
+        template <class Range, class Key, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range, Key const & key) const
+        { apply (range::view (std::forward <Range> (range), front), key); }
+
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        void operator() (Range && range) const {
+            apply (range::view (std::forward <Range> (range), front),
+                sort_detail::identity());
+        }
+    };
+
+} // namespace callable
+
+/** \brief
+Sort the elements of a random-access range in place.
+
+The range must have size(), and at() (or drop() with an increment and first())
+that is fast, from the front.
+This is the case for views of containers like \c std::vector, but also for
+zip() of such views, which has tuples of references as elements.
+Elements are only ever compared and swapped; they are not copied or moved
+into temporaries.
+Tuples are swapped component by component, so that sorting a zip() of keys
+and values rearranges the underlying containers without materialising pairs:
+
+\code
+std::vector <int> keys = {3, 1, 2};
+std::vector <std::string> values = {"c", "a", "b"};
+sort (zip (keys, values),
+    [] (tuple <int &, std::string &> l, tuple <int &, std::string &> r)
+    { return first (l) < first (r); });
+// keys is {1, 2, 3}; values is {"a", "b", "c"}.
+\endcode
+
+The algorithm is introsort: quicksort with a median-of-three pivot, which
+falls back to heapsort if the recursion becomes too deep, and insertion sort
+for small parts.
+It takes O(n log n) time, and is not stable.
+
+\param range The range to sort.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+*/
+static auto const sort = callable::sort();
+
+/** \brief
+Sort the elements of a random-access range in place, keeping equal elements
+in their original order.
+
+The same requirements as for sort() hold.
+The positions of the elements are sorted with std::stable_sort, after which
+the elements are swapped into place, following the cycles of the permutation.
+This uses one \c std::size_t of memory per element.
+
+\param range The range to sort.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+*/
+static auto const stable_sort = callable::stable_sort();
+
+/** \brief
+Put the smallest \a middle elements of a random-access range, sorted, at its
+start.
+The order of the other elements is not specified.
+
+This uses a heap of \a middle elements, and takes O(n log (middle)) time.
+The same requirements as for sort() hold.
+
+\param range The range to sort partially.
+\param middle The number of elements to sort.
+    If this is greater than the size of the range, then the whole range is
+    sorted.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+*/
+static auto const partial_sort = callable::partial_sort();
+
+/** \brief
+Sort the \a number smallest elements of a random-access range to its start,
+like partial_sort(), and return a view of them.
+
+To find the largest elements, pass a comparison function like
+\c std::greater.
+
+\param range The range to sort partially.
+\param number The number of elements to return.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+\return A view of the first \a number elements of the range, in order.
+*/
+static auto const top_k = callable::top_k();
+
+/** \brief
+Rearrange a random-access range so that the element at position \a nth is
+the one that would be there if the range were sorted.
+Elements before it are not greater, and elements after it are not less.
+
+This takes O(n) time on average, using quickselect, with a fallback to
+partial_sort().
+The same requirements as for sort() hold.
+If \a nth is not less than the size of the range, nothing happens.
+
+\param range The range to rearrange.
+\param nth The position of the element to put in place.
+\param less (Optional) The comparison function.
+    By default, operator< is used.
+*/
+static auto const nth_element = callable::nth_element();
+
+/** \brief
+Sort a random-access range in place by an integral key, or a tuple of
+integral keys, with a radix sort.
+
+The key of each element is computed once.
+The sort then takes one pass over the positions for each byte of the key,
+from least to most significant, which takes O(n) time.
+Passes in which all elements have the same byte are skipped.
+Signed integers are ordered correctly.
+For tuples, the first component is the most significant.
+The sort is stable.
+Finally, the elements are swapped into place, as for stable_sort().
+
+\code
+std::vector <int> keys = {3, -1, 2};
+std::vector <std::string> values = {"c", "a", "b"};
+radix_sort (zip (keys, values),
+    [] (tuple <int &, std::string &> e) { return first (e); });
+\endcode
+
+The same requirements as for sort() hold.
+
+\param range The range to sort.
+\param key (Optional) The function that returns the key for an element.
+    It must return an integral type or a tuple of integral types.
+    By default, the elements themselves are used.
+*/
+static auto const radix_sort = callable::radix_sort();
+
+} // namespace range
+
+#endif // RANGE_SORT_HPP_INCLUDED
@@ -0,0 +1,182 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define an adaptor that contains every k-th element of a range.
+*/
+
+#ifndef RANGE_STRIDE_HPP_INCLUDED
+#define RANGE_STRIDE_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+
+namespace range {
+
+template <class Underlying> class stride_view;
+
+namespace stride_operation {
+    struct stride_view_tag {};
+} // namespace stride_operation
+
+template <class Underlying>
+    struct tag_of_qualified <stride_view <Underlying>>
+{ typedef stride_operation::stride_view_tag type; };
+
+/**
+View of every step-th element of an underlying view, starting at the first
+element.
+The underlying view is trimmed at the back, so that its last element is the
+last element of the stride view.
+The underlying view then always has <c>(size - 1) * step + 1</c> elements, or
+none, and both ends can be accessed in constant time.
+*/
+template <class Underlying> class stride_view {
+    static_assert (range::is_view <Underlying, direction::front>::value,
+        "Underlying range must be a view");
+public:
+    typedef Underlying underlying_type;
+
+    stride_view (Underlying const & underlying, std::size_t step)
+    : underlying_ (trim (underlying, step)), step_ (step) {}
+
+    std::size_t step() const { return step_; }
+
+    /// \return The underlying view, trimmed to the last element in the view.
+    Underlying const & underlying() const { return underlying_; }
+
+private:
+    Underlying underlying_;
+    std::size_t step_;
+
+    struct trimmed {};
+
+    stride_view (trimmed, Underlying && underlying, std::size_t step)
+    : underlying_ (std::move (underlying)), step_ (step) {}
+
+    static Underlying trim (Underlying const & underlying, std::size_t step) {
+        rime::assert_ (step != 0);
+        std::size_t size = range::size (underlying, front);
+        if (size == 0)
+            return underlying;
+        std::size_t used = (size - 1) / step * step + 1;
+        return range::drop (underlying, size - used, back);
+    }
+
+    /**
+    Drop \a increment elements of the stride view from the underlying view in
+    \a direction.
+    When the last element is dropped, fewer than step elements are left, so
+    the number of elements to drop is clipped.
+    */
+    template <class Increment, class Direction>
+        stride_view drop_elements (Increment const & increment,
+            Direction const & direction) const
+    {
+        std::size_t number = std::size_t (increment) * step_;
+        std::size_t available = range::size (underlying_, direction);
+        if (number > available)
+            number = available;
+        return stride_view (trimmed(),
+            range::drop (underlying_, number, direction), step_);
+    }
+
+    friend class helper::member_access;
+
+    auto default_direction() const
+    RETURNS (range::default_direction (underlying_));
+
+    template <class Direction>
+        auto empty (Direction const & direction) const
+    RETURNS (range::empty (underlying_, direction));
+
+    template <class Direction>
+        std::size_t size (Direction const & direction) const
+    {
+        std::size_t underlying_size = range::size (underlying_, direction);
+        return (underlying_size + step_ - 1) / step_;
+    }
+
+    template <class Direction>
+        auto first (Direction const & direction) const
+    RETURNS (range::first (underlying_, direction));
+
+    template <class Increment>
+        stride_view drop (Increment const & increment, direction::front) const
+    { return drop_elements (increment, front); }
+
+    template <class Increment>
+        stride_view drop (Increment const & increment, direction::back) const
+    { return drop_elements (increment, back); }
+};
+
+namespace callable {
+
+    struct stride {
+    private:
+        struct dispatch {
+            template <class View>
+                auto operator() (View && view, std::size_t step) const
+            RETURNS (stride_view <typename std::decay <View>::type> (
+                std::forward <View> (view), step));
+        };
+
+    public:
+        template <class Range, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, std::size_t step) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), front, back), step));
+    };
+
+} // namespace callable
+
+/**
+Return a view of every \a step-th element of a range, starting with the first.
+
+For example, for a buffer with interleaved channels, this selects one channel
+without testing every element.
+
+\code
+// Left and right channels, interleaved.
+std::vector <float> samples = {l0, r0, l1, r1, l2, r2};
+auto left = stride (samples, 2);
+auto right = stride (drop (samples), 2);
+// right contains r0, r1, r2.
+\endcode
+
+The underlying range must be a random-access range, in the sense that it has
+size(), and drop() with an increment in constant time, from the front and the
+back, and that drop() returns the same type.
+The result then has the same properties: size(), first() and drop() take
+constant time from either direction, so that reverse() is cheap.
+
+\param range The range to take elements from.
+\param step The distance between elements that are taken.
+    This must be greater than zero.
+*/
+static auto const stride = callable::stride();
+
+} // namespace range
+
+#endif // RANGE_STRIDE_HPP_INCLUDED
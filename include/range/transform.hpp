@@ -26,6 +26,8 @@ limitations under the License.
 #include "utility/storage.hpp"
 
 #include "core.hpp"
+#include "fold.hpp"
+#include "for_each.hpp"
 #include "helper/underlying.hpp"
 
 namespace range {
@@ -145,6 +147,9 @@ The range is converted into a view before it is stored.
     Function that is applied to elements of the underlying range.
     Its return value is used as an element of the transformed range.
     This function is called every time first() is used.
+    fold() and for_each() traverse the underlying range with the function
+    applied to each element, so that they use any specialised implementation
+    for the underlying range.
 \param directions
     (optional) Directions that should be used to convert the range into a view.
 */
@@ -203,6 +208,71 @@ namespace transform_operation {
 
 } // namespace transform_operation
 
+/* fold and for_each: forward to underlying with a composed function. */
+
+namespace transform_detail {
+
+    /**
+    Function for fold that applies the transformation to each element before
+    passing it on.
+    */
+    template <class Function, class Transformation> struct fold_function {
+        Function & function;
+        Transformation const & transformation;
+
+        template <class State, class Element>
+            auto operator() (State && state, Element && element) const
+        RETURNS (function (std::forward <State> (state),
+            transformation (std::forward <Element> (element))));
+    };
+
+    /**
+    Function for for_each that applies the transformation to each element
+    before passing it on.
+    */
+    template <class Function, class Transformation> struct for_each_function {
+        Function & function;
+        Transformation const & transformation;
+
+        template <class Element>
+            auto operator() (Element && element) const
+        RETURNS (function (transformation (std::forward <Element> (element))));
+    };
+
+} // namespace transform_detail
+
+namespace transform_operation {
+
+    /*
+    Traversing the underlying range directly, instead of calling first() and
+    drop() on the transformed view, means that specialised implementations of
+    fold and for_each for the underlying range are used.
+    For example, transform (count (n), f) becomes a plain loop.
+    */
+
+    template <class State, class View, class Direction, class Function>
+        inline auto implement_fold (transform_view_tag const &,
+            State && state, View && view, Direction const & direction,
+            Function && function)
+    RETURNS (range::fold (std::forward <State> (state),
+        range::helper::get_underlying <View> (view), direction,
+        transform_detail::fold_function <
+            typename std::remove_reference <Function>::type,
+            typename std::decay <decltype (view.function())>::type> {
+                function, view.function()}));
+
+    template <class View, class Direction, class Function>
+        inline auto implement_for_each (transform_view_tag const &,
+            View && view, Direction const & direction, Function && function)
+    RETURNS (range::for_each (
+        range::helper::get_underlying <View> (view), direction,
+        transform_detail::for_each_function <
+            typename std::remove_reference <Function>::type,
+            typename std::decay <decltype (view.function())>::type> {
+                function, view.function()}));
+
+} // namespace transform_operation
+
 } // namespace range
 
 #endif // RANGE_TRANSFORM_HPP_INCLUDED
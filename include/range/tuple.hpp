@@ -27,6 +27,10 @@ Define a general heterogeneous container.
 #include <boost/mpl/and.hpp>
 #include <boost/mpl/not.hpp>
 
+#include "meta/vector.hpp"
+#include "meta/count.hpp"
+#include "meta/all_of_c.hpp"
+
 #include "utility/overload_order.hpp"
 #include "utility/storage.hpp"
 #include "utility/is_assignable.hpp"
@@ -76,7 +80,12 @@ The ordering operators perform lexicographical comparison.
 Views on tuples do not define comparison operators.
 
 The layout of the elements in memory is undefined.
-Connected with this is the layout
+In practice, elements of empty class types take up no space, and elements are
+reordered by decreasing alignment if that reduces padding and all element types
+can be moved without throwing.
+The order of construction and destruction of elements is therefore not defined
+either.
+The elements are accessed by their original positions.
 
 \todo Implement tuple_cat? Probably rather make_tuple_from (concatenate (...)).
 \todo uses_allocator
@@ -136,6 +145,56 @@ namespace tuple_detail {
     */
     template <class Type> struct contained_type { typedef Type type; };
 
+    /**
+    Evaluate to \c true iff \a Type is a class that cannot be derived from.
+    */
+    template <class Type> struct is_final_class
+#if __cplusplus >= 201402L
+    : std::is_final <Type> {};
+#else
+    // GCC and CLang provide this intrinsic from before C++14.
+    : std::integral_constant <bool, __is_final (Type)> {};
+#endif
+
+    /**
+    Hold the stored value for "contain".
+    If \a Stored is an empty class, then derive from it, so that it takes up no
+    space (the "empty base optimisation").
+    Otherwise, contain it as a member.
+    */
+    template <class Stored, bool Derive = std::is_empty <Stored>::value
+        && !is_final_class <Stored>::value>
+    class contain_storage
+    {
+        Stored element_;
+
+    protected:
+        contain_storage() : element_() {}
+
+        template <class Argument>
+            explicit contain_storage (Argument && argument)
+        : element_ (std::forward <Argument> (argument)) {}
+
+        Stored & element() { return element_; }
+        Stored const & element() const { return element_; }
+    };
+
+    template <class Stored> class contain_storage <Stored, true>
+    : private Stored
+    {
+    protected:
+        contain_storage() : Stored() {}
+
+        template <class Argument>
+            explicit contain_storage (Argument && argument)
+        : Stored (std::forward <Argument> (argument)) {}
+
+        Stored & element() { return *this; }
+        Stored const & element() const { return *this; }
+    };
+
+    template <class Natural, class ... Contains> class reordered_elements;
+
     /**
     Contain a value and provide access to it.
     This derived from by tuple.
@@ -162,44 +221,49 @@ namespace tuple_detail {
     Copy- and move-assignment perform assignment on <c>Type &</c>, not on the
     type as it is stored.
 
-    \todo If Type is empty, then derive from it privately instead of containing
-    it.
+    If the stored type is an empty class, then this derives from it privately
+    instead of containing it, so that it takes up no space.
     */
-    template <class Type, std::size_t Index> struct contain {
+    template <class Type, std::size_t Index> struct contain
+    : private contain_storage <typename utility::storage::store <Type>::type>
+    {
         typedef Type element_type;
     private:
         typedef typename utility::storage::store <Type>::type stored_type;
+        typedef contain_storage <stored_type> storage_type;
 
-        stored_type element_;
+        using storage_type::element;
 
         friend class extract <Index>;
         template <class ... Types> friend class elements;
+        template <class Natural, class ... Contains>
+            friend class reordered_elements;
 
     public:
-        contain() : element_() {};
+        contain() : storage_type() {};
 
         template <class Argument, class Enable = typename
             utility::disable_if_same_or_derived <contain, Argument>::type>
         explicit contain (Argument && argument)
-        : element_ (std::forward <Argument> (argument)) {}
+        : storage_type (std::forward <Argument> (argument)) {}
 
-        contain (contain const & that) : element_ (that.element_) {}
+        contain (contain const & that) : storage_type (that.element()) {}
         contain (contain && that)
-        : element_ (static_cast <stored_type &&> (that.element_)) {}
+        : storage_type (static_cast <stored_type &&> (that.element())) {}
 
         template <class Type2 = Type, class Enable = typename boost::enable_if <
             utility::is_assignable <Type2 &, Type2 const &>>::type>
         contain & operator= (contain const & that) {
-            static_cast <Type &> (this->element_) =
-                static_cast <Type const &> (that.element_);
+            static_cast <Type &> (this->element()) =
+                static_cast <Type const &> (that.element());
             return *this;
         }
 
         template <class Type2 = Type, class Enable = typename boost::enable_if <
             utility::is_assignable <Type2 &, Type2 &&>>::type>
         contain & operator= (contain && that) {
-            static_cast <Type &> (this->element_) =
-                static_cast <Type &&> (that.element_);
+            static_cast <Type &> (this->element()) =
+                static_cast <Type &&> (that.element());
             return *this;
         }
 
@@ -244,7 +308,7 @@ namespace tuple_detail {
         {
             result <Tuple> implementation;
             return implementation (tuple.elements()
-                .get_contain (contain_index <Index>()).element_);
+                .get_contain (contain_index <Index>()).element());
         }
     };
 
@@ -295,6 +359,8 @@ namespace tuple_detail {
     template<> class elements<> {
         template <class ... Types2> friend class elements;
         template <class ... Types2> friend class ::range::tuple;
+        template <class Natural, class ... Contains>
+            friend class reordered_elements;
 
     private:
         // Useless definitions so "using base_type::get_contain" does not yield
@@ -360,6 +426,8 @@ namespace tuple_detail {
         template <class ... Types2> friend class elements;
         template <class ... Types2> friend class ::range::tuple;
         template <std::size_t> friend class tuple_detail::extract;
+        template <class Natural, class ... Contains>
+            friend class reordered_elements;
 
         typedef typename utility::storage::store <First>::type
             first_stored_type;
@@ -373,7 +441,7 @@ namespace tuple_detail {
 
         typename utility::storage::get <First, int &>::type first_element() {
             utility::storage::get <First, int &> convert;
-            return convert (static_cast <contain_type *> (this)->element_);
+            return convert (static_cast <contain_type *> (this)->element());
         }
 
         /**
@@ -550,6 +618,255 @@ namespace tuple_detail {
         }
     };
 
+    struct from_natural {};
+
+    /*
+    Contain all elements of a tuple, in an order other than the natural one.
+    \a Contains are the "contain" classes that elements <Types ...> derives
+    from, but reordered.
+    Since each "contain" class knows its index, the elements are found exactly
+    as for "elements".
+
+    \a Natural is elements <Types ...>.
+    Its type traits are used, and construction from elements or from a range
+    goes through a temporary object of this type.
+    That way, a range is always traversed in its natural order, but the
+    elements can be moved into place in any order.
+    This is why this is only used if all element types can be moved without
+    throwing.
+    */
+    // Base case.
+    template <class Natural> class reordered_elements <Natural> {
+        template <class Natural2, class ... Contains>
+            friend class reordered_elements;
+
+        // Useless definitions so "using base_type::get_contain" does not yield
+        // a compiler error.
+        void get_contain();
+        void get_contained_type();
+
+    public:
+        reordered_elements() {}
+
+        reordered_elements (reordered_elements const &) {}
+        reordered_elements (reordered_elements &&) {}
+
+        reordered_elements (from_natural, Natural &&) {}
+
+        void swap (reordered_elements & that) {}
+    };
+
+    // Recursive case.
+    template <class Natural, class Type, std::size_t Index, class ... Rest>
+        class reordered_elements <Natural, contain <Type, Index>, Rest ...>
+    : tuple_detail::contain <Type, Index>, reordered_elements <Natural, Rest ...>
+    {
+    private:
+        template <class Natural2, class ... Contains>
+            friend class reordered_elements;
+        template <class ... Types2> friend class ::range::tuple;
+        template <std::size_t> friend class tuple_detail::extract;
+
+        typedef tuple_detail::contain <Type, Index> contain_type;
+        typedef reordered_elements <Natural, Rest ...> rest_type;
+
+        using contain_type::get_contain;
+        using rest_type::get_contain;
+        using contain_type::get_contained_type;
+        using rest_type::get_contained_type;
+
+        static constexpr std::size_t element_count = sizeof... (Rest) + 1;
+
+        /**
+        Return the element with index \a ElementIndex (counted from the end) as
+        a reference.
+        */
+        template <std::size_t ElementIndex, class ElementType = typename
+            decltype (std::declval <reordered_elements const &>()
+                .get_contained_type (contain_index <ElementIndex>()))::type>
+        typename utility::storage::get <ElementType, int &>::type
+            get_element()
+        {
+            utility::storage::get <ElementType, int &> convert;
+            return convert (
+                this->get_contain (contain_index <ElementIndex>()).element());
+        }
+
+        /**
+        Assign from a range in its natural order.
+        \a Remaining is the number of elements still to be assigned to.
+        */
+        template <class Range> void assign (
+            std::integral_constant <std::size_t, 0>, Range && range)
+        {
+            if (!empty (range, front))
+                throw size_mismatch();
+        }
+
+        template <std::size_t Remaining, class Range> void assign (
+            std::integral_constant <std::size_t, Remaining>, Range && range)
+        {
+            if (empty (range, front))
+                throw size_mismatch();
+            auto chopped = range::chop (std::forward <Range> (range), front);
+            this->template get_element <Remaining - 1>() = chopped.move_first();
+            assign (std::integral_constant <std::size_t, Remaining - 1>(),
+                chopped.move_rest());
+        }
+
+    public:
+        reordered_elements() : contain_type(), rest_type() {}
+
+        /**
+        Move the elements from an object with the natural order.
+        */
+        reordered_elements (from_natural, Natural && natural)
+        : contain_type (static_cast <contain_type &&> (
+                natural.get_contain (contain_index <Index>()))),
+            rest_type (from_natural(), std::move (natural)) {}
+
+        template <class ... Arguments>
+            explicit reordered_elements (from_elements,
+                Arguments && ... arguments)
+        : reordered_elements (from_natural(), Natural (from_elements(),
+            std::forward <Arguments> (arguments) ...)) {}
+
+        /**
+        Construct from a range, or from the result of Natural::maybe_chop.
+        */
+        template <class Range>
+            reordered_elements (from_range, Range && range)
+        : reordered_elements (from_natural(), Natural (from_range(),
+            std::forward <Range> (range))) {}
+
+        reordered_elements (reordered_elements const & that)
+        : contain_type (that), rest_type (that) {}
+
+        reordered_elements (reordered_elements && that)
+        : contain_type (std::move (that)), rest_type (std::move (that)) {}
+
+        template <class Range> reordered_elements & operator= (Range && range)
+        {
+            assign (std::integral_constant <std::size_t, element_count>(),
+                std::forward <Range> (range));
+            return *this;
+        }
+
+        void swap (reordered_elements & that) {
+            using std::swap;
+            swap (this->template get_element <Index>(),
+                that.template get_element <Index>());
+            rest_type::swap (that);
+        }
+    };
+
+    /* Compute the storage type for a tuple. */
+
+    /// Concatenate meta::vector's.
+    template <class ... Vectors> struct join_vectors;
+
+    template <> struct join_vectors<> { typedef meta::vector<> type; };
+
+    template <class ... Types> struct join_vectors <meta::vector <Types ...>>
+    { typedef meta::vector <Types ...> type; };
+
+    template <class ... Types1, class ... Types2, class ... Vectors>
+        struct join_vectors <meta::vector <Types1 ...>,
+            meta::vector <Types2 ...>, Vectors ...>
+    : join_vectors <meta::vector <Types1 ..., Types2 ...>, Vectors ...> {};
+
+    /**
+    Evaluate to a meta::vector with the "contain" classes that
+    elements <Types ...> derives from, in order.
+    */
+    template <class Types, class Indices> struct natural_contains;
+
+    template <class ... Types, class ... Indices>
+        struct natural_contains <
+            meta::vector <Types ...>, meta::vector <Indices ...>>
+    {
+        typedef meta::vector <contain <Types,
+            sizeof... (Types) - 1 - Indices::value> ...> type;
+    };
+
+    /**
+    Alignment of the type that is stored.
+    A reference is stored as a pointer.
+    */
+    template <class Stored> struct storage_alignment
+    : std::alignment_of <Stored> {};
+
+    template <class Stored> struct storage_alignment <Stored &>
+    : std::alignment_of <Stored *> {};
+
+    template <class Stored> struct storage_alignment <Stored &&>
+    : std::alignment_of <Stored *> {};
+
+    /**
+    Alignments are powers of two.
+    Sort them into a small number of buckets: alignments greater than 8 are
+    all put in the first bucket.
+    */
+    template <class Contain> struct alignment_bucket;
+
+    template <class Type, std::size_t Index>
+        struct alignment_bucket <contain <Type, Index>>
+    {
+        static constexpr std::size_t alignment = storage_alignment <
+            typename utility::storage::store <Type>::type>::value;
+        static constexpr std::size_t value =
+            alignment > 8 ? 0 : alignment == 8 ? 1 : alignment == 4 ? 2
+                : alignment == 2 ? 3 : 4;
+    };
+
+    template <std::size_t Bucket, class Contains> struct select_bucket;
+
+    template <std::size_t Bucket, class ... Contains>
+        struct select_bucket <Bucket, meta::vector <Contains ...>>
+    : join_vectors <typename std::conditional <
+        alignment_bucket <Contains>::value == Bucket,
+        meta::vector <Contains>, meta::vector<>>::type ...> {};
+
+    /**
+    Sort "contain" classes by decreasing alignment.
+    The sort is stable, and takes O(N) template instantiations.
+    */
+    template <class Contains> struct sort_by_alignment
+    : join_vectors <
+        typename select_bucket <0, Contains>::type,
+        typename select_bucket <1, Contains>::type,
+        typename select_bucket <2, Contains>::type,
+        typename select_bucket <3, Contains>::type,
+        typename select_bucket <4, Contains>::type> {};
+
+    template <class Natural, class Contains> struct make_reordered_elements;
+
+    template <class Natural, class ... Contains>
+        struct make_reordered_elements <Natural, meta::vector <Contains ...>>
+    { typedef reordered_elements <Natural, Contains ...> type; };
+
+    /**
+    Evaluate to the type that holds the elements of tuple <Types ...>.
+    This is elements <Types ...> unless sorting the elements by alignment
+    changes the order, and all elements can be moved without throwing.
+    */
+    template <class ... Types> struct storage {
+        typedef elements <Types ...> natural_type;
+
+        typedef typename natural_contains <meta::vector <Types ...>,
+            typename meta::count <sizeof... (Types)>::type>::type
+            natural_order;
+        typedef typename sort_by_alignment <natural_order>::type sorted_order;
+
+        typedef typename std::conditional <
+            !std::is_same <natural_order, sorted_order>::value
+            && meta::all_of_c <std::is_nothrow_move_constructible <
+                typename utility::storage::store <Types>::type>::value ...
+                >::value,
+            typename make_reordered_elements <natural_type, sorted_order>::type,
+            natural_type>::type type;
+    };
+
     template <class Dummy> struct dummy {};
 
 } // namespace tuple_detail
@@ -559,7 +876,10 @@ namespace tuple_detail {
 tuple itself.
 */
 template <class ... Types> class tuple {
-    typedef tuple_detail::elements <Types ...> elements_type;
+    // Used for type traits and for the natural order.
+    typedef tuple_detail::elements <Types ...> natural_elements_type;
+    // The actual storage, which may be in a different order.
+    typedef typename tuple_detail::storage <Types ...>::type elements_type;
     elements_type elements_;
 
     elements_type & elements() { return elements_; }
@@ -575,7 +895,7 @@ template <class ... Types> class tuple {
     {};
 
     template <class Range> struct range_is_convertible_impl
-    : elements_type::template range_is_convertible <typename
+    : natural_elements_type::template range_is_convertible <typename
         range::result_of <callable::view_once (Range, direction::front)>::type>
     {};
     template <class Range> struct range_is_convertible
@@ -584,7 +904,7 @@ template <class ... Types> class tuple {
         range_is_convertible_impl <Range>> {};
 
     template <class Range> struct range_is_constructible_impl
-    : elements_type::template range_is_constructible <typename
+    : natural_elements_type::template range_is_constructible <typename
         range::result_of <callable::view_once (Range, direction::front)>::type>
     {};
     template <class Range> struct range_is_constructible
@@ -599,7 +919,7 @@ template <class ... Types> class tuple {
     > {};
 
     template <class Range> struct range_is_assignable_impl
-    : elements_type::template range_is_assignable <typename
+    : natural_elements_type::template range_is_assignable <typename
         range::result_of <callable::view_once (Range, direction::front)>::type>
     {};
     template <class Range> struct range_is_assignable
@@ -614,7 +934,8 @@ template <class ... Types> class tuple {
     is \c dummy_type.
     This is used to conditionally enable the copy constructor.
     */
-    typedef typename std::conditional <elements_type::is_copy_assignable,
+    typedef typename std::conditional <
+        natural_elements_type::is_copy_assignable,
         tuple, dummy_type>::type tuple_if_copy_assignable;
 
     /**
@@ -622,7 +943,8 @@ template <class ... Types> class tuple {
     is \c dummy_type.
     This is used to conditionally enable the move constructor.
     */
-    typedef typename std::conditional <elements_type::is_move_assignable,
+    typedef typename std::conditional <
+        natural_elements_type::is_move_assignable,
         tuple, dummy_type>::type tuple_if_move_assignable;
 
 public:
@@ -669,8 +991,9 @@ public:
             not_this_tuple <Range>, is_range <Range>,
             range_is_convertible <Range>>>::type>
     tuple (Range && range, dummy_type = dummy_type())
-    : elements_ (tuple_detail::from_range(), elements_type::maybe_chop (
-        view_once (std::forward <Range> (range), front)))
+    : elements_ (tuple_detail::from_range(),
+        natural_elements_type::maybe_chop (
+            view_once (std::forward <Range> (range), front)))
     {}
 
     /**
@@ -691,8 +1014,9 @@ public:
             range_is_constructible_but_not_convertible <Range>
         >>::type>
     explicit tuple (Range && range)
-    : elements_ (tuple_detail::from_range(), elements_type::maybe_chop (
-        view_once (std::forward <Range> (range), front)))
+    : elements_ (tuple_detail::from_range(),
+        natural_elements_type::maybe_chop (
+            view_once (std::forward <Range> (range), front)))
     {}
 
     /**
@@ -998,6 +1322,36 @@ tuple_view: the lightweight view of tuple.
 
 namespace tuple_detail {
 
+    /**
+    Compute the result type of a fold over elements of types \a Types, with
+    initial state type \a State.
+    This follows the state types directly along the element types, which is
+    linear in the number of elements, and does not require any intermediate
+    views or sets of steps to be instantiated.
+    */
+    template <class State, class Function, class Types> struct fold_state;
+
+    /*
+    With no elements, the initial state is returned.
+    As for fold in general, it is returned as a temporary, even if it was
+    passed in as a reference.
+    */
+    template <class State, class Function>
+        struct fold_state <State, Function, meta::vector<>>
+    { typedef typename std::decay <State>::type type; };
+
+    // The result type of the last step is used exactly.
+    template <class State, class Function, class Last>
+        struct fold_state <State, Function, meta::vector <Last>>
+    : result_of <Function (State &&, Last)> {};
+
+    template <class State, class Function,
+            class First, class Second, class ... Rest>
+        struct fold_state <State, Function,
+            meta::vector <First, Second, Rest ...>>
+    : fold_state <typename result_of <Function (State &&, First)>::type,
+        Function, meta::vector <Second, Rest ...>> {};
+
     template <std::size_t Begin, std::size_t End, class TupleReference>
         class tuple_view
     {
@@ -1094,9 +1448,41 @@ namespace tuple_detail {
             const
         { return Result (tuple()); }
 
-        // It would be possible to specialised "fold" to improve compile times.
-        // However, the return type must still be computed, so the improvement
-        // would not be great.
+        /* fold. */
+        /*
+        The default implementation of fold goes through all intermediate views,
+        and computes the set of all steps to find the result type.
+        For tuples, the elements are known at compile time, so the state can be
+        passed along the element indices directly.
+        */
+        template <class Result, class State, class Function>
+            Result fold_from (std::integral_constant <std::size_t, view_size>,
+                State && state, Function &&) const
+        { return std::forward <State> (state); }
+
+        template <class Result, std::size_t Index, class State, class Function>
+            Result fold_from (std::integral_constant <std::size_t, Index>,
+                State && state, Function && function) const
+        {
+            return fold_from <Result> (
+                std::integral_constant <std::size_t, Index + 1>(),
+                function (std::forward <State> (state),
+                    extract <((tuple_size - begin_position - 1) - Index)>() (
+                        tuple())),
+                std::forward <Function> (function));
+        }
+
+        template <class State, class Function, class View = tuple_view,
+            class Result = typename fold_state <State, Function,
+                typename types <View>::type>::type>
+        Result fold (State && state, direction::front, Function && function)
+            const
+        {
+            return fold_from <Result> (
+                std::integral_constant <std::size_t, 0>(),
+                std::forward <State> (state),
+                std::forward <Function> (function));
+        }
 
         /* for_each. */
         /// Call a function, and return an int.
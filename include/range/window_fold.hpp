@@ -0,0 +1,285 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Define window_fold, which computes an aggregate over each window of consecutive
+elements of a range, and updates it incrementally.
+Also define aggregates that can be used with it.
+*/
+
+#ifndef RANGE_WINDOW_FOLD_HPP_INCLUDED
+#define RANGE_WINDOW_FOLD_HPP_INCLUDED
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "utility/returns.hpp"
+
+#include "rime/assert.hpp"
+
+#include "core.hpp"
+#include "helper/with_direction.hpp"
+
+namespace range {
+
+/**
+Aggregate for window_fold that keeps the sum of the elements in the window.
+Each step costs one addition and one subtraction.
+With floating-point numbers, rounding errors can accumulate over long ranges.
+*/
+template <class Value> class window_sum {
+    Value sum_;
+
+public:
+    explicit window_sum (Value const & zero = Value()) : sum_ (zero) {}
+
+    template <class Element> void push (Element const & element)
+    { sum_ += element; }
+
+    template <class Element> void pop (Element const & element)
+    { sum_ -= element; }
+
+    Value const & value() const { return sum_; }
+};
+
+/**
+Aggregate for window_fold that keeps the smallest element in the window,
+according to \a Less.
+
+A monotonic deque is kept: it contains the elements that can still become the
+minimum, in increasing order.
+A new element removes all elements that are not smaller than it from the back.
+Each element is therefore added and removed at most once, so that each step
+costs amortised constant time.
+*/
+template <class Value, class Less = std::less <Value>> class window_min {
+    // The number of the element and its value.
+    std::deque <std::pair <std::size_t, Value>> candidates_;
+    std::size_t pushed_;
+    std::size_t popped_;
+    Less less_;
+
+public:
+    explicit window_min (Less const & less = Less())
+    : pushed_ (0), popped_ (0), less_ (less) {}
+
+    template <class Element> void push (Element && element) {
+        while (!candidates_.empty()
+                && !less_ (candidates_.back().second, element))
+            candidates_.pop_back();
+        candidates_.emplace_back (pushed_, std::forward <Element> (element));
+        ++ pushed_;
+    }
+
+    /// The value of the element is not used.
+    template <class Element> void pop (Element const &) {
+        rime::assert_ (popped_ != pushed_);
+        if (candidates_.front().first == popped_)
+            candidates_.pop_front();
+        ++ popped_;
+    }
+
+    Value const & value() const {
+        rime::assert_ (!candidates_.empty());
+        return candidates_.front().second;
+    }
+};
+
+namespace window_fold_detail {
+
+    template <class Less> struct greater {
+        Less less;
+
+        template <class Left, class Right>
+            bool operator() (Left const & left, Right const & right) const
+        { return less (right, left); }
+    };
+
+} // namespace window_fold_detail
+
+/**
+Aggregate for window_fold that keeps the largest element in the window,
+according to \a Less.
+This uses a monotonic deque, like window_min.
+*/
+template <class Value, class Less = std::less <Value>> class window_max
+: public window_min <Value, window_fold_detail::greater <Less>>
+{
+public:
+    explicit window_max (Less const & less = Less())
+    : window_min <Value, window_fold_detail::greater <Less>> (
+        window_fold_detail::greater <Less> {less}) {}
+};
+
+template <class Underlying, class Aggregate, class Direction>
+    class window_fold_range;
+
+namespace window_fold_operation {
+    struct window_fold_range_tag {};
+} // namespace window_fold_operation
+
+template <class Underlying, class Aggregate, class Direction>
+    struct tag_of_qualified <window_fold_range <Underlying, Aggregate, Direction>>
+{ typedef window_fold_operation::window_fold_range_tag type; };
+
+/**
+Range of the values of an aggregate over each window of an underlying view.
+Two views of the underlying view are kept: one at the next element to enter
+the window, and one at the oldest element in the window.
+*/
+template <class Underlying, class Aggregate, class Direction>
+    class window_fold_range
+: public helper::with_default_direction <Direction>
+{
+    static_assert (range::is_view <Underlying, Direction>::value,
+        "Underlying range must be a view in Direction");
+public:
+    typedef typename std::decay <decltype (
+        std::declval <Aggregate const &>().value())>::type value_type;
+
+    window_fold_range (Underlying const & underlying, std::size_t window_size,
+        Aggregate const & aggregate, Direction const & direction)
+    : helper::with_default_direction <Direction> (direction),
+        leading_ (underlying), trailing_ (underlying), aggregate_ (aggregate)
+    {
+        rime::assert_ (window_size != 0);
+        for (std::size_t i = 1;
+                i != window_size && !range::empty (leading_, direction); ++ i)
+            aggregate_.push (range::chop_in_place (leading_, direction));
+    }
+
+    /// \return The aggregate over the elements before the next window.
+    Aggregate const & aggregate() const { return aggregate_; }
+
+private:
+    Underlying leading_;
+    Underlying trailing_;
+    Aggregate aggregate_;
+
+    friend class helper::member_access;
+
+    auto empty (Direction const & direction) const
+    RETURNS (range::empty (leading_,
+        this->direction_must_be_equal (direction)));
+
+    template <class Underlying2 = Underlying, class Enable = decltype (
+        range::size (std::declval <Underlying2 const &>(),
+            std::declval <Direction>()))>
+    auto size (Direction const & direction) const
+    RETURNS (range::size (leading_,
+        this->direction_must_be_equal (direction)));
+
+    value_type chop_in_place (Direction const & direction) {
+        rime::assert_ (!range::empty (leading_, direction));
+        aggregate_.push (range::chop_in_place (leading_, direction));
+        value_type result = aggregate_.value();
+        aggregate_.pop (range::chop_in_place (trailing_, direction));
+        return result;
+    }
+};
+
+namespace callable {
+
+    struct window_fold {
+    private:
+        struct dispatch {
+            template <class View, class Aggregate, class Direction>
+                auto operator() (View && view, std::size_t window_size,
+                    Aggregate && aggregate, Direction const & direction) const
+            RETURNS (window_fold_range <typename std::decay <View>::type,
+                typename std::decay <Aggregate>::type, Direction> (
+                    std::forward <View> (view), window_size,
+                    std::forward <Aggregate> (aggregate), direction));
+        };
+
+    public:
+        template <class Range, class Aggregate, class Direction,
+            class Enable = typename
+                std::enable_if <is_direction <Direction>::value>::type>
+        auto operator() (Range && range, std::size_t window_size,
+            Aggregate && aggregate, Direction const & direction) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range), direction),
+            window_size, std::forward <Aggregate> (aggregate), direction));
+
+        template <class Range, class Aggregate, class Enable =
+            typename std::enable_if <is_range <Range>::value>::type>
+        auto operator() (Range && range, std::size_t window_size,
+            Aggregate && aggregate) const
+        RETURNS (dispatch() (
+            range::view (std::forward <Range> (range),
+                range::default_direction (range)),
+            window_size, std::forward <Aggregate> (aggregate),
+            range::default_direction (range)));
+    };
+
+} // namespace callable
+
+/**
+Compute an aggregate over each window of \a window_size consecutive elements of
+a range, updating it incrementally.
+
+The result contains one value for each window, like
+<c>transform (sliding_window (range, window_size), f)</c> would.
+However, instead of traversing each window, the aggregate is updated as the
+window slides: the element that enters the window is pushed, and the element
+that leaves the window is popped.
+With the aggregates that are provided, this costs amortised constant time per
+element, independent of \a window_size.
+
+\code
+std::vector <double> prices = ...;
+// Moving sum over the last 20 elements.
+RANGE_FOR_EACH (sum, window_fold (prices, 20, window_sum <double>()))
+    std::cout << sum / 20 << '\n';
+// Minimum over the last 20 elements.
+auto minima = window_fold (prices, 20, window_min <double>());
+\endcode
+
+The aggregate is an object with three member functions:
+\li <c>push (element)</c> adds the element that enters the window.
+\li <c>pop (element)</c> removes the oldest element in the window.
+    It is passed that element, which it can use or ignore.
+\li <c>value()</c> returns the current aggregate.
+
+\ref window_sum, \ref window_min and \ref window_max are provided.
+
+The result is a range that can only be traversed with chop_in_place(), as
+RANGE_FOR_EACH does, since updating the aggregate changes it in place.
+If the underlying view has a size, then so does the result.
+
+The underlying view is traversed twice, by two copies of it, each of which is
+traversed with chop_in_place().
+It must therefore be copyable, and copies must be independent.
+A \ref buffer, for example, works: it keeps the elements in the window in
+memory.
+
+\param range The range to compute the aggregates over.
+\param window_size The number of elements in each window.
+    This must be greater than zero.
+    If the range has fewer elements, the result is empty.
+\param aggregate The initial aggregate, which is copied.
+\param direction (Optional) The direction in which to traverse the range.
+    The default is the default direction of the range.
+*/
+static auto const window_fold = callable::window_fold();
+
+} // namespace range
+
+#endif // RANGE_WINDOW_FOLD_HPP_INCLUDED
@@ -0,0 +1,232 @@
+# Copyright 2015 Rogier van Dalen.
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# This script should run under Python 2 and 3 without modification.
+
+"""
+Measure the compile time and memory use of the heavy template machinery.
+
+For a number of benchmarks, a translation unit is generated for each size in
+a sweep, and compiled with the compiler given.
+The user time, system time, and peak memory use of the compiler are recorded
+and written out as comma-separated values, one line per translation unit.
+
+The benchmarks are:
+    tuple: construct a range::tuple of N different types; compare it with
+        ==, <; and extract every element with at_c.
+    zip: zip N std::vector's and iterate over the result with fold.
+    fold: fold over a range::tuple of N elements of alternating types, with a
+        state whose type changes on every step.
+
+Example use, from the root directory of range-test, which contains the
+dependencies as subdirectories:
+
+    python range/test/compile_time/benchmark.py \\
+        --include range/include --include rime/include \\
+        --include meta/include --include utility/include \\
+        --output compile_time.csv
+
+The results from two runs (say, before and after a change) can then be
+compared with a spreadsheet or any plotting tool.
+The script itself only measures; it does not judge.
+"""
+
+import argparse
+import csv
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# Element types used in heterogeneous tuples, in rotation.
+element_types = ['int', 'double', 'char', 'float', 'short', 'long']
+
+file_header = """
+// Generated by test/compile_time/benchmark.py. Do not edit.
+"""
+
+def tuple_source (size):
+    types = [element_types [i % len (element_types)] for i in range (size)]
+    values = ['%s (%d)' % (type, i) for i, type in enumerate (types)]
+    extract = '\n'.join (
+        '    result += double (range::at_c <%d> (t1));' % i
+        for i in range (size))
+    return file_header + """
+#include "range/tuple.hpp"
+
+int main() {
+    range::tuple <%(types)s> t1 (%(values)s);
+    range::tuple <%(types)s> t2 = t1;
+    double result = 0;
+    result += (t1 == t2);
+    result += (t1 < t2);
+%(extract)s
+    return result == 0;
+}
+""" % {'types': ', '.join (types), 'values': ', '.join (values),
+        'extract': extract}
+
+def zip_source (size):
+    declarations = '\n'.join (
+        '    std::vector <int> v%d (10, %d);' % (i, i) for i in range (size))
+    sum = ' + '.join (
+        'range::at_c <%d> (element)' % i for i in range (size))
+    return file_header + """
+#include <vector>
+
+#include "range/std.hpp"
+#include "range/zip.hpp"
+#include "range/fold.hpp"
+
+struct add_elements {
+    template <class Element>
+        int operator() (int state, Element const & element) const
+    { return state + %(sum)s; }
+};
+
+int main() {
+%(declarations)s
+    return range::fold (0, range::zip (%(vectors)s), add_elements()) == 0;
+}
+""" % {'declarations': declarations, 'sum': sum,
+        'vectors': ', '.join ('v%d' % i for i in range (size))}
+
+def fold_source (size):
+    types = [element_types [i % 2] for i in range (size)]
+    values = ['%s (%d)' % (type, i) for i, type in enumerate (types)]
+    return file_header + """
+#include "range/tuple.hpp"
+#include "range/fold.hpp"
+
+// The state type depends on the number of elements seen so far, so that the
+// fold is heterogeneous all the way through.
+template <int Step> struct state { double value; };
+
+struct add_element {
+    template <int Step, class Element>
+        state <Step + 1> operator() (state <Step> s, Element const & e) const
+    { return state <Step + 1> {s.value + e}; }
+};
+
+int main() {
+    range::tuple <%(types)s> t (%(values)s);
+    auto result = range::fold (state <0> {0.}, t, add_element());
+    return result.value == 0;
+}
+""" % {'types': ', '.join (types), 'values': ', '.join (values)}
+
+benchmarks = {
+    'tuple': tuple_source,
+    'zip': zip_source,
+    'fold': fold_source,
+}
+
+def parse_sizes (text):
+    """Parse "1,2,4" or "2:32:2" (start:stop:step, inclusive)."""
+    if ':' in text:
+        parts = [int (part) for part in text.split (':')]
+        start, stop = parts [0], parts [1]
+        step = parts [2] if len (parts) > 2 else 1
+        return list (range (start, stop + 1, step))
+    return [int (part) for part in text.split (',')]
+
+def compile_file (command, source_file, object_file):
+    """
+    Run the compiler and return (succeeded, user time, system time, wall time,
+    peak memory in kilobytes).
+    The resource usage is that of the compiler process alone, as reported by
+    wait4.
+    """
+    full_command = command + ['-c', source_file, '-o', object_file]
+    start = time.time()
+    with open (os.devnull, 'w') as null:
+        process = subprocess.Popen (full_command, stdout = null,
+            stderr = subprocess.PIPE)
+        # Read the error output before waiting, so that the pipe does not
+        # fill up and block the compiler.
+        errors = process.stderr.read()
+        _, status, usage = os.wait4 (process.pid, 0)
+    wall_time = time.time() - start
+    # Make sure that Popen does not try to reap the process again.
+    process.returncode = status
+    if status != 0:
+        sys.stderr.write (errors.decode ('utf-8', 'replace'))
+    return (status == 0, usage.ru_utime, usage.ru_stime, wall_time,
+        usage.ru_maxrss)
+
+def main():
+    parser = argparse.ArgumentParser (
+        description = 'Measure compile time and memory for range.')
+    parser.add_argument ('--compiler', default = os.environ.get ('CXX', 'g++'))
+    parser.add_argument ('--flag', action = 'append', default = [],
+        help = 'Extra flag to pass to the compiler (repeatable).')
+    parser.add_argument ('--include', action = 'append', default = [],
+        help = 'Include directory (repeatable).')
+    parser.add_argument ('--benchmark', action = 'append',
+        choices = sorted (benchmarks.keys()),
+        help = 'Benchmark to run (repeatable; default: all).')
+    parser.add_argument ('--sizes', default = '1,2,4,8,12,16,24,32',
+        help = 'Sizes to sweep: "1,2,4" or "start:stop:step".')
+    parser.add_argument ('--repeat', type = int, default = 1,
+        help = 'Number of times to compile each file.')
+    parser.add_argument ('--output', default = '-',
+        help = 'Output CSV file; "-" for standard output.')
+    parser.add_argument ('--keep', action = 'store_true',
+        help = 'Keep the generated sources, and print where they are.')
+    arguments = parser.parse_args()
+
+    command = ([arguments.compiler, '-std=c++11']
+        + ['-I' + directory for directory in arguments.include]
+        + arguments.flag)
+    names = arguments.benchmark or sorted (benchmarks.keys())
+    sizes = parse_sizes (arguments.sizes)
+
+    directory = tempfile.mkdtemp (prefix = 'range-compile-time-')
+    if arguments.output == '-':
+        output_file = sys.stdout
+    else:
+        output_file = open (arguments.output, 'w')
+    try:
+        writer = csv.writer (output_file)
+        writer.writerow (['benchmark', 'size', 'run', 'success',
+            'user_seconds', 'system_seconds', 'wall_seconds',
+            'max_rss_kilobytes', 'object_bytes'])
+        for name in names:
+            for size in sizes:
+                source_file = os.path.join (directory,
+                    '%s-%d.cpp' % (name, size))
+                object_file = source_file [:-len ('.cpp')] + '.o'
+                with open (source_file, 'w') as file:
+                    file.write (benchmarks [name] (size))
+                for run in range (arguments.repeat):
+                    success, user, system, wall, memory = compile_file (
+                        command, source_file, object_file)
+                    object_size = (os.path.getsize (object_file)
+                        if success else 0)
+                    writer.writerow ([name, size, run, int (success),
+                        '%.3f' % user, '%.3f' % system, '%.3f' % wall,
+                        memory, object_size])
+                    output_file.flush()
+    finally:
+        if output_file is not sys.stdout:
+            output_file.close()
+        if arguments.keep:
+            sys.stderr.write ('Generated files are in %s\n' % directory)
+        else:
+            shutil.rmtree (directory)
+
+if __name__ == '__main__':
+    main()
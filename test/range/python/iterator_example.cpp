@@ -32,6 +32,12 @@ test-python_range.py.
 #include "range/std/container.hpp"
 #include "range/std/view_optional.hpp"
 #include "range/tuple.hpp"
+#include "range/function_range.hpp"
+#include "range/generator.hpp"
+
+#if !RANGE_HAS_GENERATOR && defined (RANGE_TEST_REQUIRE_COROUTINES)
+#error "This example was meant to be compiled with coroutines."
+#endif
 
 std::list <double> doubles;
 
@@ -49,6 +55,33 @@ boost::optional <bool> optional;
 
 auto get_optional() RETURNS (range::view_optional (optional));
 
+struct count_up {
+    int current;
+
+    int operator() () { return current ++; }
+};
+
+// The function range cannot be copied, so it is moved into the iterator.
+boost::python::object get_count() {
+    return range::python::make_iterator (
+        range::make_function_range (count_up {0}));
+}
+
+bool has_generator() { return RANGE_HAS_GENERATOR; }
+
+#if RANGE_HAS_GENERATOR
+
+range::generator <int> squares (int number) {
+    for (int i = 0; i != number; ++ i)
+        co_yield i * i;
+}
+
+// The generator is moved into the iterator, which resumes it from Python.
+boost::python::object get_squares (int number)
+{ return range::python::make_iterator (squares (number)); }
+
+#endif // RANGE_HAS_GENERATOR
+
 BOOST_PYTHON_MODULE (iterator_example) {
     doubles.push_back (3.5);
     doubles.push_back (7.25);
@@ -68,4 +101,9 @@ BOOST_PYTHON_MODULE (iterator_example) {
     def ("setFirstToDoubles", &set_first_to_doubles);
     def ("getTuple", &get_tuple);
     def ("getOptional", &get_optional);
+    def ("getCount", &get_count);
+    def ("hasGenerator", &has_generator);
+#if RANGE_HAS_GENERATOR
+    def ("getSquares", &get_squares);
+#endif
 }
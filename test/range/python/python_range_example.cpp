@@ -21,11 +21,19 @@ test-python_range.py.
 */
 
 #include <string>
+#include <stdexcept>
 
 #include <boost/python/module.hpp>
 #include <boost/python/def.hpp>
 
 #include "range/python/range.hpp"
+#include "range/python/gil.hpp"
+
+#include <vector>
+#include <functional>
+
+#include "range/std/container.hpp"
+#include "range/fold.hpp"
 
 using range::python_range;
 
@@ -224,6 +232,49 @@ void check_17_None_hi (python_range<> r) {
     assert (range::empty (r));
 }
 
+// Buffer protocol.
+bool is_contiguous (python_range <double> r) { return r.is_contiguous(); }
+
+bool is_contiguous_int (python_range <int> r) { return r.is_contiguous(); }
+
+void check_6_25_8_5_contiguous (python_range <double> r) {
+    assert (r.is_contiguous());
+    auto view = r.contiguous_view();
+    assert (range::size (view) == 2);
+    assert (range::first (view) == 6.25);
+    assert (range::second (view) == 8.5);
+
+    // The view starts at the current position.
+    r = range::drop (std::move (r));
+    assert (r.is_contiguous());
+    assert (range::size (r.contiguous_view()) == 1);
+    assert (range::first (r.contiguous_view()) == 8.5);
+}
+
+int sum_bytes (python_range <unsigned char> r) {
+    int sum = 0;
+    while (!range::empty (r))
+        sum += range::chop_in_place (r);
+    return sum;
+}
+
+// Release the GIL.
+struct sum_vector {
+    double operator() (std::vector <double> const & values) const
+    { return range::fold (0., values, std::plus <double>()); }
+};
+
+double sum_without_gil (python_range <double> r) {
+    std::vector <double> values = range::python::materialise <double> (r);
+    return range::python::call_without_gil (sum_vector(), values);
+}
+
+void throw_runtime_error() { throw std::runtime_error ("Error."); }
+
+// The GIL must be reacquired when an exception is thrown.
+void throw_without_gil()
+{ range::python::call_without_gil (throw_runtime_error); }
+
 boost::python::handle<> test_return_something() {
     boost::python::object o (1);
     return boost::python::handle<> (boost::python::incref (o.ptr()));
@@ -234,6 +285,8 @@ BOOST_PYTHON_MODULE (python_range_example) {
 
     range::python::convert_object_to_range <python_range <>>();
     range::python::convert_object_to_range <python_range <double>>();
+    range::python::convert_object_to_range <python_range <int>>();
+    range::python::convert_object_to_range <python_range <unsigned char>>();
     range::python::convert_object_to_range <python_range <int, std::string>>();
     range::python::convert_object_to_range <
         python_range <int, std::string, char, double>>();
@@ -260,5 +313,13 @@ BOOST_PYTHON_MODULE (python_range_example) {
 
     def ("check_17_None_hi", check_17_None_hi);
 
+    def ("is_contiguous", is_contiguous);
+    def ("is_contiguous_int", is_contiguous_int);
+    def ("check_6_25_8_5_contiguous", check_6_25_8_5_contiguous);
+    def ("sum_bytes", sum_bytes);
+
+    def ("sum_without_gil", sum_without_gil);
+    def ("throw_without_gil", throw_without_gil);
+
     def ("test_return_something", test_return_something);
 }
@@ -32,6 +32,7 @@ test-python_range.py.
 #include "range/function_range.hpp"
 #include "range/std/container.hpp"
 #include "range/tuple.hpp"
+#include "range/transform.hpp"
 
 auto count (int size) RETURNS (range::count (size));
 
@@ -63,6 +64,27 @@ public:
     { return t; }
 };
 
+std::vector <float> floats() {
+    std::vector <float> result;
+    result.push_back (1.5f);
+    result.push_back (2.5f);
+    result.push_back (-4.f);
+    return result;
+}
+
+struct halve {
+    double operator() (int i) const { return i / 2.; }
+};
+
+// A view that is not contiguous, and converts elements.
+auto halves (int size) RETURNS (range::transform (range::count (size), halve()));
+
+struct is_even {
+    bool operator() (int i) const { return i % 2 == 0; }
+};
+
+auto bools() RETURNS (range::transform (range::count (2), is_even()));
+
 int test();
 
 BOOST_PYTHON_MODULE (return_view_example) {
@@ -75,9 +97,16 @@ BOOST_PYTHON_MODULE (return_view_example) {
 
     def ("count2", &count2, range::python::return_view<>());
 
+    def ("count_array", &count, range::python::return_view_as_array<>());
+    def ("floats", &floats, range::python::return_view_as_array<>());
+    def ("halves", &halves, range::python::return_view_as_array<>());
+    def ("bools", &bools, range::python::return_view_as_array<>());
+
     class_ <container_container> ("ContainerContainer")
         .def ("get_17_19", &container_container::get_17_19,
             range::python::return_view_of_internal_reference <1>())
+        .def ("get_17_19_array", &container_container::get_17_19,
+            range::python::return_view_as_array<>())
         .def ("get_tuple", &container_container::get_tuple,
             range::python::return_view_of_internal_reference <1>());
 }
@@ -31,3 +31,29 @@ assert (l == [6, "hello", 17.5])
 l = list (getOptional())
 print (l)
 assert (l == [True])
+
+# Batches.
+i = iter (getDoubles())
+assert (i.next_batch (1) == [3.5])
+assert (i.next_batch (5) == [7.25])
+assert (i.next_batch (5) == [])
+
+i = iter (getTuple())
+assert (i.next_batch (0) == [])
+assert (i.next_batch (2) == [6, "hello"])
+assert (next (i) == 17.5)
+assert (i.next_batch (2) == [])
+
+# A range that can only be moved.
+i = getCount()
+assert (next (i) == 0)
+assert (i.next_batch (3) == [1, 2, 3])
+assert (next (iter (i)) == 4)
+
+# A coroutine generator, which can also only be moved.
+if hasGenerator():
+    i = getSquares (5)
+    assert (next (i) == 0)
+    assert (i.next_batch (3) == [1, 4, 9])
+    assert (list (i) == [16])
+    assert (list (getSquares (0)) == [])
@@ -81,6 +81,68 @@ check_hello_5_bye_27 ([
 
 check_17_None_hi ([17, None, "hi"]);
 
+# Buffer protocol.
+import array
+import sys
+
+doubles = array.array ('d', [6.25, 8.5])
+assert not is_contiguous ([6.25, 8.5])
+check_6_25_8_5 (doubles)
+check_6_25_8_5_chop (doubles)
+check_6_25_8_5_chop_in_place (doubles)
+check_empty_2 (array.array ('d'))
+# Under Python 2, array.array does not support the new buffer protocol.
+if sys.version_info [0] >= 3:
+    assert is_contiguous (doubles)
+    check_6_25_8_5_contiguous (doubles)
+    check_6_25_8_5 (memoryview (doubles))
+
+# The element type must match exactly; otherwise the iterator is used.
+assert not is_contiguous (array.array ('f', [6.25, 8.5]))
+check_6_25_8_5 (array.array ('f', [6.25, 8.5]))
+assert not is_contiguous_int (array.array ('d', [1, 2]))
+
+assert sum_bytes (b'\x01\x02\x03') == 6
+assert sum_bytes (bytearray ([4, 5])) == 9
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+if numpy is not None:
+    a = numpy.array ([6.25, 8.5], dtype = numpy.float64)
+    assert is_contiguous (a)
+    check_6_25_8_5_contiguous (a)
+    # Not contiguous: fall back to the iterator protocol.
+    b = numpy.array ([6.25, 0, 8.5], dtype = numpy.float64) [::2]
+    assert not is_contiguous (b)
+    check_6_25_8_5 (b)
+    # Two-dimensional arrays are iterated over row by row, so they do not
+    # match.
+    assert not is_contiguous (numpy.zeros ((2, 2)))
+
+# Release the GIL.
+assert sum_without_gil ([1.5, 2.5]) == 4.
+assert sum_without_gil (array.array ('d', [1.5, 2.5, 3.])) == 7.
+assert sum_without_gil ([]) == 0.
+try:
+    throw_without_gil()
+    assert False
+except RuntimeError:
+    pass
+
+import threading
+results = []
+def sum_in_thread():
+    results.append (sum_without_gil (float (i) for i in range (1000)))
+threads = [threading.Thread (target = sum_in_thread) for _ in range (4)]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+assert results == [499500.] * 4
+
 # Break things.
 
 # Check that iter(5) throws a TypeError.
@@ -16,6 +16,8 @@
 
 from return_view_example import *
 
+import array
+
 def test_count():
     for index1, index2 in enumerate (count (10)):
         assert (index1 == index2)
@@ -66,3 +68,30 @@ test_count2()
 
 test_return_internal_reference_1()
 test_return_internal_reference_2()
+
+def test_return_array():
+    a = count_array (4)
+    assert (isinstance (a, array.array))
+    assert (a.tolist() == [0, 1, 2, 3])
+
+    a = floats()
+    assert (a.typecode == 'f')
+    assert (a.tolist() == [1.5, 2.5, -4.])
+
+    a = halves (5)
+    assert (a.typecode == 'd')
+    assert (a.tolist() == [0, .5, 1, 1.5, 2])
+
+    a = halves (0)
+    assert (len (a) == 0)
+
+    a = bools()
+    assert (a.tolist() == [1, 0])
+
+    c = ContainerContainer()
+    a = c.get_17_19_array()
+    # This is a copy.
+    del c
+    assert (a.tolist() == [17, 19])
+
+test_return_array()
@@ -0,0 +1,194 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_async
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/async.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "range/buffer.hpp"
+#include "range/count.hpp"
+#include "range/std/container.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_async)
+
+#if RANGE_HAS_COROUTINES
+
+using range::make_buffer;
+using range::make_async_buffer;
+using range::async_chop;
+using range::async_for_each;
+using range::async_fold;
+using range::sync_wait;
+using range::task;
+
+/// Executor that calls functions immediately.
+struct inline_executor {
+    template <class Function> void execute (Function && function) const
+    { function(); }
+};
+
+/// Executor with a fixed number of threads.
+class thread_pool {
+    struct state {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque <std::function <void()>> queue;
+        bool stop;
+        std::vector <std::thread> threads;
+
+        state() : stop (false) {}
+
+        void run() {
+            while (true) {
+                std::function <void()> function;
+                {
+                    std::unique_lock <std::mutex> lock (mutex);
+                    condition.wait (lock,
+                        [this] { return stop || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+                    function = std::move (queue.front());
+                    queue.pop_front();
+                }
+                function();
+            }
+        }
+    };
+
+    std::shared_ptr <state> state_;
+
+public:
+    explicit thread_pool (std::size_t thread_num)
+    : state_ (std::make_shared <state>()) {
+        for (std::size_t i = 0; i != thread_num; ++ i)
+            state_->threads.emplace_back ([s = state_.get()] { s->run(); });
+    }
+
+    void join() {
+        {
+            std::lock_guard <std::mutex> lock (state_->mutex);
+            state_->stop = true;
+        }
+        state_->condition.notify_all();
+        for (std::thread & thread : state_->threads)
+            thread.join();
+    }
+
+    template <class Function> void execute (Function && function) const {
+        {
+            std::lock_guard <std::mutex> lock (state_->mutex);
+            state_->queue.emplace_back (std::forward <Function> (function));
+        }
+        state_->condition.notify_one();
+    }
+};
+
+task <int> add (int left, int right) { co_return left + right; }
+
+task <int> add_three (int a, int b, int c) {
+    int partial = co_await add (a, b);
+    co_return co_await add (partial, c);
+}
+
+task <void> fail() {
+    throw std::runtime_error ("Task failed.");
+    co_return;
+}
+
+BOOST_AUTO_TEST_CASE (test_task) {
+    BOOST_CHECK_EQUAL (sync_wait (add_three (1, 2, 3)), 6);
+    BOOST_CHECK_THROW (sync_wait (fail()), std::runtime_error);
+}
+
+task <std::vector <int>> collect (range::buffer <int> const & source) {
+    inline_executor executor;
+    auto r = make_async_buffer (source, executor);
+    std::vector <int> result;
+    while (auto element = co_await async_chop (r))
+        result.push_back (*element);
+    co_return result;
+}
+
+BOOST_AUTO_TEST_CASE (test_async_chop) {
+    std::vector <int> v;
+    for (int i = 0; i != 10; ++ i)
+        v.push_back (i * i);
+
+    // Chunks of three elements, so that new chunks must be requested.
+    auto source = make_buffer <int, 3> (v);
+    std::vector <int> result = sync_wait (collect (source));
+    BOOST_CHECK (result == v);
+    // The buffer itself is not changed.
+    BOOST_CHECK_EQUAL (range::first (source), 0);
+}
+
+BOOST_AUTO_TEST_CASE (test_async_inline) {
+    inline_executor executor;
+    // Many chunks: the stack should not grow with each.
+    auto numbers = make_buffer <std::size_t, 4> (range::count (100000));
+    std::size_t total = sync_wait (async_fold (std::size_t (0),
+        make_async_buffer (numbers, executor),
+        [] (std::size_t sum, std::size_t i) { return sum + i; }, executor));
+    BOOST_CHECK_EQUAL (total, std::size_t (99999) * 100000 / 2);
+
+    std::vector <std::size_t> elements;
+    sync_wait (async_for_each (make_async_buffer (numbers, executor),
+        [&elements] (std::size_t i) { elements.push_back (i); }, executor));
+    BOOST_CHECK_EQUAL (elements.size(), 100000u);
+    BOOST_CHECK_EQUAL (elements.back(), 99999u);
+}
+
+BOOST_AUTO_TEST_CASE (test_async_thread_pool) {
+    thread_pool pool (3);
+    {
+        // Start many streams, and multiplex them on three threads.
+        std::vector <task <std::size_t>> tasks;
+        for (int i = 0; i != 20; ++ i) {
+            auto numbers = make_buffer <std::size_t, 8> (range::count (1000));
+            tasks.push_back (async_fold (std::size_t (0),
+                make_async_buffer (numbers, pool),
+                [] (std::size_t sum, std::size_t i) { return sum + i; },
+                pool));
+        }
+        for (auto & pending : tasks)
+            BOOST_CHECK_EQUAL (sync_wait (std::move (pending)),
+                999u * 1000 / 2);
+    }
+    pool.join();
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE (test_async_unavailable) {
+#ifdef RANGE_TEST_REQUIRE_COROUTINES
+    BOOST_ERROR ("This test was meant to be compiled with coroutines.");
+#endif
+    BOOST_CHECK (!RANGE_HAS_COROUTINES);
+}
+
+#endif // RANGE_HAS_COROUTINES
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_binary_file
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/binary_file.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "range/count.hpp"
+#include "range/for_each_macro.hpp"
+#include "range/std/container.hpp"
+
+using range::empty;
+using range::chop_in_place;
+
+BOOST_AUTO_TEST_SUITE(test_range_binary_file)
+
+struct record {
+    int key;
+    double value;
+};
+
+BOOST_AUTO_TEST_CASE (test_binary_file) {
+    auto temporary_file_name = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path();
+
+    {
+        range::binary_writer <record> writer (temporary_file_name.native());
+        RANGE_FOR_EACH (i, range::count (10000))
+            writer.write (record {int (i), i * .5});
+        std::vector <record> more = {{-1, 1.5}, {-2, 2.5}};
+        writer.write_range (more);
+        writer.flush();
+    }
+
+    {
+        auto records = range::read_binary_file <record> (
+            temporary_file_name.native());
+        RANGE_FOR_EACH (i, range::count (10000)) {
+            record r = chop_in_place (records);
+            BOOST_CHECK_EQUAL (r.key, int (i));
+            BOOST_CHECK_EQUAL (r.value, i * .5);
+        }
+        BOOST_CHECK_EQUAL (chop_in_place (records).key, -1);
+        BOOST_CHECK_EQUAL (chop_in_place (records).value, 2.5);
+        BOOST_CHECK (empty (records));
+    }
+
+    {
+        // Decode records from bytes.
+        auto records = range::decode_binary <record> (
+            range::read_file (temporary_file_name.native()));
+        RANGE_FOR_EACH (i, range::count (10000))
+            BOOST_CHECK_EQUAL (chop_in_place (records).key, int (i));
+        BOOST_CHECK_EQUAL (chop_in_place (records).key, -1);
+        BOOST_CHECK_EQUAL (chop_in_place (records).key, -2);
+        BOOST_CHECK (empty (records));
+    }
+
+    // Append half a record.
+    {
+        std::ofstream f (temporary_file_name.native(),
+            std::ios_base::binary | std::ios_base::app);
+        f << 'x';
+    }
+    {
+        auto records = range::decode_binary <record> (
+            range::read_file (temporary_file_name.native()));
+        RANGE_FOR_EACH (i, range::count (10002))
+            chop_in_place (records);
+        BOOST_CHECK (!empty (records));
+        BOOST_CHECK_THROW (chop_in_place (records), range::file_read_error);
+    }
+
+    boost::filesystem::remove (temporary_file_name);
+}
+
+BOOST_AUTO_TEST_CASE (test_binary_file_error) {
+    BOOST_CHECK_THROW (range::read_binary_file <int> ("non_existing_file"),
+        range::file_open_error);
+    BOOST_CHECK_THROW (range::binary_writer <int> ("non/existing/directory"),
+        range::file_open_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -109,4 +109,50 @@ BOOST_AUTO_TEST_CASE (stack_overflow) {
     }
 }
 
+/**
+Generate 0, 1, 2, ... up to limit, at most five elements at a time, and count
+the calls.
+*/
+struct generate_numbers {
+    int next;
+    int limit;
+    int * calls;
+
+    std::size_t operator() (int * out, std::size_t max) {
+        ++ *calls;
+        std::size_t number = 0;
+        for (; number != max && number != 5 && next != limit; ++ number)
+            out [number] = next ++;
+        return number;
+    }
+};
+
+BOOST_AUTO_TEST_CASE (block_function_range) {
+    int calls = 0;
+    auto numbers = make_buffer <int, 8> (range::make_block_function_range
+        <int> (generate_numbers {0, 12, &calls}));
+    // The function writes directly to the first chunk.
+    BOOST_CHECK_EQUAL (calls, 1);
+
+    auto numbers2 = numbers;
+    RANGE_FOR_EACH (i, range::count (12)) {
+        BOOST_CHECK (!empty (numbers2));
+        BOOST_CHECK_EQUAL (chop_in_place (numbers2), int (i));
+    }
+    BOOST_CHECK (empty (numbers2));
+    // One call for each chunk of five elements, and one that returns 0.
+    BOOST_CHECK_EQUAL (calls, 4);
+    BOOST_CHECK_EQUAL (first (numbers), 0);
+
+    // Elements that were generated before make_buffer are not lost.
+    calls = 0;
+    auto generated = range::make_block_function_range <int> (
+        generate_numbers {0, 7, &calls}, 4);
+    BOOST_CHECK_EQUAL (chop_in_place (generated), 0);
+    auto rest = make_buffer (std::move (generated));
+    RANGE_FOR_EACH (i, range::count (1, 7))
+        BOOST_CHECK_EQUAL (chop_in_place (rest), int (i));
+    BOOST_CHECK (empty (rest));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
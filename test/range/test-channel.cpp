@@ -0,0 +1,117 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_channel
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/channel.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "range/count.hpp"
+#include "range/fold.hpp"
+#include "range/transform.hpp"
+#include "range/std/container.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_channel)
+
+using range::channel;
+using range::empty;
+using range::chop_in_place;
+
+BOOST_AUTO_TEST_CASE (test_channel_single_thread) {
+    channel <std::string> c (3);
+    BOOST_CHECK_EQUAL (c.capacity(), 4u);
+
+    BOOST_CHECK (c.try_push ("a"));
+    BOOST_CHECK (c.try_push ("b"));
+    BOOST_CHECK (c.try_push ("c"));
+    BOOST_CHECK (c.try_push ("d"));
+    // Full.
+    BOOST_CHECK (!c.try_push ("e"));
+
+    std::string element;
+    BOOST_CHECK (c.try_pop (element));
+    BOOST_CHECK_EQUAL (element, "a");
+    BOOST_CHECK (c.try_push ("e"));
+
+    std::string elements [8];
+    BOOST_CHECK_EQUAL (c.try_pop_n (elements, 8), 4u);
+    BOOST_CHECK_EQUAL (elements [0], "b");
+    BOOST_CHECK_EQUAL (elements [3], "e");
+    BOOST_CHECK (!c.try_pop (element));
+
+    std::string batch [3] = {"f", "g", "h"};
+    BOOST_CHECK_EQUAL (c.try_push_n (batch, 3), 3u);
+    c.close();
+
+    auto r = c.reader (2);
+    BOOST_CHECK_EQUAL (chop_in_place (r), "f");
+    BOOST_CHECK_EQUAL (chop_in_place (r), "g");
+    BOOST_CHECK (!empty (r));
+    BOOST_CHECK_EQUAL (chop_in_place (r), "h");
+    BOOST_CHECK (empty (r));
+}
+
+BOOST_AUTO_TEST_CASE (test_channel_destruct) {
+    // Elements left in the channel are destructed.
+    channel <std::string> c (16);
+    c.push ("left");
+    c.push (std::string (100, 'x'));
+}
+
+BOOST_AUTO_TEST_CASE (test_channel_threads) {
+    std::size_t const producer_num = 3;
+    std::size_t const consumer_num = 3;
+    std::size_t const number = 100000;
+
+    channel <std::size_t> c (64);
+
+    std::vector <std::thread> producers;
+    for (std::size_t p = 0; p != producer_num; ++ p) {
+        producers.emplace_back ([&c, p, number] {
+            c.push_range (range::count (p * number, (p + 1) * number), 16);
+        });
+    }
+
+    std::vector <std::size_t> sums (consumer_num, 0);
+    std::vector <std::thread> consumers;
+    for (std::size_t k = 0; k != consumer_num; ++ k) {
+        consumers.emplace_back ([&c, &sums, k] {
+            // A second pipeline stage.
+            sums [k] = range::fold (std::size_t (0),
+                range::transform (c.reader (8),
+                    [] (std::size_t i) { return 2 * i; }),
+                [] (std::size_t sum, std::size_t i) { return sum + i; });
+        });
+    }
+
+    for (std::thread & producer : producers)
+        producer.join();
+    c.close();
+    for (std::thread & consumer : consumers)
+        consumer.join();
+
+    std::size_t total = 0;
+    for (std::size_t sum : sums)
+        total += sum;
+    std::size_t const all = producer_num * number;
+    BOOST_CHECK_EQUAL (total, all * (all - 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
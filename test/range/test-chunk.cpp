@@ -0,0 +1,178 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_chunk
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/chunk.hpp"
+
+#include <array>
+#include <list>
+#include <vector>
+#include <type_traits>
+
+#include "range/std.hpp"
+#include "range/equal.hpp"
+#include "range/fold.hpp"
+#include "range/for_each_macro.hpp"
+
+#include "rime/check/check_equal.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_chunk)
+
+using range::chunk;
+using range::chunk_exact;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::third;
+using range::drop;
+using range::front;
+using range::back;
+using range::equal;
+using range::has;
+namespace callable = range::callable;
+
+BOOST_AUTO_TEST_CASE (test_chunk_vector) {
+    std::vector <int> v;
+    {
+        auto c = chunk (v, 2);
+        BOOST_CHECK (empty (c));
+        BOOST_CHECK_EQUAL (size (c), 0u);
+    }
+
+    for (int i = 1; i != 6; ++ i)
+        v.push_back (i);
+
+    auto c = chunk (v, 2);
+    BOOST_CHECK (!empty (c));
+    BOOST_CHECK_EQUAL (size (c), 3u);
+
+    // The chunks are views of the vector.
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (c)),
+        decltype (range::view (v))>));
+    BOOST_CHECK_EQUAL (size (first (c)), 2u);
+    BOOST_CHECK_EQUAL (first (first (c)), 1);
+    BOOST_CHECK_EQUAL (second (first (c)), 2);
+    BOOST_CHECK_EQUAL (first (second (c)), 3);
+    BOOST_CHECK_EQUAL (second (second (c)), 4);
+    BOOST_CHECK_EQUAL (size (third (c)), 1u);
+    BOOST_CHECK_EQUAL (first (third (c)), 5);
+    BOOST_CHECK (empty (drop (c, 3)));
+
+    // Elements can be changed through the chunks.
+    first (second (c)) = 30;
+    BOOST_CHECK_EQUAL (v [2], 30);
+
+    // Chunk size larger than the range.
+    auto c2 = chunk (v, 10);
+    BOOST_CHECK_EQUAL (size (c2), 1u);
+    BOOST_CHECK_EQUAL (size (first (c2)), 5u);
+
+    // Chunk size that divides the range exactly.
+    auto c3 = chunk (v, 5);
+    BOOST_CHECK_EQUAL (size (c3), 1u);
+    BOOST_CHECK (empty (drop (c3)));
+
+    // Back to front: the first chunk contains the last elements.
+    auto c4 = chunk (v, 2, back);
+    BOOST_CHECK_EQUAL (size (c4, back), 3u);
+    BOOST_CHECK_EQUAL (first (first (c4, back), back), 5);
+    BOOST_CHECK_EQUAL (second (first (c4, back), back), 4);
+    BOOST_CHECK_EQUAL (size (first (drop (c4, 2, back), back)), 1u);
+    BOOST_CHECK_EQUAL (first (first (drop (c4, 2, back), back)), 1);
+}
+
+BOOST_AUTO_TEST_CASE (test_chunk_list) {
+    // Without size, chunks are formed by dropping one element at a time.
+    std::list <int> l;
+    for (int i = 1; i != 8; ++ i)
+        l.push_back (i);
+
+    auto c = chunk (l, 3);
+    BOOST_MPL_ASSERT_NOT ((has <callable::size (decltype (c))>));
+
+    int chunk_count = 0;
+    int sum = 0;
+    RANGE_FOR_EACH (block, c) {
+        ++ chunk_count;
+        RANGE_FOR_EACH (element, block)
+            sum += element;
+    }
+    BOOST_CHECK_EQUAL (chunk_count, 3);
+    BOOST_CHECK_EQUAL (sum, 28);
+
+    BOOST_CHECK_EQUAL (first (first (drop (c, 2))), 7);
+}
+
+BOOST_AUTO_TEST_CASE (test_chunk_exact) {
+    std::vector <int> v;
+    for (int i = 1; i != 8; ++ i)
+        v.push_back (i);
+
+    auto c = chunk_exact (v, rime::size_t <3>());
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (c)),
+        std::array <int, 3>>));
+    // The seventh element is not visited.
+    BOOST_CHECK_EQUAL (size (c), 2u);
+    BOOST_CHECK (!empty (c));
+
+    std::array <int, 3> expected1 = {{1, 2, 3}};
+    std::array <int, 3> expected2 = {{4, 5, 6}};
+    BOOST_CHECK (first (c) == expected1);
+    BOOST_CHECK (second (c) == expected2);
+    BOOST_CHECK (empty (drop (c, 2)));
+
+    // chop_in_place.
+    {
+        auto c2 = c;
+        BOOST_CHECK (range::chop_in_place (c2) == expected1);
+        BOOST_CHECK (range::chop_in_place (c2) == expected2);
+        BOOST_CHECK (empty (c2));
+    }
+
+    // Back to front: the arrays are in the order of traversal.
+    auto c3 = chunk_exact (v, rime::size_t <2>(), back);
+    std::array <int, 2> expected3 = {{7, 6}};
+    BOOST_CHECK (first (c3, back) == expected3);
+    BOOST_CHECK_EQUAL (size (c3, back), 3u);
+
+    // Too short.
+    std::vector <int> short_vector (2, 5);
+    BOOST_CHECK (empty (chunk_exact (short_vector, rime::size_t <3>())));
+}
+
+BOOST_AUTO_TEST_CASE (test_chunk_exact_list) {
+    std::list <double> l;
+    for (int i = 1; i != 6; ++ i)
+        l.push_back (i);
+
+    auto c = chunk_exact (l, rime::size_t <2>());
+    BOOST_MPL_ASSERT_NOT ((has <callable::size (decltype (c))>));
+
+    double sum = 0;
+    int chunk_count = 0;
+    RANGE_FOR_EACH (block, c) {
+        ++ chunk_count;
+        sum += block [0] * block [1];
+    }
+    BOOST_CHECK_EQUAL (chunk_count, 2);
+    BOOST_CHECK_EQUAL (sum, 1 * 2 + 3 * 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
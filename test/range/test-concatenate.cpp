@@ -0,0 +1,201 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_concatenate
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/concatenate.hpp"
+
+#include <list>
+#include <tuple>
+#include <vector>
+#include <type_traits>
+
+#include "range/std.hpp"
+#include "range/fold.hpp"
+#include "range/for_each.hpp"
+#include "range/find.hpp"
+#include "range/equal.hpp"
+#include "range/hash_range.hpp"
+#include "range/for_each_macro.hpp"
+
+#include "utility/returns.hpp"
+
+#include "rime/check/check_equal.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_concatenate)
+
+using range::concatenate;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::third;
+using range::drop;
+using range::front;
+using range::is_homogeneous;
+
+struct plus {
+    template <class Left, class Right>
+        auto operator() (Left const & left, Right const & right) const
+    RETURNS (left + right);
+};
+
+struct append {
+    std::vector <int> * result;
+
+    void operator() (int i) const { result->push_back (i); }
+};
+
+struct equals {
+    int value;
+
+    bool operator() (int i) const { return i == value; }
+};
+
+BOOST_AUTO_TEST_CASE (test_concatenate_homogeneous) {
+    std::vector <int> v1;
+    std::vector <int> v2;
+    std::vector <int> v3;
+    v1.push_back (1);
+    v1.push_back (2);
+    v3.push_back (3);
+    v3.push_back (4);
+    v3.push_back (5);
+
+    auto c = concatenate (v1, v2, v3);
+    BOOST_MPL_ASSERT ((is_homogeneous <decltype (c)>));
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (c)), int &>));
+
+    BOOST_CHECK (!empty (c));
+    BOOST_CHECK_EQUAL (size (c), 5u);
+    BOOST_CHECK_EQUAL (first (c), 1);
+    BOOST_CHECK_EQUAL (second (c), 2);
+    BOOST_CHECK_EQUAL (third (c), 3);
+    BOOST_CHECK_EQUAL (first (drop (c, 4)), 5);
+    BOOST_CHECK_EQUAL (first (drop (drop (c, 1), 3)), 5);
+    BOOST_CHECK_EQUAL (size (drop (c, 2)), 3u);
+    BOOST_CHECK (empty (drop (c, 5)));
+
+    // Elements can be changed.
+    third (c) = 30;
+    BOOST_CHECK_EQUAL (v3 [0], 30);
+    v3 [0] = 3;
+
+    // Element by element.
+    {
+        int expected = 1;
+        RANGE_FOR_EACH (element, c) {
+            BOOST_CHECK_EQUAL (element, expected);
+            ++ expected;
+        }
+        BOOST_CHECK_EQUAL (expected, 6);
+    }
+
+    // Segment by segment.
+    BOOST_CHECK_EQUAL (range::fold (0, c, plus()), 15);
+    {
+        std::vector <int> result;
+        range::for_each (c, append {&result});
+        BOOST_CHECK_EQUAL (result.size(), 5u);
+        BOOST_CHECK_EQUAL (result [2], 3);
+    }
+
+    {
+        auto found = range::find (c, equals {4});
+        BOOST_MPL_ASSERT ((std::is_same <decltype (found), decltype (c)>));
+        BOOST_CHECK_EQUAL (size (found), 2u);
+        BOOST_CHECK_EQUAL (first (found), 4);
+        BOOST_CHECK_EQUAL (&first (found), &v3 [1]);
+
+        BOOST_CHECK_EQUAL (first (range::find (c, equals {2})), 2);
+        BOOST_CHECK (empty (range::find (c, equals {7})));
+    }
+
+    {
+        std::vector <int> all;
+        for (int i = 1; i != 6; ++ i)
+            all.push_back (i);
+        std::list <int> other (all.begin(), all.end());
+
+        BOOST_CHECK (range::equal (c, all));
+        BOOST_CHECK (range::equal (all, c));
+        BOOST_CHECK (range::equal (c, other));
+        BOOST_CHECK (range::equal (c, concatenate (v1, v3)));
+
+        std::vector <int> shorter (all.begin(), all.begin() + 4);
+        BOOST_CHECK (!range::equal (c, shorter));
+        BOOST_CHECK (!range::equal (shorter, c));
+        all [3] = 40;
+        BOOST_CHECK (!range::equal (c, all));
+        BOOST_CHECK (!range::equal (all, c));
+
+        // hash_range uses for_each.
+        all [3] = 4;
+        BOOST_CHECK_EQUAL (range::hash_range (c), range::hash_range (all));
+    }
+
+    // All empty.
+    std::vector <int> e;
+    BOOST_CHECK (empty (concatenate (e, e)));
+    BOOST_CHECK_EQUAL (size (concatenate (e, e, e)), 0u);
+    BOOST_CHECK_EQUAL (range::fold (0, concatenate (e, e), plus()), 0);
+
+    // A single range.
+    BOOST_CHECK_EQUAL (size (concatenate (v1)), 2u);
+}
+
+BOOST_AUTO_TEST_CASE (test_concatenate_heterogeneous) {
+    std::tuple <int, char> t1 (1, 'a');
+    std::tuple <> t2;
+    std::tuple <double> t3 (2.5);
+
+    auto c = concatenate (t1, t2, t3);
+    RIME_CHECK_EQUAL (empty (c), rime::false_);
+    RIME_CHECK_EQUAL (size (c), rime::size_t <3>());
+
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (c)), int &>));
+    BOOST_MPL_ASSERT ((std::is_same <decltype (second (c)), char &>));
+    BOOST_MPL_ASSERT ((std::is_same <decltype (third (c)), double &>));
+    BOOST_CHECK_EQUAL (first (c), 1);
+    BOOST_CHECK_EQUAL (second (c), 'a');
+    BOOST_CHECK_EQUAL (third (c), 2.5);
+    RIME_CHECK_EQUAL (empty (drop (drop (drop (c)))), rime::true_);
+
+    BOOST_CHECK_EQUAL (range::fold (0., c, plus()), 1 + 'a' + 2.5);
+}
+
+BOOST_AUTO_TEST_CASE (test_concatenate_mixed) {
+    // A heterogeneous range followed by a homogeneous one.
+    std::tuple <int> t (7);
+    std::vector <int> v;
+    v.push_back (8);
+    v.push_back (9);
+
+    auto c = concatenate (t, v);
+    BOOST_CHECK_EQUAL (first (c), 7);
+    BOOST_CHECK_EQUAL (size (c), 3u);
+
+    auto rest = drop (c);
+    BOOST_MPL_ASSERT ((is_homogeneous <decltype (rest)>));
+    BOOST_CHECK_EQUAL (first (rest), 8);
+    BOOST_CHECK_EQUAL (second (rest), 9);
+
+    BOOST_CHECK_EQUAL (range::fold (0, c, plus()), 24);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
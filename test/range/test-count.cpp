@@ -19,11 +19,18 @@ limitations under the License.
 
 #include "range/count.hpp"
 
+#include <functional>
 #include <type_traits>
+#include <vector>
 
 #include "range/core.hpp"
 #include "range/for_each_macro.hpp"
 #include "range/reverse.hpp"
+#include "range/fold.hpp"
+#include "range/for_each.hpp"
+#include "range/find.hpp"
+#include "range/equal.hpp"
+#include "range/transform.hpp"
 
 #include "rime/check/check_equal.hpp"
 
@@ -410,4 +417,134 @@ BOOST_AUTO_TEST_CASE (homogeneous) {
     // count (std::size_t (3), std::size_t (2));
 }
 
+struct append {
+    std::vector <int> * result;
+
+    void operator() (int i) const { result->push_back (i); }
+};
+
+struct greater_than {
+    int value;
+
+    bool operator() (int i) const { return i > value; }
+};
+
+struct twice {
+    int operator() (int i) const { return 2 * i; }
+};
+
+struct add_square {
+    long operator() (long state, int i) const { return state + long (i) * i; }
+};
+
+BOOST_AUTO_TEST_CASE (test_count_algorithms) {
+    // Algorithms that are specialised for run-time count ranges.
+    auto c = count (3, 8);
+
+    // fold in closed form.
+    BOOST_CHECK_EQUAL (range::fold (0, c, std::plus <int>()), 25);
+    BOOST_CHECK_EQUAL (range::fold (10, c, back, std::plus <int>()), 35);
+    BOOST_CHECK_EQUAL (range::fold (0, count (0), std::plus <int>()), 0);
+    BOOST_CHECK_EQUAL (range::fold (0, count (-5, 3), std::plus <int>()), -12);
+    BOOST_CHECK_EQUAL (range::fold (std::size_t (0),
+        count (std::size_t (100000)), std::plus <std::size_t>()),
+        std::size_t (4999950000u));
+    {
+        // short is promoted to int, so the sum must be computed in a larger
+        // type to avoid overflow.
+        short expected = 0;
+        for (int i = -20; i != 32767; ++ i)
+            expected = short (expected + i);
+        BOOST_CHECK_EQUAL (range::fold (short (0),
+            count (short (-20), short (32767)), std::plus <short>()),
+            expected);
+    }
+
+    // fold with a plain loop.
+    BOOST_CHECK_EQUAL (range::fold (0l, c, add_square()),
+        9l + 16 + 25 + 36 + 49);
+    BOOST_CHECK_EQUAL (range::fold (0l, count (0), add_square()), 0l);
+
+    // Through transform.
+    BOOST_CHECK_EQUAL (range::fold (0l, range::transform (c, twice()),
+        add_square()), 4 * (9l + 16 + 25 + 36 + 49));
+
+    {
+        std::vector <int> result;
+        range::for_each (c, append {&result});
+        BOOST_CHECK_EQUAL (result.size(), 5u);
+        BOOST_CHECK_EQUAL (result [0], 3);
+        BOOST_CHECK_EQUAL (result [4], 7);
+
+        result.clear();
+        range::for_each (c, back, append {&result});
+        BOOST_CHECK_EQUAL (result.size(), 5u);
+        BOOST_CHECK_EQUAL (result [0], 7);
+        BOOST_CHECK_EQUAL (result [4], 3);
+
+        result.clear();
+        range::for_each (range::transform (c, twice()), append {&result});
+        BOOST_CHECK_EQUAL (result.size(), 5u);
+        BOOST_CHECK_EQUAL (result [1], 8);
+    }
+
+    {
+        auto found = range::find (c, greater_than {4});
+        BOOST_MPL_ASSERT ((std::is_same <decltype (found), decltype (c)>));
+        BOOST_CHECK_EQUAL (first (found), 5);
+        BOOST_CHECK_EQUAL (size (found), 3);
+        BOOST_CHECK (empty (range::find (c, greater_than {7})));
+
+        auto found_back = range::find (c, back, greater_than {4});
+        BOOST_CHECK_EQUAL (first (found_back, back), 7);
+        BOOST_CHECK_EQUAL (size (found_back), 5);
+    }
+
+    // equal in constant time.
+    BOOST_CHECK (range::equal (c, count (3, 8)));
+    BOOST_CHECK (!range::equal (c, count (3, 9)));
+    BOOST_CHECK (!range::equal (c, count (4, 9)));
+    BOOST_CHECK (range::equal (count (4, 4), count (7, 7)));
+    BOOST_CHECK (range::equal (c, count (3, 8), back));
+}
+
+BOOST_AUTO_TEST_CASE (test_count_step) {
+    {
+        // 1, 4, 7.
+        auto c = count (1, 10, 3);
+        BOOST_MPL_ASSERT ((is_homogeneous <decltype (c)>));
+        BOOST_CHECK (!empty (c));
+        BOOST_CHECK_EQUAL (size (c), 3);
+        BOOST_CHECK_EQUAL (first (c), 1);
+        BOOST_CHECK_EQUAL (first (c, back), 7);
+        BOOST_CHECK_EQUAL (first (drop (c)), 4);
+        BOOST_CHECK_EQUAL (first (drop (c, 2)), 7);
+        BOOST_CHECK (empty (drop (c, 3)));
+        BOOST_CHECK_EQUAL (first (drop (c, 2, back), back), 1);
+        BOOST_CHECK_EQUAL (size (drop (c, 1, back)), 2);
+
+        std::vector <int> result;
+        RANGE_FOR_EACH (i, range::reverse (c))
+            result.push_back (i);
+        BOOST_CHECK_EQUAL (result.size(), 3u);
+        BOOST_CHECK_EQUAL (result [0], 7);
+        BOOST_CHECK_EQUAL (result [2], 1);
+    }
+    {
+        // The end is included if it is exactly on a step: 0, 5.
+        auto c = count (0, 6, 5);
+        BOOST_CHECK_EQUAL (size (c), 2);
+        BOOST_CHECK_EQUAL (size (count (0, 5, 5)), 1);
+        BOOST_CHECK (empty (count (3, 3, 2)));
+    }
+    {
+        // Compile-time step.
+        auto c = count (std::size_t (2), std::size_t (11),
+            rime::constant <std::size_t, 4>());
+        BOOST_CHECK_EQUAL (size (c), 3u);
+        BOOST_CHECK_EQUAL (first (c, back), 10u);
+        BOOST_CHECK_EQUAL (first (drop (c, std::size_t (1))), 6u);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_external_sort
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/external_sort.hpp"
+
+#include <random>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "range/std/container.hpp"
+
+using range::empty;
+using range::chop_in_place;
+using range::external_sort_options;
+
+BOOST_AUTO_TEST_SUITE(test_range_external_sort)
+
+struct record {
+    unsigned key;
+    unsigned value;
+};
+
+struct compare_key {
+    bool operator() (record const & left, record const & right) const
+    { return left.key < right.key; }
+};
+
+/**
+Check that \a sorted contains the records in \a original, sorted.
+*/
+template <class Sorted>
+    void check_sorted (std::vector <record> const & original, Sorted sorted)
+{
+    unsigned long long key_sum = 0;
+    unsigned long long value_sum = 0;
+    for (record const & r : original) {
+        key_sum += r.key;
+        value_sum += r.value;
+    }
+
+    std::size_t number = 0;
+    unsigned previous = 0;
+    while (!empty (sorted)) {
+        record r = chop_in_place (sorted);
+        BOOST_CHECK (previous <= r.key);
+        previous = r.key;
+        key_sum -= r.key;
+        value_sum -= r.value;
+        // The values are derived from the keys.
+        BOOST_CHECK_EQUAL (r.value, r.key * 3);
+        ++ number;
+    }
+    BOOST_CHECK_EQUAL (number, original.size());
+    BOOST_CHECK_EQUAL (key_sum, 0u);
+    BOOST_CHECK_EQUAL (value_sum, 0u);
+}
+
+std::vector <record> random_records (std::size_t number) {
+    std::mt19937 generator (number);
+    std::vector <record> result;
+    for (std::size_t i = 0; i != number; ++ i) {
+        unsigned key = generator() % 100000;
+        result.push_back (record {key, key * 3});
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE (test_external_sort_in_memory) {
+    std::vector <record> empty_input;
+    check_sorted (empty_input, range::external_sort (
+        empty_input, compare_key()));
+
+    // This fits in one run.
+    std::vector <record> original = random_records (1000);
+    check_sorted (original, range::external_sort (original, compare_key()));
+}
+
+BOOST_AUTO_TEST_CASE (test_external_sort_files) {
+    std::vector <record> original = random_records (100000);
+
+    auto temporary_file_name = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path();
+    {
+        range::binary_writer <record> writer (temporary_file_name.native());
+        writer.write_range (original);
+        writer.flush();
+    }
+
+    for (std::size_t thread_num : {1, 3}) {
+        // Runs of 100 records, so that runs are merged on disk as well.
+        auto options = external_sort_options()
+            .memory_budget (200 * sizeof (record)).thread_num (thread_num);
+        check_sorted (original, range::external_sort (
+            range::read_binary_file <record> (temporary_file_name.native()),
+            compare_key(), options));
+    }
+
+    // Runs of 20000 records, which parallel_sort sorts on multiple threads.
+    {
+        auto options = external_sort_options()
+            .memory_budget (40000 * sizeof (record)).thread_num (3);
+        check_sorted (original, range::external_sort (
+            range::read_binary_file <record> (temporary_file_name.native()),
+            compare_key(), options));
+    }
+
+    boost::filesystem::remove (temporary_file_name);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_filter
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/filter.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "range/std.hpp"
+#include "range/equal.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_filter)
+
+using range::filter;
+
+using range::empty;
+using range::first;
+using range::second;
+using range::third;
+using range::drop;
+using range::front;
+using range::back;
+using range::has;
+namespace callable = range::callable;
+
+struct is_odd {
+    int * calls;
+
+    bool operator() (int i) const {
+        if (calls)
+            ++ *calls;
+        return i % 2 != 0;
+    }
+};
+
+struct is_long {
+    bool operator() (std::string const & s) const { return s.size() > 2; }
+};
+
+BOOST_AUTO_TEST_CASE (test_filter_list) {
+    // General implementation.
+    std::list <int> l;
+    {
+        auto f = filter (l, is_odd {nullptr});
+        BOOST_CHECK (empty (f));
+    }
+    for (int i = 1; i != 8; ++ i)
+        l.push_back (i);
+
+    int calls = 0;
+    auto f = filter (l, is_odd {&calls});
+    BOOST_MPL_ASSERT_NOT ((has <callable::size (decltype (f))>));
+    BOOST_CHECK_EQUAL (calls, 1);
+
+    // empty and first do not evaluate the predicate.
+    BOOST_CHECK (!empty (f));
+    BOOST_CHECK_EQUAL (first (f), 1);
+    BOOST_CHECK_EQUAL (first (f), 1);
+    BOOST_CHECK_EQUAL (calls, 1);
+
+    BOOST_CHECK_EQUAL (second (f), 3);
+    BOOST_CHECK_EQUAL (third (f), 5);
+    BOOST_CHECK_EQUAL (first (drop (drop (drop (f)))), 7);
+    BOOST_CHECK (empty (drop (drop (drop (drop (f))))));
+
+    // Elements are references to the underlying elements.
+    first (drop (f)) = 33;
+    BOOST_CHECK_EQUAL (second (f), 33);
+
+    // Back to front.
+    std::vector <int> expected;
+    expected.push_back (7);
+    expected.push_back (5);
+    expected.push_back (33);
+    expected.push_back (1);
+    BOOST_CHECK (range::equal (filter (l, is_odd {nullptr}, back),
+        expected, front));
+
+    std::list <std::string> words;
+    words.push_back ("a");
+    words.push_back ("abc");
+    words.push_back ("ab");
+    words.push_back ("abcd");
+    std::string all;
+    RANGE_FOR_EACH (word, filter (words, is_long()))
+        all += word;
+    BOOST_CHECK_EQUAL (all, "abcabcd");
+}
+
+BOOST_AUTO_TEST_CASE (test_filter_block) {
+    // Vectors of arithmetic types are scanned in blocks.
+    std::vector <int> v;
+    {
+        int calls = 0;
+        BOOST_CHECK (empty (filter (v, is_odd {&calls})));
+        BOOST_CHECK_EQUAL (calls, 0);
+    }
+    for (int i = 0; i != 200; ++ i)
+        v.push_back (i % 50 == 17 || i == 199 ? 1 : 2 * i);
+
+    int calls = 0;
+    auto f = filter (v, is_odd {&calls});
+    BOOST_CHECK_EQUAL (first (f), 1);
+    // The first block has been evaluated.
+    BOOST_CHECK_EQUAL (calls, 64);
+
+    // The next match is in the second block.
+    auto f2 = drop (f);
+    BOOST_CHECK_EQUAL (&first (f2), &v [67]);
+    BOOST_CHECK_EQUAL (calls, 128);
+    // Elements in the same block are found without calling the predicate.
+    BOOST_CHECK_EQUAL (&first (drop (f2)), &v [117]);
+    BOOST_CHECK_EQUAL (calls, 128);
+
+    int count = 0;
+    RANGE_FOR_EACH (element, f) {
+        BOOST_CHECK_EQUAL (element, 1);
+        ++ count;
+    }
+    BOOST_CHECK_EQUAL (count, 5);
+
+    // Back to front.
+    auto b = filter (v, is_odd {nullptr}, back);
+    BOOST_CHECK_EQUAL (&first (b, back), &v [199]);
+    BOOST_CHECK_EQUAL (&first (drop (b, back), back), &v [167]);
+    BOOST_CHECK_EQUAL (&first (drop (drop (b, back), back), back), &v [117]);
+
+    // Blocks where every element matches.
+    std::vector <double> all (130, 1.5);
+    int number = 0;
+    RANGE_FOR_EACH (element, filter (all, [](double d) { return d > 1; })) {
+        BOOST_CHECK_EQUAL (element, 1.5);
+        ++ number;
+    }
+    BOOST_CHECK_EQUAL (number, 130);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
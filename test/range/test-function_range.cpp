@@ -18,8 +18,10 @@ limitations under the License.
 #include "utility/test/boost_unit_test.hpp"
 
 #include "range/function_range.hpp"
+#include "range/for_each.hpp"
 
 #include <type_traits>
+#include <vector>
 
 #include <boost/mpl/if.hpp>
 #include <boost/mpl/assert.hpp>
@@ -110,4 +112,63 @@ BOOST_AUTO_TEST_CASE (test_range_function_range_reference) {
     BOOST_CHECK_EQUAL (i, 8);
 }
 
+/**
+Write squares, three at a time, up to limit, and count the calls.
+*/
+struct squares {
+    int next;
+    int limit;
+    int * calls;
+
+    std::size_t operator() (int * out, std::size_t max) {
+        ++ *calls;
+        std::size_t number = 0;
+        for (; number != max && number != 3 && next != limit; ++ number) {
+            out [number] = next * next;
+            ++ next;
+        }
+        return number;
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_range_block_function_range) {
+    int calls = 0;
+    auto r = range::make_block_function_range <int> (
+        squares {0, 8, &calls}, 2);
+    typedef decltype (r) r_type;
+    BOOST_MPL_ASSERT ((std::is_same <range::tag_of <r_type>::type,
+        range::function_range_operation::block_function_range_tag>));
+
+    BOOST_CHECK (!range::empty (r));
+    BOOST_CHECK_EQUAL (calls, 1);
+    BOOST_CHECK_EQUAL (range::chop_in_place (r), 0);
+    BOOST_CHECK_EQUAL (range::chop_in_place (r), 1);
+    BOOST_CHECK_EQUAL (calls, 1);
+
+    auto next = range::chop (std::move (r));
+    BOOST_CHECK_EQUAL (next.first(), 4);
+    BOOST_CHECK_EQUAL (calls, 2);
+
+    // Read directly into memory owned by the caller.
+    r_type r2 = next.move_rest();
+    int block [10];
+    BOOST_CHECK_EQUAL (r2.read (block, 10), 1u);
+    BOOST_CHECK_EQUAL (block [0], 9);
+    BOOST_CHECK_EQUAL (r2.read (block, 10), 3u);
+    BOOST_CHECK_EQUAL (block [0], 16);
+    BOOST_CHECK_EQUAL (block [2], 36);
+    BOOST_CHECK_EQUAL (calls, 3);
+
+    // for_each goes through the rest one block at a time.
+    std::vector <int> rest;
+    range::for_each (r2, [&rest] (int i) { rest.push_back (i); });
+    BOOST_CHECK_EQUAL (rest.size(), 1u);
+    BOOST_CHECK_EQUAL (rest [0], 49);
+    BOOST_CHECK (range::empty (r2));
+    BOOST_CHECK_EQUAL (calls, 5);
+    // The function is not called again after it has returned 0.
+    BOOST_CHECK (range::empty (r2));
+    BOOST_CHECK_EQUAL (calls, 5);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
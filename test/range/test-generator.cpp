@@ -0,0 +1,139 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_generator
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/generator.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "range/buffer.hpp"
+#include "range/any_range.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_generator)
+
+#if RANGE_HAS_GENERATOR
+
+using range::generator;
+
+using range::empty;
+using range::first;
+using range::drop;
+using range::chop;
+using range::chop_in_place;
+
+generator <int> fibonacci (int number) {
+    int current = 0, next = 1;
+    for (int i = 0; i != number; ++ i) {
+        co_yield current;
+        current = std::exchange (next, current + next);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_basic) {
+    auto numbers = fibonacci (6);
+    BOOST_CHECK (!empty (numbers));
+    BOOST_CHECK_EQUAL (first (numbers), 0);
+    BOOST_CHECK_EQUAL (chop_in_place (numbers), 0);
+    BOOST_CHECK_EQUAL (chop_in_place (numbers), 1);
+    BOOST_CHECK_EQUAL (chop_in_place (numbers), 1);
+
+    auto chopped = chop (std::move (numbers));
+    BOOST_CHECK_EQUAL (chopped.first(), 2);
+    auto rest = chopped.move_rest();
+    BOOST_CHECK_EQUAL (chop_in_place (rest), 3);
+    BOOST_CHECK_EQUAL (chop_in_place (rest), 5);
+    BOOST_CHECK (empty (rest));
+
+    BOOST_CHECK (empty (fibonacci (0)));
+}
+
+generator <std::string> words() {
+    std::string word = "first";
+    // An lvalue is copied.
+    co_yield word;
+    word = "second";
+    co_yield word;
+    // An rvalue is moved.
+    co_yield std::string ("third");
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_lvalue) {
+    auto r = words();
+    BOOST_CHECK_EQUAL (chop_in_place (r), "first");
+    BOOST_CHECK_EQUAL (chop_in_place (r), "second");
+    BOOST_CHECK_EQUAL (chop_in_place (r), "third");
+    BOOST_CHECK (empty (r));
+}
+
+generator <int> throw_after_one() {
+    co_yield 1;
+    throw std::runtime_error ("Out of elements.");
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_exception) {
+    auto r = throw_after_one();
+    BOOST_CHECK_EQUAL (chop_in_place (r), 1);
+    BOOST_CHECK_THROW (empty (r), std::runtime_error);
+    BOOST_CHECK (empty (r));
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_buffer) {
+    auto numbers = range::make_buffer (fibonacci (20));
+    auto numbers2 = numbers;
+    BOOST_CHECK_EQUAL (chop_in_place (numbers2), 0);
+    BOOST_CHECK_EQUAL (chop_in_place (numbers2), 1);
+    BOOST_CHECK_EQUAL (first (numbers), 0);
+    BOOST_CHECK_EQUAL (first (drop (drop (drop (numbers2)))), 5);
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_any_range) {
+    range::any_range <int, range::capability::unique_capabilities> r (
+        fibonacci (4));
+    BOOST_CHECK_EQUAL (chop_in_place (r), 0);
+    BOOST_CHECK_EQUAL (chop_in_place (r), 1);
+    BOOST_CHECK_EQUAL (chop_in_place (r), 1);
+    BOOST_CHECK_EQUAL (chop_in_place (r), 2);
+    BOOST_CHECK (empty (r));
+}
+
+BOOST_AUTO_TEST_CASE (test_generator_recycle) {
+    // Frames are reused, so this should not allocate memory each time.
+    int total = 0;
+    for (int i = 0; i != 1000; ++ i) {
+        auto r = fibonacci (5);
+        for (int j = 0; j != 4; ++ j)
+            chop_in_place (r);
+        total += chop_in_place (r);
+    }
+    BOOST_CHECK_EQUAL (total, 3000);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE (test_generator_unavailable) {
+#ifdef RANGE_TEST_REQUIRE_COROUTINES
+    BOOST_ERROR ("This test was meant to be compiled with coroutines.");
+#endif
+    BOOST_CHECK (!RANGE_HAS_GENERATOR);
+}
+
+#endif // RANGE_HAS_GENERATOR
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_group_by
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/group_by.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "range/std.hpp"
+#include "range/buffer.hpp"
+#include "range/function_range.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_group_by)
+
+using range::group_by;
+using range::run_length;
+
+using range::empty;
+using range::first;
+using range::chop_in_place;
+
+struct tens {
+    int * calls;
+
+    int operator() (int i) const {
+        ++ *calls;
+        return i / 10;
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_group_by_vector) {
+    std::vector <int> v;
+    int calls = 0;
+    BOOST_CHECK (empty (group_by (v, tens {&calls})));
+
+    v.push_back (1);
+    v.push_back (3);
+    v.push_back (12);
+    v.push_back (15);
+    v.push_back (17);
+    v.push_back (20);
+    v.push_back (41);
+    v.push_back (42);
+
+    std::vector <std::pair <int, int>> sums;
+    RANGE_FOR_EACH (group, group_by (v, tens {&calls})) {
+        int sum = 0;
+        RANGE_FOR_EACH (element, group.second)
+            sum += element;
+        sums.push_back (std::make_pair (group.first, sum));
+    }
+    // The key function is called once for each element.
+    BOOST_CHECK_EQUAL (calls, 8);
+
+    BOOST_CHECK_EQUAL (sums.size(), 4u);
+    BOOST_CHECK_EQUAL (sums [0].first, 0);
+    BOOST_CHECK_EQUAL (sums [0].second, 4);
+    BOOST_CHECK_EQUAL (sums [1].first, 1);
+    BOOST_CHECK_EQUAL (sums [1].second, 44);
+    BOOST_CHECK_EQUAL (sums [2].first, 2);
+    BOOST_CHECK_EQUAL (sums [2].second, 20);
+    BOOST_CHECK_EQUAL (sums [3].first, 4);
+    BOOST_CHECK_EQUAL (sums [3].second, 83);
+
+    // Groups that are not traversed completely are skipped.
+    auto groups = group_by (v, tens {&calls});
+    auto group1 = chop_in_place (groups);
+    // Elements are references into the vector.
+    BOOST_CHECK_EQUAL (&first (group1.second), &v [0]);
+
+    auto group2 = chop_in_place (groups);
+    BOOST_CHECK (empty (group1.second));
+    BOOST_CHECK_EQUAL (group2.first, 1);
+    BOOST_CHECK_EQUAL (chop_in_place (group2.second), 12);
+    BOOST_CHECK_EQUAL (first (group2.second), 15);
+
+    BOOST_CHECK_EQUAL (chop_in_place (groups).first, 2);
+    BOOST_CHECK (empty (group2.second));
+    BOOST_CHECK_EQUAL (chop_in_place (groups).first, 4);
+    BOOST_CHECK (empty (groups));
+}
+
+BOOST_AUTO_TEST_CASE (test_group_by_buffer) {
+    std::vector <std::string> words;
+    words.push_back ("apple");
+    words.push_back ("avocado");
+    words.push_back ("banana");
+    words.push_back ("cherry");
+    words.push_back ("cranberry");
+
+    std::string result;
+    RANGE_FOR_EACH (group, group_by (range::make_buffer (words),
+        [](std::string const & word) { return word [0]; }))
+    {
+        result += group.first;
+        result += ':';
+        RANGE_FOR_EACH (word, group.second)
+            result += word.substr (0, 2);
+        result += ' ';
+    }
+    BOOST_CHECK_EQUAL (result, "a:apav b:ba c:chcr ");
+}
+
+struct count_up {
+    int current;
+
+    int operator() () { return current ++; }
+};
+
+BOOST_AUTO_TEST_CASE (test_group_by_function_range) {
+    // An infinite single-pass range.
+    auto groups = group_by (range::make_function_range (count_up {0}),
+        [](int i) { return i / 3; });
+    for (int key = 0; key != 4; ++ key) {
+        BOOST_CHECK (!empty (groups));
+        auto group = chop_in_place (groups);
+        BOOST_CHECK_EQUAL (group.first, key);
+        BOOST_CHECK_EQUAL (first (group.second), 3 * key);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_run_length) {
+    std::vector <int> v;
+    BOOST_CHECK (empty (run_length (v)));
+
+    v.push_back (7);
+    v.push_back (7);
+    v.push_back (7);
+    v.push_back (2);
+    v.push_back (7);
+    v.push_back (7);
+
+    std::vector <std::pair <int, std::size_t>> runs;
+    RANGE_FOR_EACH (run, run_length (range::make_buffer (v)))
+        runs.push_back (run);
+    BOOST_CHECK_EQUAL (runs.size(), 3u);
+    BOOST_CHECK_EQUAL (runs [0].first, 7);
+    BOOST_CHECK_EQUAL (runs [0].second, 3u);
+    BOOST_CHECK_EQUAL (runs [1].first, 2);
+    BOOST_CHECK_EQUAL (runs [1].second, 1u);
+    BOOST_CHECK_EQUAL (runs [2].first, 7);
+    BOOST_CHECK_EQUAL (runs [2].second, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_hash_aggregate
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/hash_aggregate.hpp"
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "range/std/container.hpp"
+#include "range/tuple.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_hash_aggregate)
+
+using range::hash_aggregate;
+using range::parallel_hash_aggregate;
+using range::first;
+using range::second;
+using range::tuple;
+
+struct identity {
+    int operator() (int i) const { return i; }
+};
+
+struct sum {
+    long operator() (long total, int i) const { return total + i; }
+};
+
+std::vector <int> numbers() {
+    std::vector <int> result;
+    // Multiples of a power of two, which boost::hash does not scramble.
+    for (int i = 0; i != 100000; ++ i)
+        result.push_back ((i * 7919) % 1000 * 64);
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE (test_hash_aggregate) {
+    std::vector <int> v = numbers();
+
+    std::map <int, long> expected;
+    std::vector <int> order;
+    for (int i : v) {
+        if (expected.find (i) == expected.end())
+            order.push_back (i);
+        expected [i] += i;
+    }
+
+    auto totals = hash_aggregate (v, identity(), 0l, sum());
+    BOOST_CHECK_EQUAL (totals.size(), expected.size());
+    // The keys are in order of first appearance.
+    for (std::size_t k = 0; k != totals.size(); ++ k) {
+        BOOST_CHECK_EQUAL (first (totals [k]), order [k]);
+        BOOST_CHECK_EQUAL (second (totals [k]), expected [order [k]]);
+    }
+
+    BOOST_CHECK (hash_aggregate (std::vector <int>(), identity(), 0l, sum())
+        .empty());
+
+    for (std::size_t thread_num : {1, 2, 7}) {
+        auto parallel_totals = parallel_hash_aggregate (
+            v, identity(), 0l, sum(), thread_num);
+        BOOST_CHECK_EQUAL (parallel_totals.size(), expected.size());
+        for (auto const & entry : parallel_totals)
+            BOOST_CHECK_EQUAL (second (entry), expected [first (entry)]);
+    }
+}
+
+typedef tuple <int, std::string, int> row;
+
+struct first_two {
+    tuple <int const &, std::string const &> operator() (row const & r) const
+    { return tuple <int const &, std::string const &> (first (r), second (r)); }
+};
+
+struct count {
+    int operator() (int number, row const &) const { return number + 1; }
+};
+
+BOOST_AUTO_TEST_CASE (test_hash_aggregate_tuple_key) {
+    std::vector <row> rows;
+    for (int i = 0; i != 6000; ++ i)
+        rows.push_back (row (i % 3, std::to_string (i % 5), i));
+
+    // The key is a tuple of references; the result contains values.
+    auto counts = hash_aggregate (rows, first_two(), 0, count());
+    static_assert (std::is_same <decltype (counts), std::vector <
+        tuple <tuple <int, std::string>, int>>>::value, "");
+    BOOST_CHECK_EQUAL (counts.size(), 15u);
+    BOOST_CHECK (first (counts [0]) == (tuple <int, std::string> (0, "0")));
+    for (auto const & entry : counts)
+        BOOST_CHECK_EQUAL (second (entry), 400);
+
+    auto parallel_counts = parallel_hash_aggregate (
+        rows, first_two(), 0, count(), 4);
+    BOOST_CHECK_EQUAL (parallel_counts.size(), 15u);
+    for (auto const & entry : parallel_counts)
+        BOOST_CHECK_EQUAL (second (entry), 400);
+}
+
+struct counting_identity {
+    std::atomic <std::size_t> & calls;
+    explicit counting_identity (std::atomic <std::size_t> & calls)
+    : calls (calls) {}
+
+    int operator() (int i) const {
+        ++ calls;
+        return i;
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_hash_aggregate_key_once) {
+    std::vector <int> v = numbers();
+    std::atomic <std::size_t> calls (0);
+    parallel_hash_aggregate (v, counting_identity (calls), 0l, sum(), 3);
+    BOOST_CHECK_EQUAL (calls.load(), v.size());
+}
+
+BOOST_AUTO_TEST_CASE (test_hash_aggregate_exception) {
+    std::vector <int> v = numbers();
+    auto throwing = [] (long total, int i) -> long {
+        if (i == 640)
+            throw std::runtime_error ("640");
+        return total + i;
+    };
+    BOOST_CHECK_THROW (hash_aggregate (v, identity(), 0l, throwing),
+        std::runtime_error);
+    BOOST_CHECK_THROW (parallel_hash_aggregate (
+        v, identity(), 0l, throwing, 4), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,180 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_hash_join
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/hash_join.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "range/std/container.hpp"
+#include "range/tuple.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_hash_join)
+
+using range::hash_join;
+using range::parallel_hash_join;
+using range::empty;
+using range::chop_in_place;
+using range::first;
+using range::second;
+using range::tuple;
+
+struct identity {
+    int operator() (int i) const { return i; }
+};
+
+struct plus_50 {
+    int operator() (int i) const { return i + 50; }
+};
+
+/// Join \a build and \a probe with a nested loop.
+template <class ProbeKey> std::vector <std::pair <int, int>> nested_loop_join (
+    std::vector <int> const & build, std::vector <int> const & probe,
+    ProbeKey const & probe_key)
+{
+    std::vector <std::pair <int, int>> result;
+    for (int p : probe)
+        for (int b : build)
+            if (b == probe_key (p))
+                result.push_back (std::make_pair (b, p));
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE (test_hash_join) {
+    std::vector <int> build;
+    for (int i = 0; i != 300; ++ i)
+        build.push_back (i % 100);
+    std::vector <int> probe;
+    for (int i = 0; i != 1000; ++ i)
+        probe.push_back (i % 150);
+
+    {
+        auto joined = hash_join (build, probe, identity());
+        std::vector <std::pair <int, int>> result;
+        while (!empty (joined)) {
+            auto pair = chop_in_place (joined);
+            result.push_back (std::make_pair (first (pair), second (pair)));
+        }
+        // The order is the same as for a nested loop.
+        BOOST_CHECK (result == nested_loop_join (build, probe, identity()));
+    }
+    {
+        auto joined = hash_join (build, probe, identity(), plus_50());
+        std::vector <std::pair <int, int>> result;
+        while (!empty (joined)) {
+            auto pair = chop_in_place (joined);
+            result.push_back (std::make_pair (first (pair), second (pair)));
+        }
+        BOOST_CHECK (result == nested_loop_join (build, probe, plus_50()));
+    }
+    {
+        std::vector <int> no_probe;
+        auto joined = hash_join (build, no_probe, identity());
+        BOOST_CHECK (empty (joined));
+    }
+
+    for (std::size_t thread_num : {1, 3, 8}) {
+        auto joined = parallel_hash_join (
+            build, probe, identity(), plus_50(), thread_num);
+        std::vector <std::pair <int, int>> result;
+        for (auto const & pair : joined)
+            result.push_back (std::make_pair (first (pair), second (pair)));
+        std::sort (result.begin(), result.end());
+        auto expected = nested_loop_join (build, probe, plus_50());
+        std::sort (expected.begin(), expected.end());
+        BOOST_CHECK (result == expected);
+    }
+}
+
+typedef tuple <int, std::string> customer;
+typedef tuple <std::string, int, double> order;
+
+struct customer_key {
+    int operator() (customer const & c) const { return first (c); }
+};
+
+struct order_key {
+    int operator() (order const & o) const { return second (o); }
+};
+
+BOOST_AUTO_TEST_CASE (test_hash_join_tuples) {
+    std::vector <customer> customers;
+    customers.push_back (customer (1, "Alice"));
+    customers.push_back (customer (2, "Bob"));
+    customers.push_back (customer (3, "Carol"));
+
+    std::vector <order> orders;
+    orders.push_back (order ("bread", 2, 1.5));
+    orders.push_back (order ("milk", 4, .75));
+    orders.push_back (order ("cheese", 2, 4.));
+    orders.push_back (order ("apples", 1, 2.));
+
+    auto joined = hash_join (customers, orders, customer_key(), order_key());
+    std::vector <std::string> names;
+    while (!empty (joined)) {
+        auto pair = chop_in_place (joined);
+        BOOST_CHECK_EQUAL (first (first (pair)), second (second (pair)));
+        names.push_back (second (first (pair)) + ":" + first (second (pair)));
+    }
+    BOOST_CHECK_EQUAL (names.size(), 3u);
+    BOOST_CHECK_EQUAL (names [0], "Bob:bread");
+    BOOST_CHECK_EQUAL (names [1], "Bob:cheese");
+    BOOST_CHECK_EQUAL (names [2], "Alice:apples");
+
+    auto parallel_joined = parallel_hash_join (
+        customers, orders, customer_key(), order_key(), 2);
+    BOOST_CHECK_EQUAL (parallel_joined.size(), 3u);
+}
+
+struct name_key {
+    std::string const & operator() (customer const & c) const
+    { return second (c); }
+};
+
+struct pointer_key {
+    char const * operator() (char const * name) const { return name; }
+};
+
+BOOST_AUTO_TEST_CASE (test_hash_join_key_conversion) {
+    std::vector <customer> customers;
+    customers.push_back (customer (1, "Alice"));
+    customers.push_back (customer (2, "Bob"));
+
+    // The pointers are converted to std::string before they are hashed.
+    std::vector <char const *> names;
+    names.push_back ("Bob");
+    names.push_back ("Carol");
+    names.push_back ("Alice");
+
+    auto joined = hash_join (customers, names, name_key(), pointer_key());
+    std::vector <int> ids;
+    while (!empty (joined))
+        ids.push_back (first (first (chop_in_place (joined))));
+    BOOST_CHECK_EQUAL (ids.size(), 2u);
+    BOOST_CHECK_EQUAL (ids [0], 2);
+    BOOST_CHECK_EQUAL (ids [1], 1);
+
+    auto parallel_joined = parallel_hash_join (
+        customers, names, name_key(), pointer_key(), 2);
+    BOOST_CHECK_EQUAL (parallel_joined.size(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
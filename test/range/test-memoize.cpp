@@ -0,0 +1,171 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_memoize
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/memoize.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "range/std.hpp"
+#include "range/transform.hpp"
+#include "range/equal.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_memoize)
+
+using range::memoize;
+using range::transform;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::drop;
+using range::front;
+using range::back;
+using range::has;
+namespace callable = range::callable;
+
+/// Square its argument, and count how often it is called.
+struct counting_square {
+    int * calls;
+
+    int operator() (int i) const {
+        ++ *calls;
+        return i * i;
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_memoize_vector) {
+    std::vector <int> v;
+    for (int i = 1; i != 6; ++ i)
+        v.push_back (i);
+
+    int calls = 0;
+    auto squares = transform (v, counting_square {&calls});
+    // transform computes the element every time.
+    first (squares);
+    first (squares);
+    BOOST_CHECK_EQUAL (calls, 2);
+
+    calls = 0;
+    auto m = memoize (squares);
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (m)), int const &>));
+    BOOST_CHECK (!empty (m));
+    BOOST_CHECK_EQUAL (size (m), 5u);
+    BOOST_CHECK_EQUAL (calls, 0);
+
+    BOOST_CHECK_EQUAL (first (m), 1);
+    BOOST_CHECK_EQUAL (first (m), 1);
+    BOOST_CHECK_EQUAL (calls, 1);
+
+    BOOST_CHECK_EQUAL (second (m), 4);
+    BOOST_CHECK_EQUAL (first (drop (m)), 4);
+    BOOST_CHECK_EQUAL (calls, 2);
+
+    // Dropping more than one element at a time.
+    BOOST_CHECK_EQUAL (first (drop (m, 4)), 25);
+    BOOST_CHECK_EQUAL (size (drop (m, 3)), 2u);
+    BOOST_CHECK_EQUAL (first (drop (drop (m, 2), 2)), 25);
+    BOOST_CHECK_EQUAL (calls, 3);
+    BOOST_CHECK (empty (drop (m, 5)));
+
+    // Copies share the cache, also when traversing with chop_in_place.
+    auto copy = m;
+    int sum = 0;
+    RANGE_FOR_EACH (element, copy)
+        sum += element;
+    BOOST_CHECK_EQUAL (sum, 55);
+    BOOST_CHECK_EQUAL (calls, 5);
+
+    BOOST_CHECK (range::equal (m, transform (v, counting_square {&calls})));
+    BOOST_CHECK_EQUAL (calls, 10);
+
+    // Back to front.
+    calls = 0;
+    auto m2 = memoize (squares, back);
+    BOOST_CHECK_EQUAL (first (m2, back), 25);
+    BOOST_CHECK_EQUAL (first (drop (m2, 1, back), back), 16);
+    BOOST_CHECK_EQUAL (first (m2, back), 25);
+    BOOST_CHECK_EQUAL (calls, 2);
+}
+
+BOOST_AUTO_TEST_CASE (test_memoize_long) {
+    // Many chunks.
+    std::vector <int> v;
+    for (int i = 0; i != 1000; ++ i)
+        v.push_back (i);
+
+    int calls = 0;
+    auto m = memoize (transform (v, counting_square {&calls}));
+    BOOST_CHECK_EQUAL (first (drop (m, 999)), 999 * 999);
+    BOOST_CHECK_EQUAL (first (drop (m, 500)), 500 * 500);
+    BOOST_CHECK_EQUAL (calls, 2);
+
+    auto current = m;
+    for (int i = 0; i != 1000; ++ i) {
+        BOOST_CHECK_EQUAL (first (current), i * i);
+        current = drop (current);
+    }
+    BOOST_CHECK (empty (current));
+    BOOST_CHECK_EQUAL (calls, 1000);
+
+    current = m;
+    for (int i = 0; i != 1000; ++ i)
+        BOOST_CHECK_EQUAL (range::chop_in_place (current), i * i);
+    BOOST_CHECK_EQUAL (calls, 1000);
+}
+
+struct counting_to_string {
+    int * calls;
+
+    std::string operator() (int i) const {
+        ++ *calls;
+        return std::string (std::size_t (i), 'a');
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_memoize_list) {
+    std::list <int> l;
+    l.push_back (1);
+    l.push_back (3);
+    l.push_back (2);
+
+    int calls = 0;
+    auto m = memoize (transform (l, counting_to_string {&calls}));
+    BOOST_MPL_ASSERT ((std::is_same <
+        decltype (first (m)), std::string const &>));
+    BOOST_MPL_ASSERT_NOT ((has <callable::size (decltype (m))>));
+
+    BOOST_CHECK_EQUAL (second (m), "aaa");
+    BOOST_CHECK_EQUAL (first (drop (m)), "aaa");
+    BOOST_CHECK_EQUAL (calls, 1);
+    // The element is not copied out of the cache.
+    BOOST_CHECK_EQUAL (&second (m), &first (drop (m)));
+
+    std::string all;
+    RANGE_FOR_EACH (element, m)
+        all += element;
+    BOOST_CHECK_EQUAL (all, "aaaaaa");
+    BOOST_CHECK_EQUAL (calls, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
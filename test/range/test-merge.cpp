@@ -0,0 +1,145 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_merge
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/merge.hpp"
+
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "range/std.hpp"
+#include "range/buffer.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_merge)
+
+using range::merge;
+
+using range::empty;
+using range::first;
+using range::second;
+using range::drop;
+using range::chop_in_place;
+
+BOOST_AUTO_TEST_CASE (test_merge_vectors) {
+    std::vector <std::vector <int>> inputs (4);
+    {
+        auto m = merge (inputs);
+        BOOST_CHECK (empty (m));
+    }
+    inputs [0].push_back (1);
+    inputs [0].push_back (4);
+    inputs [0].push_back (7);
+    inputs [1].push_back (2);
+    inputs [1].push_back (5);
+    // inputs [2] is empty.
+    inputs [3].push_back (3);
+    inputs [3].push_back (6);
+    inputs [3].push_back (8);
+
+    auto m = merge (inputs);
+    BOOST_CHECK (!empty (m));
+    BOOST_CHECK_EQUAL (first (m), 1);
+    BOOST_CHECK_EQUAL (second (m), 2);
+    BOOST_CHECK_EQUAL (first (drop (drop (drop (m)))), 4);
+
+    // The elements are references to the elements of the inputs.
+    BOOST_CHECK_EQUAL (&second (m), &inputs [1][0]);
+
+    std::vector <int> result;
+    RANGE_FOR_EACH (element, m)
+        result.push_back (element);
+    BOOST_CHECK_EQUAL (result.size(), 8u);
+    for (int i = 0; i != 8; ++ i)
+        BOOST_CHECK_EQUAL (result [i], i + 1);
+
+    // m itself is unchanged.
+    BOOST_CHECK_EQUAL (first (m), 1);
+    while (!empty (m))
+        chop_in_place (m);
+    BOOST_CHECK (empty (m));
+}
+
+BOOST_AUTO_TEST_CASE (test_merge_less) {
+    std::vector <int> v1;
+    std::vector <int> v2;
+    v1.push_back (9);
+    v1.push_back (3);
+    v2.push_back (5);
+    v2.push_back (4);
+    v2.push_back (1);
+
+    // A fixed number of ranges, sorted in descending order.
+    auto m = merge (std::tie (v1, v2), std::greater <int>());
+    std::vector <int> result;
+    RANGE_FOR_EACH (element, m)
+        result.push_back (element);
+    BOOST_CHECK_EQUAL (result.size(), 5u);
+    BOOST_CHECK_EQUAL (result [0], 9);
+    BOOST_CHECK_EQUAL (result [1], 5);
+    BOOST_CHECK_EQUAL (result [2], 4);
+    BOOST_CHECK_EQUAL (result [3], 3);
+    BOOST_CHECK_EQUAL (result [4], 1);
+}
+
+struct less_key {
+    bool operator() (std::pair <int, int> const & left,
+        std::pair <int, int> const & right) const
+    { return left.first < right.first; }
+};
+
+BOOST_AUTO_TEST_CASE (test_merge_stable) {
+    // Equal elements come from earlier inputs first.
+    std::vector <std::vector <std::pair <int, int>>> inputs (3);
+    for (int input = 0; input != 3; ++ input) {
+        inputs [input].push_back (std::make_pair (1, input));
+        inputs [input].push_back (std::make_pair (2, input));
+    }
+    auto m = merge (inputs, less_key());
+    for (int key = 1; key != 3; ++ key) {
+        for (int input = 0; input != 3; ++ input) {
+            std::pair <int, int> element = chop_in_place (m);
+            BOOST_CHECK_EQUAL (element.first, key);
+            BOOST_CHECK_EQUAL (element.second, input);
+        }
+    }
+    BOOST_CHECK (empty (m));
+}
+
+BOOST_AUTO_TEST_CASE (test_merge_buffers) {
+    // Merge streams, without materialising them.
+    std::vector <std::vector <int>> data (5);
+    std::vector <range::buffer <int>> streams;
+    for (int start = 0; start != 5; ++ start) {
+        for (int i = start; i < 1000; i += 5)
+            data [start].push_back (i);
+        streams.push_back (range::make_buffer (data [start]));
+    }
+
+    auto m = merge (streams);
+    int expected = 0;
+    RANGE_FOR_EACH (element, m) {
+        BOOST_CHECK_EQUAL (element, expected);
+        ++ expected;
+    }
+    BOOST_CHECK_EQUAL (expected, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_parallel_sort
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/parallel_sort.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "range/std/container.hpp"
+#include "range/tuple.hpp"
+#include "range/zip.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_parallel_sort)
+
+using range::first;
+
+struct compare_first {
+    template <class Left, class Right>
+        bool operator() (Left const & left, Right const & right) const
+    { return first (left) < first (right); }
+};
+
+BOOST_AUTO_TEST_CASE (test_parallel_sort) {
+    std::mt19937 generator (3);
+    for (std::size_t size : {0, 100, 100000}) {
+        for (int maximum : {0, 3, 1000000000}) {
+            std::uniform_int_distribution <int> distribution (0, maximum);
+            std::vector <int> original;
+            for (std::size_t i = 0; i != size; ++ i)
+                original.push_back (distribution (generator));
+            std::vector <int> expected = original;
+            std::sort (expected.begin(), expected.end());
+
+            for (std::size_t thread_num : {1, 2, 5}) {
+                std::vector <int> v = original;
+                range::parallel_sort (v, thread_num);
+                BOOST_CHECK (v == expected);
+
+                std::vector <int> keys = original;
+                std::vector <double> values (keys.begin(), keys.end());
+                range::parallel_sort (range::zip (keys, values), thread_num,
+                    compare_first());
+                BOOST_CHECK (keys == expected);
+                BOOST_CHECK (std::equal (values.begin(), values.end(),
+                    expected.begin()));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_parallel_sort_exception) {
+    std::vector <int> v;
+    for (int i = 0; i != 50000; ++ i)
+        v.push_back ((i * 7919) % 50000);
+    BOOST_CHECK_THROW (range::parallel_sort (v, 4, [] (int left, int right) {
+            if (left == 12345)
+                throw std::runtime_error ("12345");
+            return left < right;
+        }), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
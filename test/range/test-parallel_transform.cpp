@@ -0,0 +1,91 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_parallel_transform
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/parallel_transform.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "range/count.hpp"
+#include "range/fold.hpp"
+#include "range/std/container.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_parallel_transform)
+
+using range::parallel_transform;
+using range::empty;
+using range::chop_in_place;
+
+BOOST_AUTO_TEST_CASE (test_parallel_transform_order) {
+    std::vector <int> v;
+    for (int i = 0; i != 1000; ++ i)
+        v.push_back (i);
+
+    auto squares = parallel_transform (v, [] (int i) { return i * i; }, 4, 3);
+    for (int i = 0; i != 1000; ++ i) {
+        BOOST_CHECK (!empty (squares));
+        BOOST_CHECK_EQUAL (chop_in_place (squares), i * i);
+    }
+    BOOST_CHECK (empty (squares));
+
+    // The worker threads read the range, so it must outlive the result.
+    std::vector <int> no_elements;
+    auto nothing = parallel_transform (no_elements,
+        [] (int i) { return i; }, 2);
+    BOOST_CHECK (empty (nothing));
+}
+
+BOOST_AUTO_TEST_CASE (test_parallel_transform_fold) {
+    // Move-only results.
+    auto pointers = parallel_transform (range::count (1, 10001),
+        [] (int i) { return std::unique_ptr <int> (new int (i)); }, 3);
+    int sum = range::fold (0, std::move (pointers),
+        [] (int sum, std::unique_ptr <int> const & i) { return sum + *i; });
+    BOOST_CHECK_EQUAL (sum, 10000 * 10001 / 2);
+}
+
+BOOST_AUTO_TEST_CASE (test_parallel_transform_exception) {
+    auto checked = parallel_transform (range::count (0, 10), [] (int i) {
+            if (i == 5)
+                throw std::runtime_error ("five");
+            return std::to_string (i);
+        }, 2, 2);
+    for (int i = 0; i != 5; ++ i)
+        BOOST_CHECK_EQUAL (chop_in_place (checked), std::to_string (i));
+    BOOST_CHECK_THROW (chop_in_place (checked), std::runtime_error);
+    // The elements after the exception are still produced.
+    for (int i = 6; i != 10; ++ i)
+        BOOST_CHECK_EQUAL (chop_in_place (checked), std::to_string (i));
+    BOOST_CHECK (empty (checked));
+}
+
+BOOST_AUTO_TEST_CASE (test_parallel_transform_infinite) {
+    // Only the window is read ahead; destruction stops the threads.
+    auto doubled = parallel_transform (range::count_from (0),
+        [] (int i) { return 2 * i; }, 4, 8);
+    BOOST_CHECK_EQUAL (chop_in_place (doubled), 0);
+    BOOST_CHECK_EQUAL (chop_in_place (doubled), 2);
+
+    auto moved = std::move (doubled);
+    BOOST_CHECK_EQUAL (chop_in_place (moved), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_sliding_window
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/sliding_window.hpp"
+
+#include <list>
+#include <vector>
+#include <type_traits>
+
+#include "range/std.hpp"
+#include "range/buffer.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_sliding_window)
+
+using range::sliding_window;
+using range::adjacent;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::third;
+using range::drop;
+using range::back;
+using range::has;
+namespace callable = range::callable;
+
+BOOST_AUTO_TEST_CASE (test_sliding_window_vector) {
+    std::vector <int> v;
+    BOOST_CHECK (empty (sliding_window (v, 3)));
+    BOOST_CHECK_EQUAL (size (sliding_window (v, 3)), 0u);
+
+    v.push_back (1);
+    v.push_back (2);
+    BOOST_CHECK (empty (sliding_window (v, 3)));
+
+    v.push_back (3);
+    v.push_back (4);
+    v.push_back (5);
+
+    auto windows = sliding_window (v, 3);
+    BOOST_CHECK (!empty (windows));
+    BOOST_CHECK_EQUAL (size (windows), 3u);
+
+    auto window = first (windows);
+    BOOST_CHECK_EQUAL (size (window), 3u);
+    BOOST_CHECK_EQUAL (first (window), 1);
+    BOOST_CHECK_EQUAL (third (window), 3);
+    // The windows are views of the vector.
+    BOOST_CHECK_EQUAL (&first (window), &v [0]);
+
+    BOOST_CHECK_EQUAL (first (second (windows)), 2);
+    BOOST_CHECK_EQUAL (first (third (windows)), 3);
+    BOOST_CHECK_EQUAL (third (third (windows)), 5);
+    BOOST_CHECK (empty (drop (windows, 3)));
+    BOOST_CHECK_EQUAL (size (drop (windows, 2)), 1u);
+
+    // Back to front.
+    auto reversed = sliding_window (v, 2, back);
+    BOOST_CHECK_EQUAL (size (reversed, back), 4u);
+    BOOST_CHECK_EQUAL (first (first (reversed, back), back), 5);
+    BOOST_CHECK_EQUAL (second (first (reversed, back), back), 4);
+
+    int total = 0;
+    RANGE_FOR_EACH (w, windows)
+        RANGE_FOR_EACH (element, w)
+            total += element;
+    BOOST_CHECK_EQUAL (total, 6 + 9 + 12);
+}
+
+BOOST_AUTO_TEST_CASE (test_sliding_window_buffer) {
+    std::list <int> l;
+    for (int i = 0; i != 100; ++ i)
+        l.push_back (i);
+
+    auto windows = sliding_window (range::make_buffer (l), 4);
+    BOOST_MPL_ASSERT_NOT ((has <callable::size (decltype (windows))>));
+    int count = 0;
+    RANGE_FOR_EACH (window, windows) {
+        int expected = count;
+        RANGE_FOR_EACH (element, window) {
+            BOOST_CHECK_EQUAL (element, expected);
+            ++ expected;
+        }
+        BOOST_CHECK_EQUAL (expected, count + 4);
+        ++ count;
+    }
+    BOOST_CHECK_EQUAL (count, 97);
+}
+
+BOOST_AUTO_TEST_CASE (test_adjacent) {
+    std::vector <int> v;
+    BOOST_CHECK (empty (adjacent (v)));
+    v.push_back (1);
+    BOOST_CHECK (empty (adjacent (v)));
+    BOOST_CHECK_EQUAL (size (adjacent (v)), 0u);
+    v.push_back (2);
+    v.push_back (4);
+    v.push_back (8);
+
+    auto pairs = adjacent (v);
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (pairs)),
+        std::pair <int &, int &>>));
+    BOOST_CHECK_EQUAL (size (pairs), 3u);
+    BOOST_CHECK_EQUAL (first (pairs).first, 1);
+    BOOST_CHECK_EQUAL (first (pairs).second, 2);
+    BOOST_CHECK_EQUAL (&second (pairs).first, &v [1]);
+    BOOST_CHECK_EQUAL (third (pairs).second, 8);
+    BOOST_CHECK_EQUAL (first (drop (pairs, 2)).first, 4);
+
+    // Differences between consecutive elements.
+    std::vector <int> differences;
+    RANGE_FOR_EACH (pair, adjacent (range::make_buffer (v)))
+        differences.push_back (pair.second - pair.first);
+    BOOST_CHECK_EQUAL (differences.size(), 3u);
+    BOOST_CHECK_EQUAL (differences [0], 1);
+    BOOST_CHECK_EQUAL (differences [1], 2);
+    BOOST_CHECK_EQUAL (differences [2], 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_soa_vector
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/soa_vector.hpp"
+
+#include <string>
+#include <stdexcept>
+
+#include "range/fold.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_soa_vector)
+
+using range::soa_vector;
+using range::tuple;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::third;
+using range::at_c;
+using range::drop;
+using range::view;
+
+BOOST_AUTO_TEST_CASE (test_soa_vector_container) {
+    soa_vector <int, double, std::string> v;
+    BOOST_CHECK (v.empty());
+    BOOST_CHECK_EQUAL (v.size(), 0u);
+    BOOST_CHECK (empty (v));
+
+    v.reserve (10);
+    v.push_back (1, 1.5, "one");
+    v.push_back (2, 2.5, "two");
+    v.push_back (3, 3.5, "three");
+    BOOST_CHECK_EQUAL (v.size(), 3u);
+
+    // Element access.
+    BOOST_MPL_ASSERT ((std::is_same <decltype (v [0]),
+        tuple <int &, double &, std::string &>>));
+    BOOST_CHECK_EQUAL (at_c <0> (v [1]), 2);
+    BOOST_CHECK_EQUAL (at_c <1> (v [1]), 2.5);
+    BOOST_CHECK_EQUAL (at_c <2> (v [1]), "two");
+    at_c <0> (v [1]) = 20;
+    BOOST_CHECK_EQUAL (at_c <0> (v [1]), 20);
+
+    soa_vector <int, double, std::string> const & c = v;
+    BOOST_MPL_ASSERT ((std::is_same <decltype (c [0]),
+        tuple <int const &, double const &, std::string const &>>));
+    BOOST_CHECK_EQUAL (at_c <2> (c [2]), "three");
+
+    // Columns are contiguous.
+    BOOST_CHECK_EQUAL (v.data <1>() + 1, &at_c <1> (v [1]));
+    BOOST_CHECK_EQUAL (c.data <0>() [2], 3);
+    BOOST_CHECK_EQUAL (size (v.column <0>()), 3u);
+    BOOST_CHECK_EQUAL (first (c.column <1>()), 1.5);
+    BOOST_CHECK_EQUAL (first (drop (v.column <2>(), 2)), "three");
+
+    v.pop_back();
+    BOOST_CHECK_EQUAL (v.size(), 2u);
+    BOOST_CHECK_EQUAL (size (v.column <2>()), 2u);
+
+    v.resize (4);
+    BOOST_CHECK_EQUAL (v.size(), 4u);
+    BOOST_CHECK_EQUAL (at_c <1> (v [3]), 0.);
+    BOOST_CHECK_EQUAL (at_c <2> (v [3]), "");
+
+    soa_vector <int, double, std::string> v2 (2);
+    v2.swap (v);
+    BOOST_CHECK_EQUAL (v.size(), 2u);
+    BOOST_CHECK_EQUAL (v2.size(), 4u);
+    swap (v, v2);
+    BOOST_CHECK_EQUAL (v.size(), 4u);
+
+    v.clear();
+    BOOST_CHECK (v.empty());
+}
+
+struct throw_on_construction {
+    throw_on_construction (int i) {
+        if (i == 0)
+            throw std::runtime_error ("Zero.");
+    }
+};
+
+BOOST_AUTO_TEST_CASE (test_soa_vector_push_back_exception) {
+    soa_vector <int, throw_on_construction, double> v;
+    v.push_back (1, 1, 1.5);
+    BOOST_CHECK_THROW (v.push_back (2, 0, 2.5), std::runtime_error);
+    // The first column must have been rolled back.
+    BOOST_CHECK_EQUAL (v.size(), 1u);
+    BOOST_CHECK_EQUAL (size (v.column <0>()), 1u);
+    BOOST_CHECK_EQUAL (size (v.column <1>()), 1u);
+    BOOST_CHECK_EQUAL (size (v.column <2>()), 1u);
+}
+
+struct add_second {
+    double operator() (double state, tuple <int &, double &> element) const
+    { return state + second (element); }
+};
+
+BOOST_AUTO_TEST_CASE (test_soa_vector_range) {
+    soa_vector <int, double> v;
+    v.push_back (1, 1.5);
+    v.push_back (2, 2.5);
+    v.push_back (3, 3.5);
+
+    BOOST_CHECK (!empty (v));
+    BOOST_CHECK_EQUAL (size (v), 3u);
+
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (v)),
+        tuple <int &, double &>>));
+    BOOST_CHECK_EQUAL (first (first (v)), 1);
+    BOOST_CHECK_EQUAL (second (first (v)), 1.5);
+    BOOST_CHECK_EQUAL (first (first (v, range::back)), 3);
+    BOOST_CHECK_EQUAL (second (second (v)), 2.5);
+    BOOST_CHECK_EQUAL (first (third (v)), 3);
+
+    // Write through the view.
+    first (first (view (v))) = 10;
+    BOOST_CHECK_EQUAL (at_c <0> (v [0]), 10);
+
+    BOOST_CHECK_EQUAL (range::fold (0., v, add_second()), 7.5);
+
+    int sum = 0;
+    RANGE_FOR_EACH (element, v)
+        sum += first (element);
+    BOOST_CHECK_EQUAL (sum, 15);
+
+    // Const.
+    soa_vector <int, double> const & c = v;
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (c)),
+        tuple <int const &, double const &>>));
+    BOOST_CHECK_EQUAL (second (first (drop (c, 2))), 3.5);
+}
+
+BOOST_AUTO_TEST_CASE (test_soa_vector_move) {
+    soa_vector <std::string, int> v;
+    v.push_back ("a", 1);
+    v.push_back ("b", 2);
+
+    // Traversing an rvalue once moves the elements out.
+    auto moving = range::view_once (std::move (v));
+    BOOST_MPL_ASSERT ((std::is_same <decltype (first (moving)),
+        tuple <std::string &&, int &&>>));
+    std::string moved = first (range::chop_in_place (moving));
+    BOOST_CHECK_EQUAL (moved, "a");
+    BOOST_CHECK_EQUAL (size (moving), 1u);
+
+    // A normal view of an rvalue does not move.
+    soa_vector <std::string, int> v2;
+    v2.push_back ("c", 3);
+    std::string result;
+    RANGE_FOR_EACH (element, std::move (v2))
+        result += first (element);
+    BOOST_CHECK_EQUAL (result, "c");
+    BOOST_CHECK_EQUAL (at_c <0> (v2 [0]), "c");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,172 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_sort
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/sort.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "range/std/container.hpp"
+#include "range/tuple.hpp"
+#include "range/zip.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_sort)
+
+using range::first;
+using range::second;
+using range::tuple;
+
+std::vector <int> random_numbers (std::size_t size, int maximum) {
+    std::mt19937 generator (size);
+    std::uniform_int_distribution <int> distribution (-maximum, maximum);
+    std::vector <int> result;
+    for (std::size_t i = 0; i != size; ++ i)
+        result.push_back (distribution (generator));
+    return result;
+}
+
+struct compare_first {
+    template <class Left, class Right>
+        bool operator() (Left const & left, Right const & right) const
+    { return first (left) < first (right); }
+};
+
+struct key_first {
+    template <class Element> int operator() (Element const & element) const
+    { return first (element); }
+};
+
+std::size_t const sizes [] = {0, 1, 2, 16, 17, 100, 5000};
+
+BOOST_AUTO_TEST_CASE (test_sort) {
+    for (std::size_t size : sizes) {
+        for (int maximum : {2, 1000000}) {
+            std::vector <int> const original = random_numbers (size, maximum);
+            std::vector <int> expected = original;
+            std::sort (expected.begin(), expected.end());
+
+            std::vector <int> v = original;
+            range::sort (v);
+            BOOST_CHECK (v == expected);
+
+            v = original;
+            range::stable_sort (v);
+            BOOST_CHECK (v == expected);
+
+            v = original;
+            range::radix_sort (v);
+            BOOST_CHECK (v == expected);
+
+            v = original;
+            range::sort (v, std::greater <int>());
+            BOOST_CHECK (std::equal (v.begin(), v.end(), expected.rbegin()));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_partial_sort) {
+    std::vector <int> const original = random_numbers (1000, 100000);
+    std::vector <int> expected = original;
+    std::sort (expected.begin(), expected.end());
+
+    for (std::size_t number : {0, 1, 10, 999, 1000, 2000}) {
+        std::vector <int> v = original;
+        range::partial_sort (v, number);
+        std::size_t sorted = std::min (number, v.size());
+        BOOST_CHECK (std::equal (v.begin(), v.begin() + sorted,
+            expected.begin()));
+
+        v = original;
+        auto smallest = range::top_k (v, number);
+        BOOST_CHECK_EQUAL (range::size (smallest), sorted);
+        BOOST_CHECK (std::equal (v.begin(), v.begin() + sorted,
+            expected.begin()));
+
+        if (number < v.size()) {
+            v = original;
+            range::nth_element (v, number);
+            BOOST_CHECK_EQUAL (v [number], expected [number]);
+            for (std::size_t i = 0; i != number; ++ i)
+                BOOST_CHECK (v [i] <= v [number]);
+            for (std::size_t i = number; i != v.size(); ++ i)
+                BOOST_CHECK (v [i] >= v [number]);
+        }
+    }
+
+    // Largest elements.
+    std::vector <int> v = {5, 1, 4, 2, 3};
+    auto largest = range::top_k (v, 2, std::greater <int>());
+    BOOST_CHECK_EQUAL (first (largest), 5);
+    BOOST_CHECK_EQUAL (second (largest), 4);
+}
+
+BOOST_AUTO_TEST_CASE (test_sort_zip) {
+    std::vector <int> const original = random_numbers (5000, 10);
+
+    std::vector <int> keys = original;
+    std::vector <std::string> values;
+    for (int key : keys)
+        values.push_back (std::to_string (key));
+
+    // The strings are swapped along with the keys.
+    range::sort (range::zip (keys, values), compare_first());
+    BOOST_CHECK (std::is_sorted (keys.begin(), keys.end()));
+    for (std::size_t i = 0; i != keys.size(); ++ i)
+        BOOST_CHECK_EQUAL (values [i], std::to_string (keys [i]));
+
+    // Stability.
+    for (auto algorithm : {0, 1}) {
+        keys = original;
+        std::vector <std::size_t> positions;
+        for (std::size_t i = 0; i != keys.size(); ++ i)
+            positions.push_back (i);
+        if (algorithm == 0)
+            range::stable_sort (range::zip (keys, positions), compare_first());
+        else
+            range::radix_sort (range::zip (keys, positions), key_first());
+        BOOST_CHECK (std::is_sorted (keys.begin(), keys.end()));
+        for (std::size_t i = 1; i != keys.size(); ++ i) {
+            if (keys [i - 1] == keys [i])
+                BOOST_CHECK (positions [i - 1] < positions [i]);
+            BOOST_CHECK_EQUAL (keys [i], original [positions [i]]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_radix_sort_tuple) {
+    std::vector <long> major = {3, -1, 3, 2, -1};
+    std::vector <unsigned char> minor = {1, 200, 0, 5, 7};
+    // Use the tuple of references as a key.
+    range::radix_sort (range::zip (major, minor));
+    BOOST_CHECK ((major == std::vector <long> {-1, -1, 2, 3, 3}));
+    BOOST_CHECK ((minor == std::vector <unsigned char> {7, 200, 5, 0, 1}));
+
+    std::vector <tuple <short, bool>> pairs = {
+        tuple <short, bool> (2, true), tuple <short, bool> (-2, false),
+        tuple <short, bool> (2, false)};
+    range::radix_sort (pairs);
+    BOOST_CHECK (pairs [0] == (tuple <short, bool> (-2, false)));
+    BOOST_CHECK (pairs [1] == (tuple <short, bool> (2, false)));
+    BOOST_CHECK (pairs [2] == (tuple <short, bool> (2, true)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_stride
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/stride.hpp"
+
+#include <vector>
+
+#include "range/std.hpp"
+#include "range/reverse.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_stride)
+
+using range::stride;
+
+using range::empty;
+using range::size;
+using range::first;
+using range::second;
+using range::drop;
+using range::reverse;
+using range::front;
+using range::back;
+
+BOOST_AUTO_TEST_CASE (test_stride) {
+    std::vector <int> v;
+    BOOST_CHECK (empty (stride (v, 3)));
+    BOOST_CHECK_EQUAL (size (stride (v, 3)), 0u);
+
+    for (int i = 0; i != 10; ++ i)
+        v.push_back (i);
+
+    // 0, 3, 6, 9.
+    auto s = stride (v, 3);
+    BOOST_CHECK_EQUAL (size (s), 4u);
+    BOOST_CHECK_EQUAL (first (s), 0);
+    BOOST_CHECK_EQUAL (second (s), 3);
+    BOOST_CHECK_EQUAL (first (s, back), 9);
+    BOOST_CHECK_EQUAL (first (drop (s, 2)), 6);
+    BOOST_CHECK_EQUAL (size (drop (s, 2)), 2u);
+    BOOST_CHECK_EQUAL (first (drop (s, 3)), 9);
+    BOOST_CHECK (empty (drop (s, 4)));
+    BOOST_CHECK_EQUAL (first (drop (s, 3, back)), 0);
+    BOOST_CHECK (empty (drop (s, 4, back)));
+
+    // Elements are references.
+    BOOST_CHECK_EQUAL (&second (s), &v [3]);
+
+    // 0, 4, 8: the last element of the view is not the last of the vector.
+    auto s4 = stride (v, 4);
+    BOOST_CHECK_EQUAL (size (s4), 3u);
+    BOOST_CHECK_EQUAL (first (s4, back), 8);
+    BOOST_CHECK_EQUAL (first (drop (s4, back), back), 4);
+
+    {
+        std::vector <int> result;
+        RANGE_FOR_EACH (element, reverse (s4))
+            result.push_back (element);
+        BOOST_CHECK_EQUAL (result.size(), 3u);
+        BOOST_CHECK_EQUAL (result [0], 8);
+        BOOST_CHECK_EQUAL (result [1], 4);
+        BOOST_CHECK_EQUAL (result [2], 0);
+    }
+
+    // Step 1.
+    BOOST_CHECK_EQUAL (size (stride (v, 1)), 10u);
+    // Step larger than the range.
+    BOOST_CHECK_EQUAL (size (stride (v, 20)), 1u);
+    BOOST_CHECK_EQUAL (first (stride (v, 20), back), 0);
+}
+
+BOOST_AUTO_TEST_CASE (test_stride_channels) {
+    // Three interleaved channels.
+    std::vector <double> samples;
+    for (int frame = 0; frame != 5; ++ frame)
+        for (int channel = 0; channel != 3; ++ channel)
+            samples.push_back (channel * 100 + frame);
+
+    for (int channel = 0; channel != 3; ++ channel) {
+        auto selected = stride (drop (samples, channel), 3);
+        BOOST_CHECK_EQUAL (size (selected), 5u);
+        int frame = 0;
+        RANGE_FOR_EACH (sample, selected) {
+            BOOST_CHECK_EQUAL (sample, channel * 100 + frame);
+            ++ frame;
+        }
+        BOOST_CHECK_EQUAL (frame, 5);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,186 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Test the implementations of equal, less_lexicographical, and fold on tuples
+that expand indices instead of recursing.
+These are used when comparisons return bool, and for fold.
+*/
+
+#define BOOST_TEST_MODULE test_range_tuple_run_time
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/tuple.hpp"
+#include "range/equal.hpp"
+#include "range/less_lexicographical.hpp"
+#include "range/fold.hpp"
+#include "range/std/tuple.hpp"
+
+#include "rime/check/check_equal.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_tuple_run_time)
+
+using range::make_tuple;
+using range::equal;
+using range::less_lexicographical;
+using range::fold;
+
+/**
+Predicate that counts how often it is called.
+*/
+template <class Predicate> struct counting {
+    int & count;
+
+    explicit counting (int & count) : count (count) {}
+
+    template <class Left, class Right>
+        bool operator() (Left const & left, Right const & right) const
+    {
+        ++ count;
+        return Predicate() (left, right);
+    }
+};
+
+struct equal_to {
+    template <class Left, class Right>
+        bool operator() (Left const & left, Right const & right) const
+    { return left == right; }
+};
+
+struct less {
+    template <class Left, class Right>
+        bool operator() (Left const & left, Right const & right) const
+    { return left < right; }
+};
+
+typedef range::tuple <int, double, short, long, float, char, int, double,
+    short, long, float, char, int, double, short, long> long_tuple;
+
+BOOST_AUTO_TEST_CASE (test_tuple_equal_run_time) {
+    long_tuple t1 (1, 2., 3, 4, 5.f, 'a', 7, 8., 9, 10, 11.f, 'b', 13, 14.,
+        15, 16);
+    long_tuple t2 = t1;
+    long_tuple t3 = t1;
+    range::at_c <8> (t3) = 0;
+
+    BOOST_CHECK (equal (t1, t2));
+    BOOST_CHECK (!equal (t1, t3));
+    BOOST_CHECK (t1 == t2);
+    BOOST_CHECK (t1 != t3);
+
+    // The predicate should not be called after the first mismatch.
+    {
+        int count = 0;
+        BOOST_CHECK (equal (t1, t2, counting <equal_to> (count)));
+        BOOST_CHECK_EQUAL (count, 16);
+    }
+    {
+        int count = 0;
+        BOOST_CHECK (!equal (t1, t3, counting <equal_to> (count)));
+        BOOST_CHECK_EQUAL (count, 9);
+    }
+
+    // Different types.
+    range::tuple <std::string, char const *> t4 ("a", "b");
+    range::tuple <char const *, std::string> t5 ("a", "b");
+    range::tuple <char const *, std::string> t6 ("a", "c");
+    BOOST_CHECK (equal (t4, t5));
+    BOOST_CHECK (!equal (t4, t6));
+}
+
+BOOST_AUTO_TEST_CASE (test_tuple_less_run_time) {
+    long_tuple t1 (1, 2., 3, 4, 5.f, 'a', 7, 8., 9, 10, 11.f, 'b', 13, 14.,
+        15, 16);
+    long_tuple t2 = t1;
+    long_tuple t3 = t1;
+    range::at_c <8> (t3) = 10;
+
+    BOOST_CHECK (!less_lexicographical (t1, t2));
+    BOOST_CHECK (!less_lexicographical (t2, t1));
+    BOOST_CHECK (less_lexicographical (t1, t3));
+    BOOST_CHECK (!less_lexicographical (t3, t1));
+    BOOST_CHECK (t1 < t3);
+    BOOST_CHECK (t3 > t1);
+    BOOST_CHECK (t1 <= t2);
+    BOOST_CHECK (!(t3 <= t1));
+
+    // Equal tuples: compare both ways around for each element.
+    {
+        int count = 0;
+        BOOST_CHECK (!less_lexicographical (t1, t2, counting <less> (count)));
+        BOOST_CHECK_EQUAL (count, 32);
+    }
+    // The predicate should not be called after the outcome is known.
+    {
+        int count = 0;
+        BOOST_CHECK (less_lexicographical (t1, t3, counting <less> (count)));
+        BOOST_CHECK_EQUAL (count, 8 * 2 + 1);
+    }
+    {
+        int count = 0;
+        BOOST_CHECK (!less_lexicographical (t3, t1, counting <less> (count)));
+        BOOST_CHECK_EQUAL (count, 8 * 2 + 2);
+    }
+}
+
+template <int Step> struct state {
+    double value;
+    explicit state (double value) : value (value) {}
+};
+
+/**
+Function that returns a different state type for each step.
+*/
+struct add_step {
+    template <int Step, class Element>
+        state <Step + 1> operator() (state <Step> s, Element const & e) const
+    { return state <Step + 1> (s.value + e); }
+};
+
+BOOST_AUTO_TEST_CASE (test_tuple_fold_run_time) {
+    long_tuple t (1, 2., 3, 4, 5.f, 'a', 7, 8., 9, 10, 11.f, 'b', 13, 14.,
+        15, 16);
+
+    BOOST_MPL_ASSERT ((std::is_same <
+        decltype (fold (state <0> (0.), t, add_step())), state <16>>));
+    BOOST_CHECK_EQUAL (fold (state <0> (0.), t, add_step()).value,
+        1 + 2 + 3 + 4 + 5 + 'a' + 7 + 8 + 9 + 10 + 11 + 'b' + 13 + 14 + 15
+            + 16);
+
+    // Folding over part of the tuple.
+    BOOST_MPL_ASSERT ((std::is_same <decltype (fold (state <0> (0.),
+            range::drop (t, rime::size_t <14>()), add_step())),
+        state <2>>));
+    BOOST_CHECK_EQUAL (fold (state <0> (0.),
+        range::drop (t, rime::size_t <14>()), add_step()).value, 15 + 16);
+
+    // Empty tuple: return the state as is.
+    range::tuple<> empty;
+    BOOST_MPL_ASSERT ((std::is_same <
+        decltype (fold (state <0> (1.), empty, add_step())), state <0>>));
+    BOOST_CHECK_EQUAL (fold (state <0> (1.), empty, add_step()).value, 1.);
+
+    // An lvalue state is still returned as a temporary.
+    state <0> initial (2.);
+    BOOST_MPL_ASSERT ((std::is_same <
+        decltype (fold (initial, empty, add_step())), state <0>>));
+    BOOST_MPL_ASSERT ((std::is_same <
+        decltype (fold (initial, std::tuple<>(), add_step())), state <0>>));
+    BOOST_CHECK_EQUAL (fold (initial, empty, add_step()).value, 2.);
+    BOOST_CHECK_EQUAL (fold (initial, std::tuple<>(), add_step()).value, 2.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file
+Test the memory layout of tuples: empty elements should take up no space, and
+elements can be reordered to reduce padding.
+Access, construction, and assignment must still use the natural order.
+*/
+
+#define BOOST_TEST_MODULE test_range_tuple_layout
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/tuple.hpp"
+
+#include <string>
+#include <vector>
+
+#include "range/std/container.hpp"
+#include "range/less_lexicographical.hpp"
+
+#include "unique_range.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_tuple_layout)
+
+using range::tuple;
+using range::at_c;
+
+struct empty_1 {};
+struct empty_2 {
+    int get() const { return 27; }
+};
+
+BOOST_AUTO_TEST_CASE (test_tuple_empty_elements) {
+    BOOST_CHECK_EQUAL (sizeof (tuple <int, empty_1>), sizeof (int));
+    BOOST_CHECK_EQUAL (sizeof (tuple <empty_1, int, empty_2>), sizeof (int));
+    // Two objects of the same type must have different addresses.
+    BOOST_CHECK (sizeof (tuple <empty_1, empty_1>) >= 2);
+
+    tuple <empty_1, int, empty_2> t (empty_1(), 5, empty_2());
+    BOOST_CHECK_EQUAL (at_c <1> (t), 5);
+    BOOST_CHECK_EQUAL (at_c <2> (t).get(), 27);
+
+    tuple <empty_1, int, empty_2> t2 = t;
+    BOOST_CHECK_EQUAL (at_c <1> (t2), 5);
+}
+
+BOOST_AUTO_TEST_CASE (test_tuple_reordered) {
+    typedef tuple <char, double, char, int, char> tuple_type;
+    // Without reordering, this would take 5 * 8 bytes on most platforms.
+    BOOST_CHECK (sizeof (tuple_type) <= 2 * sizeof (double));
+
+    tuple_type t ('a', 2.5, 'b', 7, 'c');
+    BOOST_CHECK_EQUAL (at_c <0> (t), 'a');
+    BOOST_CHECK_EQUAL (at_c <1> (t), 2.5);
+    BOOST_CHECK_EQUAL (at_c <2> (t), 'b');
+    BOOST_CHECK_EQUAL (at_c <3> (t), 7);
+    BOOST_CHECK_EQUAL (at_c <4> (t), 'c');
+
+    // Copy and move.
+    tuple_type t2 = t;
+    BOOST_CHECK (t2 == t);
+    tuple_type t3 = std::move (t2);
+    BOOST_CHECK (t3 == t);
+
+    // Assignment.
+    tuple_type t4;
+    t4 = t;
+    BOOST_CHECK (t4 == t);
+    at_c <1> (t4) = 3.5;
+    BOOST_CHECK_EQUAL (at_c <1> (t4), 3.5);
+    BOOST_CHECK_EQUAL (at_c <1> (t), 2.5);
+
+    // Comparison is in the natural order.
+    BOOST_CHECK (t < t4);
+    at_c <0> (t) = 'b';
+    BOOST_CHECK (t4 < t);
+
+    // Swap.
+    swap (t, t4);
+    BOOST_CHECK_EQUAL (at_c <0> (t), 'a');
+    BOOST_CHECK_EQUAL (at_c <1> (t), 3.5);
+    BOOST_CHECK_EQUAL (at_c <0> (t4), 'b');
+    BOOST_CHECK_EQUAL (at_c <1> (t4), 2.5);
+}
+
+BOOST_AUTO_TEST_CASE (test_tuple_reordered_from_range) {
+    typedef tuple <char, std::string, char> tuple_type;
+    BOOST_CHECK (sizeof (tuple_type) < 3 * sizeof (std::string));
+
+    // Construct from a range that can only be traversed once, in order.
+    {
+        tuple <int, std::string, int> source (1, "two", 3);
+        tuple_type t (one_time_view (source));
+        BOOST_CHECK_EQUAL (at_c <0> (t), 1);
+        BOOST_CHECK_EQUAL (at_c <1> (t), "two");
+        BOOST_CHECK_EQUAL (at_c <2> (t), 3);
+    }
+    // Construct from a homogeneous range.
+    {
+        std::vector <char> source;
+        source.push_back ('a');
+        source.push_back ('b');
+        source.push_back ('c');
+        tuple <char, double, char> t (source);
+        BOOST_CHECK_EQUAL (at_c <0> (t), 'a');
+        BOOST_CHECK_EQUAL (at_c <1> (t), double ('b'));
+        BOOST_CHECK_EQUAL (at_c <2> (t), 'c');
+
+        source.pop_back();
+        BOOST_CHECK_THROW ((tuple <char, double, char> (source)),
+            range::size_mismatch);
+
+        // Assign from a range.
+        source.push_back ('d');
+        t = source;
+        BOOST_CHECK_EQUAL (at_c <0> (t), 'a');
+        BOOST_CHECK_EQUAL (at_c <1> (t), double ('b'));
+        BOOST_CHECK_EQUAL (at_c <2> (t), 'd');
+
+        source.push_back ('e');
+        BOOST_CHECK_THROW (t = source, range::size_mismatch);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_tuple_reordered_references) {
+    // A reference is stored as a pointer, so it goes in front of the chars.
+    typedef tuple <char, double &, char> tuple_type;
+    BOOST_CHECK (sizeof (tuple_type) <= 2 * sizeof (double *));
+
+    double d = 1.5;
+    tuple_type t ('a', d, 'c');
+    BOOST_CHECK_EQUAL (range::first (t), 'a');
+    BOOST_CHECK_EQUAL (&at_c <1> (t), &d);
+    BOOST_CHECK_EQUAL (at_c <2> (t), 'c');
+
+    // Writes go through the reference, and the chars are left alone.
+    at_c <1> (t) = 2.5;
+    BOOST_CHECK_EQUAL (d, 2.5);
+    d = 3.5;
+    BOOST_CHECK_EQUAL (at_c <1> (t), 3.5);
+    range::first (t) = 'b';
+    at_c <2> (t) = 'd';
+    BOOST_CHECK_EQUAL (at_c <0> (t), 'b');
+    BOOST_CHECK_EQUAL (&at_c <1> (t), &d);
+    BOOST_CHECK_EQUAL (at_c <2> (t), 'd');
+
+    // A reference at the front.
+    char c = 'x';
+    tuple <char &, double, char const &> t2 (c, 4.5, c);
+    BOOST_CHECK_EQUAL (&range::first (t2), &c);
+    BOOST_CHECK_EQUAL (at_c <1> (t2), 4.5);
+    BOOST_CHECK_EQUAL (&at_c <2> (t2), &c);
+    range::first (t2) = 'y';
+    BOOST_CHECK_EQUAL (c, 'y');
+    BOOST_CHECK_EQUAL (at_c <2> (t2), 'y');
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/*
+Copyright 2015 Rogier van Dalen.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#define BOOST_TEST_MODULE test_range_window_fold
+#include "utility/test/boost_unit_test.hpp"
+
+#include "range/window_fold.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "range/std.hpp"
+#include "range/buffer.hpp"
+#include "range/for_each_macro.hpp"
+
+BOOST_AUTO_TEST_SUITE(test_range_window_fold)
+
+using range::window_fold;
+using range::window_sum;
+using range::window_min;
+using range::window_max;
+
+using range::empty;
+using range::size;
+using range::chop_in_place;
+using range::back;
+
+BOOST_AUTO_TEST_CASE (test_window_fold_sum) {
+    std::vector <int> v;
+    BOOST_CHECK (empty (window_fold (v, 2, window_sum <int>())));
+    v.push_back (1);
+    BOOST_CHECK (empty (window_fold (v, 2, window_sum <int>())));
+    v.push_back (2);
+    v.push_back (3);
+    v.push_back (4);
+    v.push_back (5);
+
+    auto sums = window_fold (v, 2, window_sum <int>());
+    BOOST_CHECK_EQUAL (size (sums), 4u);
+    BOOST_CHECK_EQUAL (chop_in_place (sums), 3);
+    BOOST_CHECK_EQUAL (chop_in_place (sums), 5);
+    BOOST_CHECK_EQUAL (size (sums), 2u);
+    BOOST_CHECK_EQUAL (chop_in_place (sums), 7);
+    BOOST_CHECK_EQUAL (chop_in_place (sums), 9);
+    BOOST_CHECK (empty (sums));
+
+    // Window of one element.
+    std::vector <int> result;
+    RANGE_FOR_EACH (sum, window_fold (v, 1, window_sum <int>()))
+        result.push_back (sum);
+    BOOST_CHECK (result == v);
+
+    // Back to front.
+    auto reversed = window_fold (v, 3, window_sum <int>(), back);
+    BOOST_CHECK_EQUAL (chop_in_place (reversed, back), 12);
+    BOOST_CHECK_EQUAL (chop_in_place (reversed, back), 9);
+}
+
+BOOST_AUTO_TEST_CASE (test_window_fold_min_max) {
+    std::vector <int> v;
+    unsigned state = 1;
+    for (int i = 0; i != 300; ++ i) {
+        state = state * 1103515245u + 12345u;
+        v.push_back (int ((state >> 16) % 100));
+    }
+
+    for (std::size_t window_size = 1; window_size != 12; ++ window_size) {
+        std::vector <int> minima;
+        std::vector <int> maxima;
+        RANGE_FOR_EACH (m, window_fold (range::make_buffer (v), window_size,
+                window_min <int>()))
+            minima.push_back (m);
+        RANGE_FOR_EACH (m, window_fold (v, window_size,
+                window_max <int, std::less <int>>()))
+            maxima.push_back (m);
+
+        BOOST_CHECK_EQUAL (minima.size(), v.size() - window_size + 1);
+        BOOST_CHECK_EQUAL (maxima.size(), minima.size());
+        for (std::size_t i = 0; i != minima.size(); ++ i) {
+            auto begin = v.begin() + i;
+            auto end = begin + window_size;
+            BOOST_CHECK_EQUAL (minima [i], *std::min_element (begin, end));
+            BOOST_CHECK_EQUAL (maxima [i], *std::max_element (begin, end));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()